@@ -0,0 +1,147 @@
+#ifndef CQPerfAlertEngine_H
+#define CQPerfAlertEngine_H
+
+#include <CQPerfRollup.h>
+#include <CQPerfPeriodicWorker.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Evaluate alert rules on trace rollups in a background thread
+ *
+ * Each rule compares a metric of a trace (percentile, mean, call rate or number of calls)
+ * over a trailing time window against a threshold. A rule is raised when the metric is
+ * above its threshold for debounce consecutive evaluations and cleared when it is at or
+ * below its (lower) clear threshold for debounce consecutive evaluations.
+ *
+ * Trace limit alerts (max calls/max time) raised on the trace hot path are queued and
+ * delivered from the same thread so actions never run while the monitor is locked.
+ *
+ * Raised ACTION_RECORD rules share one recording: the engine starts it for the first
+ * such rule (unless already recording) and only stops a recording it started when the
+ * last such rule clears, so a recording started by the user is never stopped.
+ */
+class CQPerfAlertEngine {
+ public:
+  enum class Metric {
+    PERCENTILE, //!< elapsed percentile (usecs)
+    MEAN,       //!< mean elapsed (usecs)
+    RATE,       //!< calls per second
+    CALLS       //!< calls in window (call budget)
+  };
+
+  enum Action {
+    ACTION_LOG      = (1<<0), //!< write log line
+    ACTION_CALLBACK = (1<<1), //!< call rule callback
+    ACTION_SIGNAL   = (1<<2), //!< emit CQPerfMonitor::alertChanged
+    ACTION_RECORD   = (1<<3)  //!< record while alert raised
+  };
+
+  struct Alert {
+    std::string rule;               //!< rule name
+    std::string trace;              //!< trace name
+    double      value     { 0.0 };  //!< metric value
+    double      threshold { 0.0 };  //!< rule threshold
+    bool        active    { true }; //!< raised (true) or cleared (false)
+  };
+
+  using Callback = std::function<void(const Alert &alert)>;
+
+  struct Rule {
+    std::string name;                                          //!< rule name (unique)
+    std::string trace;                                         //!< trace name
+    Metric      metric         { Metric::PERCENTILE };         //!< metric
+    double      percentile     { 0.99 };                       //!< percentile (0-1) for PERCENTILE
+    int64_t     window         { 10000000 };                   //!< trailing window (usecs)
+    double      threshold      { 0.0 };                        //!< raise when metric above
+    double      clearThreshold { -1.0 };                       //!< clear when at or below (< 0 threshold)
+    uint        debounce       { 1 };                          //!< consecutive evaluations to change
+    uint        actions        { ACTION_LOG | ACTION_SIGNAL }; //!< actions (Action mask)
+    Callback    callback;                                      //!< callback for ACTION_CALLBACK
+  };
+
+  using Rules = std::vector<Rule>;
+
+ public:
+  CQPerfAlertEngine();
+ ~CQPerfAlertEngine();
+
+  CQPerfAlertEngine(const CQPerfAlertEngine &) = delete;
+  CQPerfAlertEngine &operator=(const CQPerfAlertEngine &) = delete;
+
+  //! evaluation interval (usecs)
+  int64_t interval() const { return worker_.interval(); }
+  void setInterval(int64_t i);
+
+  //! actions for trace limit (max calls/max time) alerts. Only ACTION_LOG and
+  //! ACTION_SIGNAL apply (limit alerts have no rule callback and don't record) so
+  //! setLimitActions fails for other actions
+  uint limitActions() const;
+  bool setLimitActions(uint actions);
+
+  bool addRule(const Rule &rule);
+  bool removeRule(const std::string &name);
+  void clearRules();
+
+  void getRules(Rules &rules) const;
+
+  bool isRaised(const std::string &name) const;
+
+  //! queue alert raised on hot path for delivery by alert thread
+  void postAlert(const Alert &alert);
+
+  //! evaluate rules at time (usecs) and deliver queued alerts
+  void evaluate(int64_t t);
+
+  bool isRunning() const;
+
+  void start();
+  void stop();
+
+ private:
+  struct RuleData {
+    Rule rule;
+    bool raised    { false }; //!< is raised
+    uint count     { 0 };     //!< consecutive evaluations past threshold
+    bool recording { false }; //!< rule holds engine recording
+  };
+
+  struct Delivery {
+    Alert    alert;
+    uint     actions { 0 };
+    Callback callback;
+    bool     record  { false };
+  };
+
+  using RuleDatas  = std::map<std::string, RuleData>;
+  using Alerts     = std::vector<Alert>;
+  using Deliveries = std::vector<Delivery>;
+
+  void process(int64_t t, bool evalRules);
+
+  static double metricValue(const Rule &rule, const CQPerfRollup::Bucket &bucket);
+
+  void deliver(const Delivery &delivery);
+
+  //! add/remove holder of engine recording (started by first, stopped after last if
+  //! started by engine)
+  void addRecordHolder();
+  void removeRecordHolder(uint n=1);
+
+ private:
+  CQPerfPeriodicWorker    worker_;                                      //!< alert thread
+  mutable std::mutex      mutex_;                                       //!< rules/queue mutex
+  uint                    limitActions_ { ACTION_LOG | ACTION_SIGNAL }; //!< trace limit actions
+  RuleDatas               ruleDatas_;                                   //!< rules by name
+  Alerts                  alerts_;                                      //!< queued alerts
+  std::mutex              recordMutex_;                                 //!< recording mutex
+  uint                    recordHolders_ { 0 };                         //!< raised record rules
+  bool                    ownsRecording_ { false };                     //!< engine started recording
+};
+
+#endif
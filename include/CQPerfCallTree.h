@@ -0,0 +1,83 @@
+#ifndef CQPerfCallTree_H
+#define CQPerfCallTree_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Call tree aggregated from recorded spans
+ *
+ * Spans (start, elapsed, depth) are added per thread and build() rebuilds the call
+ * stacks by nesting (a span is the child of the enclosing span with a lower depth)
+ * and merges identical stacks into a single node with total/self time and count.
+ *
+ * The tree can be written in folded stack format ("a;b;c N" where N is self time in
+ * usecs) as used by flamegraph.pl, speedscope, etc.
+ */
+class CQPerfCallTree {
+ public:
+  static const uint32_t ROOT = 0; //!< index of root node
+
+  struct Span {
+    int64_t  start   { 0 };
+    int64_t  elapsed { 0 };
+    uint32_t id      { 0 };
+    uint32_t tid     { 0 };
+    uint32_t depth   { 0 };
+  };
+
+  using Children = std::vector<uint32_t>;
+
+  struct Node {
+    uint32_t id     { 0 };    //!< trace id
+    uint32_t parent { ROOT }; //!< parent node
+    uint32_t level  { 0 };    //!< level in tree (root is 0)
+    uint64_t count  { 0 };    //!< number of calls
+    int64_t  total  { 0 };    //!< total elapsed (usecs)
+    int64_t  self   { 0 };    //!< elapsed not in children (usecs)
+    Children children;        //!< child nodes
+  };
+
+  using Nodes = std::vector<Node>;
+  using Spans = std::vector<Span>;
+  using Names = std::vector<std::string>;
+
+ public:
+  CQPerfCallTree();
+
+  void clear();
+
+  //! set name of trace id
+  void setName(uint32_t id, const std::string &name);
+
+  const std::string &name(uint32_t id) const;
+
+  void addSpan(uint32_t id, uint32_t tid, int64_t start, int64_t elapsed, uint32_t depth);
+
+  //! aggregate added spans into nodes (spans are discarded)
+  void build();
+
+  const Nodes &nodes() const { return nodes_; }
+
+  const Node &node(uint32_t i) const { return nodes_[i]; }
+
+  uint32_t maxLevel() const { return maxLevel_; }
+
+  //! get stack of node as ';' separated names (sanitized for folded format if folded)
+  std::string path(uint32_t i, bool folded=false) const;
+
+  //! write folded stacks
+  bool writeFolded(const std::string &filename) const;
+
+ private:
+  uint32_t childNode(uint32_t parent, uint32_t id);
+
+ private:
+  Names    names_;          //!< trace names (by id)
+  Spans    spans_;          //!< added spans
+  Nodes    nodes_;          //!< tree nodes
+  uint32_t maxLevel_ { 0 }; //!< max node level
+};
+
+#endif
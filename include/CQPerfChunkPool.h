@@ -0,0 +1,49 @@
+#ifndef CQPerfChunkPool_H
+#define CQPerfChunkPool_H
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#define CQPerfChunkPoolInst CQPerfChunkPool::getInstance()
+
+/*!
+ * \brief Pool of fixed size memory chunks used for recordings
+ *
+ * Released chunks are kept on a free list (up to maxFree) so restarting a
+ * recording reuses memory instead of going back to the heap.
+ */
+class CQPerfChunkPool {
+ public:
+  static const size_t CHUNK_SIZE = 16384;
+
+ public:
+  static CQPerfChunkPool *getInstance();
+
+ ~CQPerfChunkPool();
+
+  size_t maxFree() const { return maxFree_; }
+  void setMaxFree(size_t n);
+
+  size_t numFree() const;
+
+  size_t numAllocated() const;
+
+  uint8_t *alloc();
+
+  void release(uint8_t *chunk);
+
+ private:
+  CQPerfChunkPool();
+
+ private:
+  using Chunks = std::vector<uint8_t *>;
+
+  Chunks             free_;               //!< free chunks
+  size_t             maxFree_   { 1024 }; //!< max free chunks kept
+  size_t             allocated_ { 0 };    //!< number of chunks in use
+  mutable std::mutex mutex_;              //!< free list mutex
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef CQPerfClock_H
+#define CQPerfClock_H
+
+#include <CHRTime.h>
+
+#include <cstdint>
+#include <mutex>
+
+/*!
+ * \brief Time source of the monitor (see CQPerfMonitor::setClock)
+ *
+ * All trace start/end times, window and rollup times, snapshot times and graph "now"
+ * come from the monitor clock so a replacement clock makes them reproducible.
+ */
+class CQPerfClock {
+ public:
+  CQPerfClock() { }
+
+  virtual ~CQPerfClock() { }
+
+  //! current time
+  virtual CHRTime getTime() const = 0;
+};
+
+//---
+
+/*!
+ * \brief Clock with explicitly set time
+ *
+ * With speed zero (default) time only changes on setTicks/advance so tests can step
+ * through windowing, rollups and alerts deterministically. With a non-zero speed time
+ * also runs at that multiple of real time (e.g. to replay a recording faster or slower).
+ */
+class CQPerfVirtualClock : public CQPerfClock {
+ public:
+  CQPerfVirtualClock(int64_t ticks=0);
+
+  CHRTime getTime() const override;
+
+  //! current time (usecs)
+  int64_t ticks() const;
+  void setTicks(int64_t ticks);
+
+  //! move time forward (usecs)
+  void advance(int64_t usecs);
+
+  //! multiple of real time (0 for stopped)
+  double speed() const;
+  void setSpeed(double speed);
+
+ private:
+  int64_t currentTicks() const;
+
+  static int64_t realTicks();
+
+ private:
+  mutable std::mutex mutex_;            //!< time mutex
+  int64_t            ticks_    { 0 };   //!< time at real time base (usecs)
+  int64_t            realBase_ { 0 };   //!< real time base (usecs)
+  double             speed_    { 0.0 }; //!< multiple of real time
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef CQPerfFlameGraph_H
+#define CQPerfFlameGraph_H
+
+#include <CQPerfCallTree.h>
+
+#include <QFrame>
+
+/*!
+ * \brief Flame graph (or icicle graph if root at top) of aggregated call tree
+ *
+ * Each row is a stack level and each box's width is proportional to the total time of
+ * the call stack. Click on a box to zoom to it.
+ */
+class CQPerfFlameGraph : public QFrame {
+  Q_OBJECT
+
+  Q_PROPERTY(bool icicle READ isIcicle WRITE setIcicle)
+
+ public:
+  CQPerfFlameGraph(QWidget *parent=nullptr);
+
+ ~CQPerfFlameGraph();
+
+  const CQPerfCallTree &callTree() const { return tree_; }
+  void setCallTree(const CQPerfCallTree &tree);
+
+  bool isIcicle() const { return icicle_; }
+
+  uint32_t zoomNode() const { return zoomNode_; }
+  void setZoomNode(uint32_t node);
+
+  void contextMenuEvent(QContextMenuEvent *event) override;
+
+  void mousePressEvent(QMouseEvent *event) override;
+
+  void paintEvent(QPaintEvent *) override;
+
+  bool event(QEvent *e) override;
+
+  QSize sizeHint() const override { return QSize(600, 400); }
+
+ signals:
+  void reloadRequested();
+
+ public slots:
+  void setIcicle(bool b) { icicle_ = b; update(); }
+
+  void zoomOut();
+  void resetZoom();
+
+ private slots:
+  void saveFoldedSlot();
+
+ private:
+  void drawNode(QPainter *p, uint32_t node, double x, double w, uint level);
+
+  QRectF levelRect(double x, double w, uint level) const;
+
+  int nodeAt(const QPoint &pos) const;
+
+ private:
+  struct NodeRect {
+    QRectF   rect;
+    uint32_t node;
+
+    NodeRect(const QRectF &rect, uint32_t node) :
+     rect(rect), node(node) {
+    }
+  };
+
+  using NodeRects = std::vector<NodeRect>;
+
+  CQPerfCallTree tree_;                               //!< call tree
+  uint32_t       zoomNode_  { CQPerfCallTree::ROOT }; //!< node shown as full width
+  bool           icicle_    { true };                 //!< draw root at top
+  int            rowHeight_ { 0 };                    //!< row height (pixels)
+  NodeRects      nodeRects_;                          //!< drawn node rects
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef CQPerfFlightReader_H
+#define CQPerfFlightReader_H
+
+#include <CQPerfFlightRecorder.h>
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Read spans from a flight recorder file (written by CQPerfFlightRecorder)
+ *
+ * Can be used on the file left by a crashed process or on a live (hung) process.
+ * Slots which were being written (or overwritten) while read are skipped.
+ */
+class CQPerfFlightReader {
+ public:
+  struct Span {
+    uint64_t index   { 0 }; //!< write index
+    int64_t  start   { 0 }; //!< start (usecs)
+    int64_t  elapsed { 0 }; //!< elapsed (usecs)
+    uint32_t id      { 0 }; //!< trace id
+    uint32_t tid     { 0 }; //!< thread id
+    uint32_t depth   { 0 }; //!< depth
+  };
+
+  using Spans = std::vector<Span>;
+
+ public:
+  CQPerfFlightReader();
+ ~CQPerfFlightReader();
+
+  CQPerfFlightReader(const CQPerfFlightReader &) = delete;
+  CQPerfFlightReader &operator=(const CQPerfFlightReader &) = delete;
+
+  const std::string &filename() const { return filename_; }
+
+  bool isOpen() const { return mem_ != nullptr; }
+
+  bool open(const std::string &filename);
+  void close();
+
+  uint32_t pid() const;
+
+  uint32_t capacity() const;
+
+  //! total number of spans written (including overwritten)
+  uint64_t numWritten() const;
+
+  std::string name(uint32_t id) const;
+
+  //! get valid spans in ring ordered by write index
+  void spans(Spans &spans) const;
+
+  //! print spans ending in last secs before most recent span, grouped by thread
+  void dump(std::ostream &os, double secs) const;
+
+ private:
+  using Header    = CQPerfFlightRecorder::Header;
+  using NameEntry = CQPerfFlightRecorder::NameEntry;
+  using Slot      = CQPerfFlightRecorder::Slot;
+
+  const Header *header() const { return reinterpret_cast<const Header *>(mem_); }
+
+ private:
+  std::string filename_;            //!< file name
+  uint8_t*    mem_     { nullptr }; //!< mapped file
+  size_t      memSize_ { 0 };       //!< mapped size
+};
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef CQPerfFlightRecorder_H
+#define CQPerfFlightRecorder_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+/*!
+ * \brief Fixed size ring of recent spans in a memory mapped (shared memory) file
+ *
+ * The file (by default in /dev/shm) outlives a crashed process so the last spans before
+ * a crash or hang can be dumped with CQPerfFlightReader. It is removed when the recorder
+ * is closed (clean exit) unless asked to keep it.
+ *
+ * Writers are lock-free: a slot is claimed with an atomic increment of the header head
+ * and is guarded by its sequence number (odd while being written) so a reader can
+ * detect slots which are torn or were being written when the process died. A writer
+ * lapped by the whole ring never marks the newer writer's slot as its own (a slot
+ * lapped while its writer was preempted mid write may still hold mixed values).
+ *
+ * Writers are registered with addUser (while the monitor is locked) so the recorder is
+ * only deleted after spans being written outside the monitor lock are done.
+ *
+ * File layout:
+ *  . Header (padded to HEADER_SIZE)
+ *  . maxNames NameEntry (trace names by trace id)
+ *  . capacity Slot (ring of spans)
+ */
+class CQPerfFlightRecorder {
+ public:
+  static constexpr size_t   HEADER_SIZE = 4096;
+  static constexpr size_t   NAME_SIZE   = 60;
+  static constexpr uint32_t MAX_NAMES   = 4096;
+  static constexpr uint32_t VERSION     = 1;
+
+  // name entry state while name is being written and for a defined empty name
+  static constexpr uint32_t NAME_WRITING = 0xFFFFFFFF;
+  static constexpr uint32_t NAME_EMPTY   = 0xFFFFFFFE;
+
+  struct Header {
+    char                  magic[8];  //!< "CQPFLT\0\1"
+    uint32_t              version;   //!< format version
+    uint32_t              pid;       //!< recording process id
+    uint32_t              capacity;  //!< number of slots (power of 2)
+    uint32_t              maxNames;  //!< number of name entries
+    int64_t               startTime; //!< creation time (usecs)
+    std::atomic<uint64_t> head;      //!< number of slots claimed
+  };
+
+  struct NameEntry {
+    std::atomic<uint32_t> state;           //!< 0 unset, NAME_WRITING, NAME_EMPTY or length
+    char                  name[NAME_SIZE]; //!< name (truncated)
+  };
+
+  // values are (relaxed) atomics as writers lapping the ring may write a slot concurrently
+  struct Slot {
+    std::atomic<uint64_t> seq;     //!< 2*index + 1 while writing, 2*index + 2 when written
+    std::atomic<int64_t>  start;   //!< span start (usecs)
+    std::atomic<int64_t>  elapsed; //!< span elapsed (usecs)
+    std::atomic<uint32_t> id;      //!< trace id
+    std::atomic<uint32_t> tid;     //!< thread id
+    std::atomic<uint32_t> depth;   //!< depth
+    uint32_t              pad;
+  };
+
+  static_assert(std::atomic<uint64_t>::is_always_lock_free, "need lock free 64 bit atomics");
+  static_assert(std::atomic<uint32_t>::is_always_lock_free, "need lock free 32 bit atomics");
+
+  static const char *magic() { return "CQPFLT\0\1"; }
+
+  //! default file name for process
+  static std::string defaultFilename();
+
+  //! file size for capacity
+  static size_t fileSize(uint32_t capacity, uint32_t maxNames);
+
+ public:
+  CQPerfFlightRecorder();
+ ~CQPerfFlightRecorder();
+
+  CQPerfFlightRecorder(const CQPerfFlightRecorder &) = delete;
+  CQPerfFlightRecorder &operator=(const CQPerfFlightRecorder &) = delete;
+
+  const std::string &filename() const { return filename_; }
+
+  bool isOpen() const { return mem_ != nullptr; }
+
+  //! open file with capacity slots (rounded up to power of 2), file is removed on
+  //! close unless kept
+  bool open(const std::string &filename, uint32_t capacity, bool keepFile=false);
+  void close();
+
+  //! writers using recorder
+  void addUser   () { users_.fetch_add(1, std::memory_order_relaxed); }
+  void removeUser() { users_.fetch_sub(1, std::memory_order_release); }
+
+  bool hasUsers() const { return users_.load(std::memory_order_acquire) > 0; }
+
+  uint32_t capacity() const { return mask_ + 1; }
+
+  bool isTraceDefined(uint32_t id) const;
+
+  void defineTrace(uint32_t id, const std::string &name);
+
+  void addSpan(uint32_t id, int64_t start, int64_t elapsed, uint32_t depth);
+
+ private:
+  Header *header() const { return reinterpret_cast<Header *>(mem_); }
+
+  NameEntry *nameEntry(uint32_t id) const;
+
+  Slot *slot(uint64_t index) const;
+
+ private:
+  std::string       filename_;             //!< file name
+  bool              keepFile_ { false };   //!< keep file on close
+  uint8_t*          mem_      { nullptr }; //!< mapped file
+  size_t            memSize_  { 0 };       //!< mapped size
+  uint32_t          maxNames_ { 0 };       //!< number of name entries
+  uint32_t          mask_     { 0 };       //!< slot index mask (capacity - 1)
+  std::atomic<uint> users_    { 0 };       //!< writers using recorder
+};
+
+#endif
@@ -1,12 +1,17 @@
 #ifndef CQPerfGraph_H
 #define CQPerfGraph_H
 
+#include <CQPerfKernels.h>
+
 #include <QDialog>
 #include <QFrame>
 #include <QTableWidget>
+#include <vector>
 
 class CQPerfGraph;
 class CQPerfList;
+class CQPerfFlameGraph;
+class CQPerfRecordReader;
 class CInterval;
 class CQImageButton;
 
@@ -14,6 +19,13 @@ class QCheckBox;
 class QComboBox;
 class QSpinBox;
 
+namespace CQPerfGraphUtil {
+
+//! format time (usecs) with units for axis labels and tips
+QString formatTime(double usecs);
+
+}
+
 class CQPerfDialog : public QDialog {
   Q_OBJECT
 
@@ -28,9 +40,18 @@ class CQPerfDialog : public QDialog {
 
   int timeout() const { return timeout_; }
 
+  //! recording file being viewed (null if showing live data)
+  CQPerfRecordReader *reader() const { return reader_; }
+
  public slots:
   void setTimeout(int t);
 
+  bool loadRecording(const QString &filename);
+  void unloadRecording();
+
+  //! rebuild flame graph from recording
+  void updateFlameGraph();
+
  private slots:
   void setName(const QString &name);
   void setNames(const QStringList &names);
@@ -44,24 +65,28 @@ class CQPerfDialog : public QDialog {
   void valueComboSlot(int ind);
   void windowSizeSlot(int size);
   void recordSlot();
+  void loadSlot();
   void stateSlot();
   void zoomOutSlot();
   void zoomInSlot();
   void scrollSlot(int);
 
  private:
-  QCheckBox*     enableCheck_    { nullptr };
-  QCheckBox*     debugCheck_     { nullptr };
-  QComboBox*     typeCombo_      { nullptr };
-  QComboBox*     shapeCombo_     { nullptr };
-  QComboBox*     valueCombo_     { nullptr };
-  QSpinBox*      windowSizeSpin_ { nullptr };
-  CQImageButton* recordButton_   { nullptr };
-  CQPerfGraph*   graph_          { nullptr };
-  QScrollBar*    graphScroll_    { nullptr };
-  CQPerfList*    list_           { nullptr };
-  int            timeout_        { 250 };
-  QTimer*        timer_          { nullptr };
+  QCheckBox*          enableCheck_    { nullptr };
+  QCheckBox*          debugCheck_     { nullptr };
+  QComboBox*          typeCombo_      { nullptr };
+  QComboBox*          shapeCombo_     { nullptr };
+  QComboBox*          valueCombo_     { nullptr };
+  QSpinBox*           windowSizeSpin_ { nullptr };
+  CQImageButton*      recordButton_   { nullptr };
+  CQImageButton*      loadButton_     { nullptr };
+  CQPerfGraph*        graph_          { nullptr };
+  QScrollBar*         graphScroll_    { nullptr };
+  CQPerfList*         list_           { nullptr };
+  CQPerfFlameGraph*   flameGraph_     { nullptr };
+  int                 timeout_        { 250 };
+  QTimer*             timer_          { nullptr };
+  CQPerfRecordReader* reader_         { nullptr };
 };
 
 //---
@@ -87,6 +112,9 @@ class CQPerfGraph : public QFrame {
   void setName(const QString &name);
   void setNames(const QStringList &names);
 
+  CQPerfRecordReader *reader() const { return reader_; }
+  void setReader(CQPerfRecordReader *reader) { reader_ = reader; recordBins_ = RecordBins(); }
+
   int windowSize() const { return windowSize_; }
 
   int numIntervals() const { return numIntervals_; }
@@ -145,7 +173,23 @@ class CQPerfGraph : public QFrame {
   void countToPixel  (double x, double y, double &px, double &py);
   void elapsedToPixel(double x, double y, double &px, double &py);
 
+  void updateRecordBins(double t1, double dt, uint nb, double startTime);
+
  private:
+  using RangeStatsArray = std::vector<CQPerfKernels::RangeStats>;
+
+  //! binned recording spans of traces for view range (kept until range or traces
+  //! change so repaints don't decode the recording file)
+  struct RecordBins {
+    QStringList     names;             //!< trace names
+    double          t1        { 0.0 }; //!< start of first step
+    double          dt        { 0.0 }; //!< step size
+    uint            nb        { 0 };   //!< number of steps
+    double          startTime { 0.0 }; //!< start of totals
+    RangeStatsArray bins;              //!< nb steps of each trace
+    RangeStatsArray startBins;         //!< totals from start time to t1 of each trace
+  };
+
   struct TipRect {
     QRectF  rect;
     QString tip;
@@ -157,30 +201,32 @@ class CQPerfGraph : public QFrame {
 
   using TipRects = std::vector<TipRect>;
 
-  QStringList names_;
-  int         windowSize_    { 10000 };
-  int         numIntervals_  { 50 };
-  bool        showTotal_     { true };
-  bool        showDepth_     { false };
-  bool        showRecording_ { false };
-  bool        showPoints_    { true };
-  bool        showRects_     { false };
-  bool        showElapsed_   { true };
-  bool        showCount_     { true };
-  int         zoomFactor_    { 1 };
-  double      zoomOffset_    { 0.0 };
-  double      xmin_          { 0.0 };
-  double      xmax_          { 1.0 };
-  double      ymin1_         { 0.0 };
-  double      ymax1_         { 1.0 };
-  double      ymin2_         { 0.0 };
-  double      ymax2_         { 1.0 };
-  int         lmargin_       { 0 };
-  int         rmargin_       { 0 };
-  int         tmargin_       { 0 };
-  int         bmargin_       { 0 };
-  QFont       axisFont_;
-  TipRects    tipRects_;
+  CQPerfRecordReader* reader_        { nullptr };
+  QStringList         names_;
+  int                 windowSize_    { 10000 };
+  int                 numIntervals_  { 50 };
+  bool                showTotal_     { true };
+  bool                showDepth_     { false };
+  bool                showRecording_ { false };
+  bool                showPoints_    { true };
+  bool                showRects_     { false };
+  bool                showElapsed_   { true };
+  bool                showCount_     { true };
+  int                 zoomFactor_    { 1 };
+  double              zoomOffset_    { 0.0 };
+  double              xmin_          { 0.0 };
+  double              xmax_          { 1.0 };
+  double              ymin1_         { 0.0 };
+  double              ymax1_         { 1.0 };
+  double              ymin2_         { 0.0 };
+  double              ymax2_         { 1.0 };
+  int                 lmargin_       { 0 };
+  int                 rmargin_       { 0 };
+  int                 tmargin_       { 0 };
+  int                 bmargin_       { 0 };
+  QFont               axisFont_;
+  TipRects            tipRects_;
+  RecordBins          recordBins_;
 };
 
 //---
@@ -196,6 +242,9 @@ class CQPerfList : public QTableWidget {
   bool isSingleSelect() const { return singleSelect_; }
   void setSingleSelect(bool b) { singleSelect_ = b; }
 
+  CQPerfRecordReader *reader() const { return reader_; }
+  void setReader(CQPerfRecordReader *reader);
+
   QSize sizeHint() const override { return QSize(600, 400); }
 
  signals:
@@ -213,8 +262,9 @@ class CQPerfList : public QTableWidget {
   void clickSlot(int row, int column);
 
  private:
-  bool singleSelect_ { false };
-  bool loading_      { false };
+  CQPerfRecordReader* reader_       { nullptr };
+  bool                singleSelect_ { false };
+  bool                loading_      { false };
 };
 
 #endif
@@ -0,0 +1,52 @@
+#ifndef CQPerfKernels_H
+#define CQPerfKernels_H
+
+#include <cstdint>
+
+/*!
+ * \brief Aggregation kernels over columnar time data (64 bit start and 32 bit elapsed ticks)
+ *
+ * Range kernels have SSE4.2 and AVX2 implementations selected at runtime with a
+ * scalar fallback for other CPUs.
+ */
+namespace CQPerfKernels {
+
+enum class Impl {
+  SCALAR,
+  SSE42,
+  AVX2
+};
+
+//! aggregate of time data in a time range
+struct RangeStats {
+  int64_t count      { 0 };         //!< number of entries
+  int64_t sum        { 0 };         //!< total elapsed
+  int64_t minStart   { INT64_MAX }; //!< min start
+  int64_t maxEnd     { INT64_MIN }; //!< max start + elapsed
+  int64_t minElapsed { INT64_MAX }; //!< min elapsed
+  int64_t maxElapsed { INT64_MIN }; //!< max elapsed
+
+  void add(int64_t start, int64_t elapsed);
+  void add(const RangeStats &stats);
+};
+
+//! get implementation used for this CPU
+Impl impl();
+
+//! force implementation (for testing, clamped to what CPU supports)
+void setImpl(Impl impl);
+
+//! aggregate entries with start in [t1, t2]
+void rangeStats(const int64_t *starts, const uint32_t *elapseds, uint32_t n,
+                int64_t t1, int64_t t2, RangeStats &stats);
+
+//! get bin for start in [t1, t2) where scale is nb/(t2 - t1)
+uint32_t binIndex(int64_t start, int64_t t1, double scale, uint32_t nb);
+
+//! aggregate entries with start in [t1, t2) into nb equal width bins in one pass
+void binStats(const int64_t *starts, const uint32_t *elapseds, uint32_t n,
+              int64_t t1, int64_t t2, uint32_t nb, RangeStats *bins);
+
+}
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef CQPerfLogger_H
+#define CQPerfLogger_H
+
+#include <CQPerfRotatingFile.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*!
+ * \brief Asynchronous log writer
+ *
+ * Log lines are copied into a bounded lock-free multi-producer single-consumer ring
+ * and written in batches by a background thread so logging never blocks on terminal,
+ * pipe or file I/O. If the ring is full the line is dropped and counted (a line
+ * reporting the number dropped is written when space is available again).
+ *
+ * Debug events are queued in binary form (trace id, thread, depth, times) and only
+ * formatted as text (tagged by thread) by the writer thread.
+ *
+ * Lines are written to stderr or to a file which is rotated (file -> file.1 -> file.2 ...)
+ * when it reaches the maximum size.
+ *
+ * The ring is allocated and the writer started on first use. The writer polls while
+ * lines are arriving and parks when the ring stays empty (a producer wakes it).
+ */
+class CQPerfLogger {
+ public:
+  static constexpr size_t LINE_SIZE = 240;
+
+  //! empty polls (5ms apart) before writer parks
+  static constexpr int MAX_IDLE_POLLS = 20;
+
+  enum class EventType : uint8_t {
+    TEXT,  //!< text line
+    START, //!< debug start
+    END,   //!< debug end
+    SPAN   //!< debug span (start and end)
+  };
+
+  struct Event {
+    EventType type    { EventType::SPAN }; //!< event type
+    uint32_t  id      { 0 };               //!< trace id
+    uint32_t  depth   { 0 };               //!< debug depth
+    uint32_t  tid     { 0 };               //!< thread id
+    int64_t   time    { 0 };               //!< start time (usecs)
+    int64_t   elapsed { 0 };               //!< elapsed (usecs)
+  };
+
+ public:
+  CQPerfLogger(uint32_t capacity=8192);
+ ~CQPerfLogger();
+
+  CQPerfLogger(const CQPerfLogger &) = delete;
+  CQPerfLogger &operator=(const CQPerfLogger &) = delete;
+
+  //! set log file (empty for stderr), max size per file (0 for no rotation) and
+  //! number of rotated files to keep
+  bool setFile(const std::string &filename, size_t maxSize=0, uint maxFiles=4);
+
+  const std::string &filename() const { return file_.filename(); }
+
+  //! queue line (truncated to LINE_SIZE), returns false if dropped
+  bool log(const char *str, size_t len);
+
+  //! set name of trace id used to format events
+  void defineName(uint32_t id, const std::string &name);
+
+  //! queue debug event, returns false if dropped
+  bool logEvent(const Event &event);
+
+  //! number of lines dropped because queue was full
+  uint64_t numDropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  //! wait for queued lines to be written
+  void flush();
+
+ private:
+  struct Cell {
+    std::atomic<uint64_t> seq;                       //!< sequence (pos free, pos + 1 full)
+    EventType             type { EventType::TEXT };  //!< cell type
+    uint32_t              len  { 0 };                //!< line length
+    char                  str[LINE_SIZE];            //!< line (or Event)
+  };
+
+  static_assert(sizeof(Event) <= LINE_SIZE, "event too large for cell");
+
+  using Cells = std::vector<Cell>;
+  using Names = std::vector<std::string>;
+
+  Cell *claimCell(uint64_t &pos);
+
+  void publish(Cell *cell, uint64_t pos);
+
+  void start();
+
+  void run();
+
+  bool isQueueEmpty() const;
+
+  void wake();
+
+  size_t writeQueued();
+
+  void writeLine(const char *str, size_t len);
+
+  void writeEvent(const Event &event);
+
+ private:
+  Cells                   cells_;                  //!< ring cells (allocated on first use)
+  uint64_t                mask_       { 0 };       //!< ring index mask
+  alignas(64)
+  std::atomic<uint64_t>   enqueuePos_ { 0 };       //!< next producer position
+  alignas(64)
+  uint64_t                dequeuePos_ { 0 };       //!< next consumer position (writer only)
+  std::atomic<uint64_t>   written_    { 0 };       //!< lines dequeued and written
+  std::atomic<uint64_t>   dropped_    { 0 };       //!< dropped lines
+  uint64_t                reported_   { 0 };       //!< dropped lines reported (writer only)
+  std::once_flag          startFlag_;              //!< start thread once
+  std::thread             thread_;                 //!< writer thread
+  std::atomic<bool>       stop_       { false };   //!< stop writer thread
+  std::mutex              parkMutex_;              //!< park mutex
+  std::condition_variable parkCond_;               //!< wakes parked writer
+  std::atomic<bool>       parked_     { false };   //!< writer parked
+  std::mutex              fileMutex_;              //!< file mutex
+  CQPerfRotatingFile      file_;                   //!< log file (stderr if not open)
+  std::vector<char>       buffer_;                 //!< batch buffer
+  std::mutex              namesMutex_;             //!< names mutex
+  Names                   names_;                  //!< trace names by id
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef CQPerfMetricsServer_H
+#define CQPerfMetricsServer_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+class CQPerfSnapshot;
+
+/*!
+ * \brief Minimal HTTP server (background thread) serving trace stats at /metrics
+ *
+ * The response is Prometheus/OpenMetrics text rendered from a monitor snapshot:
+ * per trace call counter and elapsed histogram (log2 usec buckets, sum and count).
+ * Each connection serves one request and is closed.
+ */
+class CQPerfMetricsServer {
+ public:
+  CQPerfMetricsServer();
+ ~CQPerfMetricsServer();
+
+  CQPerfMetricsServer(const CQPerfMetricsServer &) = delete;
+  CQPerfMetricsServer &operator=(const CQPerfMetricsServer &) = delete;
+
+  //! start listening on address and port (0 for any free port)
+  bool start(int port, const std::string &address="127.0.0.1");
+  void stop();
+
+  bool isRunning() const { return fd_ >= 0; }
+
+  //! bound port
+  int port() const { return port_; }
+
+  //! render snapshot as Prometheus text
+  static void renderMetrics(const CQPerfSnapshot &snapshot, std::string &text);
+
+ private:
+  void run();
+
+  void handleClient(int fd);
+
+ private:
+  int               fd_   { -1 };    //!< listen socket
+  int               port_ { 0 };     //!< bound port
+  std::thread       thread_;         //!< server thread
+  std::atomic<bool> stop_ { false }; //!< stop server thread
+};
+
+#endif
@@ -1,16 +1,40 @@
 #ifndef CPerfMonitor_H
 #define CPerfMonitor_H
 
+#include <CQPerfRollup.h>
+#include <CQPerfKernels.h>
+#include <CQPerfChunkPool.h>
+#include <CQPerfTimeCodec.h>
+#include <CQPerfLogger.h>
+#include <CQPerfPatternMatcher.h>
+#include <CQPerfNameIndex.h>
+#include <CQPerfTraceStats.h>
+#include <CQPerfClock.h>
 #include <CHRTime.h>
 #include <cassert>
 #include <QObject>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <map>
+#include <string>
 #include <vector>
 #include <future>
 #include <iostream>
 
 class CQPerfTraceData;
+class CQPerfRecordFile;
+class CQPerfFlightRecorder;
+class CQPerfAlertEngine;
+class CQPerfCallTree;
+class CQPerfRecordReader;
+class CQPerfSnapshot;
+class CQPerfMetricsServer;
+class CQPerfStatsDEmitter;
+class CQPerfReporter;
 class QTimer;
 
 #ifdef CQPERF_MESSAGE
@@ -20,9 +44,210 @@ class CMessage;
 #define CQPerfMonitorInst CQPerfMonitor::getInstance()
 
 struct CQPerfTimeData {
-  uint    depth { 0 };
-  CHRTime start;
-  CHRTime elapsed;
+  uint     depth { 0 };
+  uint32_t tid   { 0 }; //!< thread id (0 for calling thread when added)
+  CHRTime  start;
+  CHRTime  elapsed;
+
+  static int64_t timeToTicks(const CHRTime &t) { return int64_t(t.getUSecs()); }
+
+  static CHRTime ticksToTime(int64_t ticks) { CHRTime t; t.setUSecs(double(ticks)); return t; }
+};
+
+/*!
+ * \brief Struct-of-arrays store of time data
+ *
+ * Start times are held as an array of ticks (usecs), elapsed times as an array of
+ * 32 bit ticks and depths as an array of bytes so range aggregation only streams the
+ * columns it needs. Elapsed times and depths too large for their column are stored
+ * as an escape value with the real value held in a side map.
+ */
+class CQPerfTimeColumns {
+ public:
+  using TimeData     = CQPerfTimeData;
+  using Starts       = std::vector<int64_t>;
+  using Elapseds     = std::vector<uint32_t>;
+  using Depths       = std::vector<uint8_t>;
+  using WideElapseds = std::map<uint, int64_t>;
+  using WideDepths   = std::map<uint, uint>;
+  using RangeStats   = CQPerfKernels::RangeStats;
+
+  static constexpr uint32_t ELAPSED_ESCAPE = 0xFFFFFFFF;
+  static constexpr uint8_t  DEPTH_ESCAPE   = 0xFF;
+
+  class const_iterator {
+   public:
+    const_iterator(const CQPerfTimeColumns *columns, uint i) :
+     columns_(columns), i_(i) {
+    }
+
+    TimeData operator*() const { return columns_->timeData(i_); }
+
+    const_iterator &operator++() { ++i_; return *this; }
+
+    bool operator==(const const_iterator &rhs) const { return i_ == rhs.i_; }
+    bool operator!=(const const_iterator &rhs) const { return i_ != rhs.i_; }
+
+   private:
+    const CQPerfTimeColumns *columns_ { nullptr };
+    uint                     i_       { 0 };
+  };
+
+ public:
+  CQPerfTimeColumns() { }
+
+  uint size() const { return uint(starts_.size()); }
+
+  bool empty() const { return starts_.empty(); }
+
+  void clear();
+
+  void reserve(uint n);
+
+  void push_back(const TimeData &timeData);
+
+  TimeData timeData(uint i) const;
+  void setTimeData(uint i, const TimeData &timeData);
+
+  int64_t start(uint i) const { return starts_[i]; }
+
+  int64_t elapsed(uint i) const;
+
+  uint depth(uint i) const;
+
+  const int64_t  *starts  () const { return starts_  .data(); }
+  const uint32_t *elapseds() const { return elapseds_.data(); }
+  const uint8_t  *depths  () const { return depths_  .data(); }
+
+  //! aggregate entries with start in [t1, t2]
+  void rangeStats(int64_t t1, int64_t t2, RangeStats &stats) const;
+
+  //! aggregate entries with start in [t1, t2) into nb equal width bins
+  void binStats(int64_t t1, int64_t t2, uint nb, RangeStats *bins) const;
+
+  //! memory used by columns (bytes)
+  size_t memorySize() const;
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end  () const { return const_iterator(this, size()); }
+
+ private:
+  void setElapsed(uint i, int64_t elapsed);
+  void setDepth  (uint i, uint depth);
+
+  bool fixWideStats(RangeStats &stats, int64_t start, int64_t elapsed) const;
+  void fixWideMax  (RangeStats &stats, int64_t start, int64_t elapsed) const;
+
+ private:
+  Starts       starts_;       //!< start ticks
+  Elapseds     elapseds_;     //!< elapsed ticks (ELAPSED_ESCAPE if wide)
+  Depths       depths_;       //!< depths (DEPTH_ESCAPE if wide)
+  WideElapseds wideElapseds_; //!< elapsed ticks too large for column
+  WideDepths   wideDepths_;   //!< depths too large for column
+};
+
+/*!
+ * \brief Append only compact store of time data
+ *
+ * Records are a zigzag varint thread id delta from the previous record followed by a
+ * CQPerfTimeCodec record, written into fixed size chunks from CQPerfChunkPool so
+ * appends never reallocate or copy existing data. Records never straddle chunks and
+ * are decoded sequentially, chunk by chunk, by the iterator.
+ *
+ * Appends only write past the used length of the last chunk so a copy of the chunk
+ * list (Range) can be decoded while records are still being added, as long as the
+ * stream is not cleared.
+ */
+class CQPerfTimeStream {
+ public:
+  using TimeData = CQPerfTimeData;
+
+  struct Chunk {
+    uint8_t *data { nullptr }; //!< chunk memory
+    size_t   len  { 0 };       //!< used bytes
+
+    Chunk(uint8_t *data) : data(data) { }
+  };
+
+  using Chunks = std::deque<Chunk>;
+
+  //! max size of encoded record (thread id delta and codec record)
+  static constexpr int MAX_RECORD_SIZE = 5 + CQPerfTimeCodec::MAX_RECORD_SIZE;
+
+  class const_iterator {
+   public:
+    const_iterator(const Chunks *chunks, size_t chunk, size_t pos);
+
+    const TimeData &operator*() const { return timeData_; }
+
+    const_iterator &operator++();
+
+    bool operator==(const const_iterator &rhs) const {
+      return chunk_ == rhs.chunk_ && pos_ == rhs.pos_;
+    }
+
+    bool operator!=(const const_iterator &rhs) const { return ! operator==(rhs); }
+
+   private:
+    void decode();
+
+   private:
+    const Chunks *chunks_ { nullptr };
+    size_t        chunk_  { 0 };
+    size_t        pos_    { 0 };
+    size_t        len_    { 0 };
+    int64_t       start_  { 0 };
+    uint32_t      tid_    { 0 };
+    TimeData      timeData_;
+  };
+
+  //! copy of chunk list to decode records added before the copy was made
+  class Range {
+   public:
+    Range() { }
+
+    Range(const Chunks &chunks) : chunks_(chunks) { }
+
+    const_iterator begin() const { return const_iterator(&chunks_, 0, 0); }
+    const_iterator end  () const { return const_iterator(&chunks_, chunks_.size(), 0); }
+
+   private:
+    Chunks chunks_;
+  };
+
+ public:
+  CQPerfTimeStream() { }
+
+ ~CQPerfTimeStream();
+
+  CQPerfTimeStream(const CQPerfTimeStream &) = delete;
+  CQPerfTimeStream &operator=(const CQPerfTimeStream &) = delete;
+
+  uint size() const { return size_; }
+
+  bool empty() const { return size_ == 0; }
+
+  //! release all chunks back to pool
+  void clear();
+
+  void push_back(const TimeData &timeData);
+
+  const Chunks &chunks() const { return chunks_; }
+
+  //! memory used by stream (bytes)
+  size_t memorySize() const { return chunks_.size()*CQPerfChunkPool::CHUNK_SIZE; }
+
+  //! range of current records (valid until stream is cleared)
+  Range range() const { return Range(chunks_); }
+
+  const_iterator begin() const { return const_iterator(&chunks_, 0, 0); }
+  const_iterator end  () const { return const_iterator(&chunks_, chunks_.size(), 0); }
+
+ private:
+  Chunks   chunks_;         //!< chunks of encoded records
+  uint     size_      { 0 }; //!< number of records
+  int64_t  lastStart_ { 0 }; //!< start of last record
+  uint32_t lastTid_   { 0 }; //!< thread id of last record
 };
 
 /*!
@@ -67,6 +292,20 @@ class CQPerfMonitor : public QObject {
 
   //---
 
+  //! time source (not owned, system time if null). Traces on other threads may still
+  //! be reading a replaced clock so it must outlive all users of the monitor
+  CQPerfClock *clock() const { return clock_.load(std::memory_order_acquire); }
+  void setClock(CQPerfClock *clock) { clock_.store(clock, std::memory_order_release); }
+
+  //! current time from clock
+  CHRTime getTime() const {
+    auto *clock = clock_.load(std::memory_order_acquire);
+
+    return (clock ? clock->getTime() : CHRTime::getTime());
+  }
+
+  //---
+
   void createServer(const QString &name="");
   void createClient(const QString &name="");
 
@@ -81,6 +320,16 @@ class CQPerfMonitor : public QObject {
   int minTime() const { return minTime_; }
   void setMinTime(int i) { minTime_ = i; }
 
+  uint rollupSize() const { return rollupSize_; }
+  void setRollupSize(uint i) { rollupSize_ = i; }
+
+  //! '|' separated wildcard patterns of traces enabled/debugged (applied to existing traces)
+  QString enablePattern() const { return QString::fromStdString(enablePattern_.patterns()); }
+  void setEnablePattern(const QString &pattern);
+
+  QString debugPattern() const { return QString::fromStdString(debugPattern_.patterns()); }
+  void setDebugPattern(const QString &pattern);
+
   //---
 
   void startTrace(const QString &name, TraceType traceType=TraceType::ALL);
@@ -98,9 +347,50 @@ class CQPerfMonitor : public QObject {
 
   bool isRecording() const { return recording_; }
 
-  void startRecording();
+  //! start recording (to memory or, if filename specified, to memory mapped file)
+  void startRecording(const QString &filename="");
   void stopRecording();
 
+  CQPerfRecordFile *recordFile() const { return recordFile_; }
+
+  //! start flight recorder (ring of recent spans in shared memory file). The file is
+  //! removed when stopped (or on exit) unless kept
+  bool startFlightRecorder(const QString &filename="", uint capacity=65536,
+                           bool keepFile=false);
+  void stopFlightRecorder();
+
+  CQPerfFlightRecorder *flightRecorder() const { return flightRecorder_; }
+
+  //! start serving Prometheus text at http://<address>:<port>/metrics (port 0 for any)
+  bool startMetricsServer(int port=9464, const QString &address="127.0.0.1");
+  void stopMetricsServer();
+
+  CQPerfMetricsServer *metricsServer() const { return metricsServer_; }
+
+  //! start pushing trace deltas to StatsD server every interval (msecs)
+  bool startStatsD(const QString &host="127.0.0.1", int port=8125, int interval=10000,
+                   const QString &prefix="cqperf.");
+  void stopStatsD();
+
+  CQPerfStatsDEmitter *statsDEmitter() const { return statsDEmitter_; }
+
+  //! start writing per interval (msecs) trace stats to file (CSV if .csv, else JSONL)
+  //! rotated at max size (0 for no rotation)
+  bool startReporter(const QString &filename, int interval=10000, size_t maxSize=0,
+                     uint maxFiles=4);
+  void stopReporter();
+
+  CQPerfReporter *reporter() const { return reporter_; }
+
+  //! export last recording (in-memory or file) as Chrome Trace Event JSON
+  bool exportRecording(const QString &filename) const;
+
+  //! get call tree of last recording (in-memory or file)
+  void getCallTree(CQPerfCallTree &tree) const;
+
+  //! export call stacks of last recording in folded stack format
+  bool exportFoldedStacks(const QString &filename) const;
+
   bool isTraceEnabled(const QString &name) const;
   void setTraceEnabled(const QString &name, bool enabled);
 
@@ -116,17 +406,54 @@ class CQPerfMonitor : public QObject {
 
   void getTracesStartingWith(const QString &name, TraceList &traces);
 
+  //! get stats of all traces at one instant (no trace published while read)
+  void getSnapshot(CQPerfSnapshot &snapshot) const;
+
+  //! epoch of all trace stats publishes (odd while publishing, see getSnapshot)
+  std::atomic<uint64_t> *statsEpoch() { return &statsEpoch_; }
+
+  //! save snapshot of all traces as baseline file
+  bool saveBaseline(const QString &filename) const;
+
+  //! compare current trace stats against baseline file and report regressions,
+  //! returns number of regressed traces (-1 if baseline can't be read)
+  int compareBaseline(const QString &filename, std::ostream &os=std::cerr) const;
+
+  //! get total calls and elapsed of traces under whole segment prefix (e.g. "Widget::")
+  bool getPrefixStats(const QString &prefix, int64_t &calls, CHRTime &elapsed) const;
+
   void getTraceNames(QStringList &names) const;
 
+  //! merge rollup buckets of trace in ticks range [t1, t2) (false if no trace or rollup)
+  bool traceRollupBucket(const QString &name, int64_t t1, int64_t t2, int64_t resolution,
+                         CQPerfRollup::Bucket &bucket) const;
+
+  //! alert rules (evaluated in background thread)
+  CQPerfAlertEngine *alertEngine() const { return alertEngine_; }
+
   void alert(const CQPerfTraceData *trace, CQPerfMonitor::AlertType type);
 
+  //! set log file (empty for stderr) rotated at max size (0 for no rotation)
+  bool setLogFile(const QString &filename, size_t maxSize=0, uint maxFiles=4);
+
+  //! asynchronous log writer
+  CQPerfLogger *logger() const { return logger_; }
+
+  //! queue log line (written by background thread)
   void log(const QString &msg) const;
 
+  //! queue debug event (formatted by background thread)
+  void logDebug(CQPerfLogger::EventType type, uint id, uint depth, int64_t start,
+                int64_t elapsed=0) const;
+
  signals:
   void stateChanged();
 
   void traceAdded(const QString &name);
 
+  //! alert rule raised or cleared (emitted from alert thread)
+  void alertChanged(const QString &rule, const QString &trace, double value, bool active);
+
  private slots:
   void serverSlot();
   void clientSlot();
@@ -134,35 +461,60 @@ class CQPerfMonitor : public QObject {
  private:
   CQPerfMonitor();
 
- private:
-  using Traces = std::map<QString, CQPerfTraceData *>;
+  //! replace flight recorder (deleting old one once spans being written are done)
+  void setFlightRecorder(CQPerfFlightRecorder *flightRecorder);
 
-  struct NameData {
-    QString name;
-    bool    flushed { false };
+  //! get flight recorder registered for writing one span after unlock (monitor must be
+  //! locked)
+  CQPerfFlightRecorder *useFlightRecorder();
 
-    NameData(const QString &name) : name(name) { }
-  };
+  //! write span to recorder from useFlightRecorder (monitor unlocked)
+  static void addFlightSpan(CQPerfFlightRecorder *flightRecorder,
+                            const CQPerfTraceData *data, const TimeData &timeData);
 
-  using Names = std::vector<NameData>;
+  //! get all traces (monitor must be locked)
+  void getTraces(TraceList &traces) const;
 
-  bool               enabled_     { false }; //!< is trace enabled
-  bool               debug_       { false }; //!< is debug enabled
-  bool               recording_   { false }; //!< is recording
-  Traces             traces_;                //!< active traces
-  uint               windowCount_ { 1000 };  //!< number of traces to keep in history
-  CHRTime            windowTime_;            //!< time span for history
-  uint               numTrace_    { 0 };     //!< number of active traces
-  uint               numDebug_    { 0 };     //!< number of active debugs
-  int                minTime_     { - 1 };   //!< minimum debug time
-  Names              names_;                 //!< buffered names
-  mutable std::mutex mutex_;                 //!< update mutex
+  //! open file of last recording if recorded to file
+  bool openRecordReader(CQPerfRecordReader &reader) const;
+
+  //! set snapshot to stats of traces at time
+  static void getSnapshot(const TraceList &traces, int64_t time, CQPerfSnapshot &snapshot);
+
+ private:
+  using Traces = std::map<QString, CQPerfTraceData *>;
+  using ClockP = std::atomic<CQPerfClock *>;
+
+  bool                  enabled_        { false };   //!< is trace enabled
+  bool                  debug_          { false };   //!< is debug enabled
+  bool                  recording_      { false };   //!< is recording
+  Traces                traces_;                     //!< active traces
+  uint                  windowCount_    { 1000 };    //!< number of traces to keep in history
+  CHRTime               windowTime_;                 //!< time span for history
+  int                   minTime_        { - 1 };     //!< minimum debug time
+  uint                  rollupSize_     { 64 };      //!< number of buckets per rollup
+  CQPerfRecordFile*     recordFile_     { nullptr }; //!< recording file
+  CQPerfFlightRecorder* flightRecorder_ { nullptr }; //!< flight recorder
+  CQPerfAlertEngine*    alertEngine_    { nullptr }; //!< alert rules
+  CQPerfLogger*         logger_         { nullptr }; //!< log writer
+  CQPerfMetricsServer*  metricsServer_  { nullptr }; //!< metrics http server
+  CQPerfStatsDEmitter*  statsDEmitter_  { nullptr }; //!< statsd emitter
+  CQPerfReporter*       reporter_       { nullptr }; //!< interval reporter
+  ClockP                clock_          { nullptr }; //!< time source
+  std::atomic<uint64_t> statsEpoch_     { 0 };       //!< trace stats publish epoch
+  CQPerfPatternMatcher  enablePattern_;              //!< enabled trace patterns
+  CQPerfPatternMatcher  debugPattern_;               //!< debug trace patterns
+  CQPerfNameIndex       nameIndex_;                  //!< trace name prefix tree
+  std::string           recordFilename_;             //!< file of last file recording
+  mutable uint          recordReaders_  { 0 };       //!< exports reading in-memory recording
+  mutable std::mutex    mutex_;                      //!< update mutex
+  mutable std::condition_variable recordCond_;       //!< signalled when export done
 
 #ifdef CQPERF_MESSAGE
-  CMessage*          message_     { nullptr };
-  QTimer*            serverTimer_ { nullptr };
-  QTimer*            clientTimer_ { nullptr };
-  bool               server_      { false };
+  CMessage*             message_        { nullptr };
+  QTimer*               serverTimer_    { nullptr };
+  QTimer*               clientTimer_    { nullptr };
+  bool                  server_         { false };
 #endif
 };
 
@@ -179,26 +531,38 @@ class CQPerfTraceData {
 
   using WindowDatas = std::vector<WindowData>;
 
-  using TraceType = CQPerfMonitor::TraceType;
-  using TimeData  = CQPerfTimeData;
-  using TimeDatas = std::vector<TimeData>;
+  using TraceType   = CQPerfMonitor::TraceType;
+  using TimeData    = CQPerfTimeData;
+  using TimeDatas   = std::vector<TimeData>;
+  using TimeColumns = CQPerfTimeColumns;
+  using TimeStream  = CQPerfTimeStream;
 
  public:
-  CQPerfTraceData(const QString &name);
+  CQPerfTraceData(const QString &name, uint id=0);
 
   const QString &name() const { return name_; }
 
+  //! name as UTF-8 (cached at creation)
+  const std::string &utf8Name() const { return utf8Name_; }
+
+  uint id() const { return id_; }
+
   //---
 
-  void startTrace(uint depth=0);
-  void endTrace  (TraceType traceType);
-  void addTrace  (const TimeData &timeData, TraceType traceType);
+  void startTrace(const CHRTime &start, uint depth=0);
+
+  //! end call started by last startTrace
+  void endTrace(TraceType traceType);
+
+  //! end call (time data of call) with elapsed of nested traces
+  void endTrace(const TimeData &timeData, TraceType traceType, int64_t childElapsed);
+
+  //! add call with elapsed of nested traces (excluded from self time)
+  void addTrace(const TimeData &timeData, TraceType traceType, int64_t childElapsed=0);
 
   //---
 
-  void startDebug(uint depth=0);
-  void endDebug  ();
-  void addDebug  (const TimeData &timeData);
+  void addDebug(const TimeData &timeData);
 
   //---
 
@@ -228,24 +592,56 @@ class CQPerfTraceData {
   const CHRTime &elapsedMin() const { return elapsedMin_; }
   const CHRTime &elapsedMax() const { return elapsedMax_; }
 
+  //! lifetime count, sum, min, max and histogram of elapsed (usecs)
+  const CQPerfRollup::Totals &totals() const { return totals_; }
+
+  //! number of times trace has been reset
+  uint64_t generation() const { return generation_; }
+
+  //! lifetime elapsed not in nested traces of same thread (usecs)
+  int64_t selfElapsed() const { return selfElapsed_; }
+
+  //! get coherent stats without locking (safe from any thread)
+  void getStats(CQPerfTraceStats::Snapshot &snapshot) const { stats_.read(snapshot); }
+
+  //! get coherent lifetime totals without locking (safe from any thread)
+  void getTotals(CQPerfTraceStats::Totals &totals) const { stats_.readTotals(totals); }
+
   int maxCalls() const { return maxCalls_; }
-  void setMaxCalls(int i) { maxCalls_ = i; }
+  void setMaxCalls(int i) { maxCalls_ = i; callsAlerted_ = false; }
 
   const CHRTime &maxTime() const { return maxTime_; }
-  void setMaxTime(const CHRTime &v) { maxTime_ = v; }
+  void setMaxTime(const CHRTime &v) { maxTime_ = v; timeAlerted_ = false; }
 
   const CHRTime &elapsedTime() const { return timeData_.elapsed; }
 
-  const CHRTime &windowStartTime() const;
+  //! time data of last call
+  const TimeData &lastTimeData() const { return timeData_; }
 
-  const CHRTime &windowEndTime() const;
+  CHRTime windowStartTime() const;
+
+  CHRTime windowEndTime() const;
 
   void windowDetails(WindowData &windowData) const;
 
   void windowDetails(const CHRTime &t1, const CHRTime &t2, WindowData &windowData) const;
   void windowDetails(const CHRTime &t1, const CHRTime &t2, TimeDatas &timeDatas) const;
 
-  const TimeDatas &recordTimes() const { return recordTimes_; }
+  //! get details for n equal intervals of time range [t1, t2) in one pass
+  void windowDetails(const CHRTime &t1, const CHRTime &t2, uint n, WindowDatas &windowDatas) const;
+
+  bool rollupDetails(const CHRTime &t1, const CHRTime &t2, double resolution,
+                     WindowData &windowData) const;
+
+  //! merge rollup buckets in ticks range [t1, t2) at resolution no larger than specified
+  const CQPerfRollup *rollupBucket(int64_t t1, int64_t t2, int64_t resolution,
+                                   CQPerfRollup::Bucket &bucket) const;
+
+  const CQPerfRollups &rollups() const { return rollups_; }
+
+  void setIndexNode(CQPerfNameIndex::Node *node) { indexNode_ = node; }
+
+  const TimeStream &recordTimes() const { return recordTimes_; }
 
   void reportStats();
 
@@ -256,36 +652,53 @@ class CQPerfTraceData {
 
   uint windowSize() const;
 
+  //! publish stats (histIndex is only changed histogram bucket, -1 for all)
+  void publishStats(int histIndex);
+
  private:
-  const TimeData &timeData(int i) const {
+  void addWindowData(WindowData &windowData, const CQPerfKernels::RangeStats &stats) const;
+  void addWindowData(WindowData &windowData, int numCalls, int64_t elapsed,
+                     int64_t minT, int64_t maxT) const;
+
+  TimeData timeData(int i) const {
     assert(i >= 0 && i < int(times_.size()));
 
-    return times_[size_t(i)];
+    return times_.timeData(uint(i));
   }
 
   void setTimeData(int i, const TimeData &t) {
     assert(i >= 0 && i < int(times_.size()));
 
-    times_[size_t(i)] = t;
+    times_.setTimeData(uint(i), t);
   }
 
  private:
-  QString   name_;                   //<! trace name
-  bool      enabled_      { true };  //<! is enabled
-  bool      debug_        { false }; //<! is debug enabled
-  bool      recording_    { false }; //<! is recording
-  TimeData  timeData_;               //<! time data
-  TimeDatas times_;                  //<! history times
-  TimeDatas recordTimes_;            //<! recorded times
-  int       posStart_     { 0 };     //<! window start
-  int       posStartNext_ { 0 };     //<! window next start
-  int       sizeLimit_    { -1 };    //<! window size limit
-  int       calls_        { 0 };     //<! number of calls
-  CHRTime   elapsed_;                //<! last elapsed time
-  CHRTime   elapsedMin_;             //<! min elapsed time
-  CHRTime   elapsedMax_;             //<! max elapsed time
-  int       maxCalls_     { -1 };    //<! max calls before alert
-  CHRTime   maxTime_;                //<! max elapsed time before alert
+  QString                name_;                     //<! trace name
+  std::string            utf8Name_;                 //<! trace name as UTF-8
+  uint                   id_           { 0 };       //<! trace id (unique per monitor)
+  bool                   enabled_      { true };    //<! is enabled
+  bool                   debug_        { false };   //<! is debug enabled
+  bool                   recording_    { false };   //<! is recording
+  TimeData               timeData_;                 //<! time data
+  TimeColumns            times_;                    //<! history times
+  TimeStream             recordTimes_;              //<! recorded times
+  int                    posStart_     { 0 };       //<! window start
+  int                    posStartNext_ { 0 };       //<! window next start
+  int                    sizeLimit_    { -1 };      //<! window size limit
+  int                    calls_        { 0 };       //<! number of calls
+  CHRTime                elapsed_;                  //<! last elapsed time
+  CHRTime                elapsedMin_;               //<! min elapsed time
+  CHRTime                elapsedMax_;               //<! max elapsed time
+  int                    maxCalls_     { -1 };      //<! max calls before alert
+  CHRTime                maxTime_;                  //<! max elapsed time before alert
+  bool                   callsAlerted_ { false };   //<! max calls alert raised
+  bool                   timeAlerted_  { false };   //<! max time alert raised
+  CQPerfRollups          rollups_;                  //<! pre-aggregated time buckets
+  CQPerfRollup::Totals   totals_;                   //<! lifetime elapsed totals
+  uint64_t               generation_   { 0 };       //<! reset generation
+  int64_t                selfElapsed_  { 0 };       //<! lifetime self elapsed (usecs)
+  CQPerfNameIndex::Node* indexNode_    { nullptr }; //<! name index node
+  CQPerfTraceStats       stats_;                    //<! published stats
 };
 
 //------
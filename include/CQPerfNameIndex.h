@@ -0,0 +1,84 @@
+#ifndef CQPerfNameIndex_H
+#define CQPerfNameIndex_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class CQPerfTraceData;
+
+/*!
+ * \brief Prefix tree of trace names split into "::" and "/" separated segments
+ *
+ * Each node key is a name segment including its trailing separator so any string
+ * prefix (not just whole segments) can be resolved by descending the tree and then
+ * ranging over the sorted children of the final node. Prefix queries therefore cost
+ * O(prefix + matches) rather than a scan of all traces.
+ *
+ * Each node also holds the total calls and elapsed time of all traces in its subtree
+ * (updated as spans are added) so the total for a subsystem (e.g. "Widget::") is read
+ * directly from its node.
+ */
+class CQPerfNameIndex {
+ public:
+  struct Node {
+    using Children = std::map<std::string, Node *>;
+
+    Node*            parent      { nullptr }; //!< parent node
+    std::string      key;                     //!< segment (with trailing separator)
+    CQPerfTraceData* trace       { nullptr }; //!< trace ending at node
+    Children         children;                //!< child nodes by key
+    int64_t          calls       { 0 };       //!< subtree calls
+    int64_t          elapsed     { 0 };       //!< subtree elapsed (usecs)
+    int64_t          selfCalls   { 0 };       //!< trace calls
+    int64_t          selfElapsed { 0 };       //!< trace elapsed (usecs)
+  };
+
+  using Traces = std::vector<CQPerfTraceData *>;
+
+ public:
+  CQPerfNameIndex();
+ ~CQPerfNameIndex();
+
+  CQPerfNameIndex(const CQPerfNameIndex &) = delete;
+  CQPerfNameIndex &operator=(const CQPerfNameIndex &) = delete;
+
+  const Node *root() const { return &root_; }
+
+  //! add trace, returns its node
+  Node *add(const std::string &name, CQPerfTraceData *trace);
+
+  //! get traces with names starting with prefix
+  void getTraces(const std::string &prefix, Traces &traces) const;
+
+  //! get node for whole segment prefix (e.g. "Widget::") or trace name
+  const Node *findNode(const std::string &prefix) const;
+
+  //! add span stats to node and its ancestors
+  static void addStats(Node *node, int64_t calls, int64_t elapsed) {
+    node->selfCalls   += calls;
+    node->selfElapsed += elapsed;
+
+    for ( ; node; node = node->parent) {
+      node->calls   += calls;
+      node->elapsed += elapsed;
+    }
+  }
+
+  //! remove trace stats of node from it and its ancestors
+  static void resetStats(Node *node);
+
+  //! split name into segments (each with its trailing separator)
+  static void splitName(const std::string &name, std::vector<std::string> &keys);
+
+ private:
+  static void addSubtree(const Node *node, Traces &traces);
+
+  static void deleteChildren(Node *node);
+
+ private:
+  Node root_; //!< root node
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef CQPerfPatternMatcher_H
+#define CQPerfPatternMatcher_H
+
+#include <bitset>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Match names against a set of Unix wildcard patterns in a single pass
+ *
+ * The pattern set ('|' separated, supporting '*', '?', '[...]' classes and '\' escapes)
+ * is compiled once to a position automaton which is converted on demand into a DFA
+ * (states cached as they are reached) so a match is O(name length) and independent
+ * of the number of patterns.
+ */
+class CQPerfPatternMatcher {
+ public:
+  CQPerfPatternMatcher(const std::string &patterns="");
+
+  CQPerfPatternMatcher(const CQPerfPatternMatcher &) = delete;
+  CQPerfPatternMatcher &operator=(const CQPerfPatternMatcher &) = delete;
+
+  const std::string &patterns() const { return patterns_; }
+
+  //! set '|' separated patterns (empty matches nothing)
+  void setPatterns(const std::string &patterns);
+
+  bool isEmpty() const { return tokens_.empty(); }
+
+  bool match(const std::string &name) const;
+
+ private:
+  enum class TokenType {
+    CHAR,  //!< byte in class
+    STAR,  //!< any sequence
+    END    //!< end of pattern
+  };
+
+  struct Token {
+    TokenType          type { TokenType::END };
+    std::bitset<256>   chars;
+  };
+
+  using Tokens    = std::vector<Token>;
+  using Positions = std::vector<uint32_t>;
+
+  struct State {
+    Positions positions;          //!< active token positions (sorted)
+    bool      accept { false };   //!< contains end of pattern
+    int       next[256];          //!< next state by byte (-1 not built)
+  };
+
+  using States   = std::vector<State>;
+  using StateIds = std::map<Positions, int>;
+
+  void addPattern(const std::string &pattern);
+
+  void closure(Positions &positions) const;
+
+  int addState(Positions &positions) const;
+
+  int nextState(int state, uint8_t c) const;
+
+ private:
+  std::string        patterns_;  //!< pattern string
+  Tokens             tokens_;    //!< tokens of all patterns (each ending in END)
+  Positions          starts_;    //!< start position of each pattern
+  mutable States     states_;    //!< DFA states (built on demand)
+  mutable StateIds   stateIds_;  //!< state by positions
+  mutable std::mutex mutex_;     //!< DFA build mutex
+};
+
+#endif
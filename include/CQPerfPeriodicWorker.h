@@ -0,0 +1,56 @@
+#ifndef CQPerfPeriodicWorker_H
+#define CQPerfPeriodicWorker_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/*!
+ * \brief Background thread calling a function every interval
+ *
+ * The function is called with elapsed true when the interval has passed and with
+ * elapsed false when woken early by wake(). Changing the interval wakes the thread so
+ * the next call is rescheduled from the new interval. If final call is set the
+ * function is called once more (with elapsed true) when the thread is stopped.
+ */
+class CQPerfPeriodicWorker {
+ public:
+  using Tick = std::function<void(bool elapsed)>;
+
+ public:
+  CQPerfPeriodicWorker(int64_t interval, const Tick &tick, bool finalCall=false);
+ ~CQPerfPeriodicWorker();
+
+  CQPerfPeriodicWorker(const CQPerfPeriodicWorker &) = delete;
+  CQPerfPeriodicWorker &operator=(const CQPerfPeriodicWorker &) = delete;
+
+  //! call interval (usecs, min 1ms)
+  int64_t interval() const;
+  void setInterval(int64_t i);
+
+  //! call function (with elapsed false) as soon as possible
+  void wake();
+
+  bool isRunning() const;
+
+  void start();
+  void stop();
+
+ private:
+  void run();
+
+ private:
+  mutable std::mutex      mutex_;                 //!< state mutex
+  std::condition_variable cond_;                  //!< wake thread
+  std::thread             thread_;                //!< worker thread
+  Tick                    tick_;                  //!< function called each interval
+  bool                    finalCall_ { false };   //!< call function on stop
+  bool                    running_   { false };   //!< is thread running
+  bool                    stop_      { false };   //!< stop thread
+  bool                    woken_     { false };   //!< early call pending
+  int64_t                 interval_  { 1000000 }; //!< call interval
+};
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef CQPerfRecordFile_H
+#define CQPerfRecordFile_H
+
+#include <CQPerfTimeCodec.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Memory mapped append only binary recording file
+ *
+ * File layout:
+ *  . Header (padded to HEADER_SIZE)
+ *  . Sequence of blocks, each a BlockHeader followed by its payload:
+ *    . NAME  : uint32 trace id, name bytes (string table entry). Trace ids in the file
+ *              are assigned from 0 in definition order so ids are always less than the
+ *              number of NAME blocks
+ *    . SPANS : uint32 thread id, uint32 count, int64 base start, int64 min start,
+ *              int64 max end, then count records of varint trace id followed by a
+ *              CQPerfTimeCodec record (start delta from previous record in block)
+ *    . SYNC  : uint64 SYNC_MAGIC, int64 time, uint64 number of blocks written
+ *    . INDEX : written on close. uint32 number of traces, then for each trace uint32 id,
+ *              uint32 name length, name bytes, uint64 count, int64 elapsed, int64 min,
+ *              int64 max, uint32 max depth. Then uint64 number of span blocks and for
+ *              each uint64 offset, uint32 thread id, uint32 count, int64 min start and
+ *              int64 max end
+ *
+ * The header dataSize is only advanced after a block is completely written so the
+ * file is consistent (and readable) at any point even if the process dies. The
+ * header indexOffset is set once the INDEX block is written so a reader can open
+ * a cleanly closed file without scanning it.
+ */
+class CQPerfRecordFile {
+ public:
+  static constexpr size_t   HEADER_SIZE   = 4096;
+  static constexpr size_t   SEGMENT_SIZE  = 16*1024*1024;
+  static constexpr size_t   BLOCK_SIZE    = 4096;
+  static constexpr size_t   SYNC_INTERVAL = 1024*1024;
+  static constexpr uint32_t VERSION       = 3;
+  static constexpr uint64_t SYNC_MAGIC    = 0x21434e5953505143ULL; // "CQPSYNC!"
+
+  enum class BlockType : uint32_t {
+    NAME  = 1,
+    SPANS = 2,
+    SYNC  = 3,
+    INDEX = 4
+  };
+
+  struct Header {
+    char     magic[8];          //!< "CQPERF\0\1"
+    uint32_t version;           //!< format version
+    uint32_t headerSize;        //!< offset of first block
+    int64_t  startTime;         //!< creation time (usecs)
+    uint64_t dataSize;          //!< bytes of complete blocks after header
+    uint32_t pid;               //!< recording process id
+    uint32_t closed;            //!< set when file closed cleanly
+    uint64_t indexOffset;       //!< offset of INDEX block after header (0 if none)
+  };
+
+  struct BlockHeader {
+    uint32_t type;              //!< block type
+    uint32_t size;              //!< payload size
+  };
+
+  //! summary of span block (from SPANS block header)
+  struct BlockInfo {
+    uint64_t offset   { 0 };    //!< offset of block after header
+    uint32_t tid      { 0 };    //!< thread id
+    uint32_t count    { 0 };    //!< number of records
+    int64_t  minStart { 0 };    //!< min record start
+    int64_t  maxEnd   { 0 };    //!< max record end
+  };
+
+  //! per trace summary
+  struct TraceInfo {
+    uint32_t    id       { 0 }; //!< trace id
+    std::string name;           //!< trace name
+    uint64_t    count    { 0 }; //!< number of spans
+    int64_t     elapsed  { 0 }; //!< total elapsed
+    int64_t     min      { 0 }; //!< min elapsed
+    int64_t     max      { 0 }; //!< max elapsed
+    uint32_t    maxDepth { 0 }; //!< max depth
+
+    void add(int64_t e, uint32_t depth) {
+      if (count == 0) { min = e; max = e; }
+      else            { min = std::min(min, e); max = std::max(max, e); }
+
+      ++count;
+
+      elapsed += e;
+
+      maxDepth = std::max(maxDepth, depth);
+    }
+  };
+
+  using BlockInfos = std::vector<BlockInfo>;
+  using TraceInfos = std::vector<TraceInfo>;
+
+  static const char *magic() { return "CQPERF\0\1"; }
+
+  //! id of calling thread (as recorded in span blocks)
+  static uint32_t currentThreadId();
+
+ public:
+  CQPerfRecordFile();
+ ~CQPerfRecordFile();
+
+  CQPerfRecordFile(const CQPerfRecordFile &) = delete;
+  CQPerfRecordFile &operator=(const CQPerfRecordFile &) = delete;
+
+  const std::string &filename() const { return filename_; }
+
+  bool isOpen() const { return fd_ >= 0; }
+
+  bool open(const std::string &filename);
+  void close();
+
+  //! trace (monitor id) has been written to string table
+  bool isTraceDefined(uint32_t id) const {
+    return id < fileIds_.size() && fileIds_[id];
+  }
+
+  void defineTrace(uint32_t id, const std::string &name);
+
+  //! add span of defined trace (monitor id)
+  void addSpan(uint32_t id, int64_t start, int64_t elapsed, uint32_t depth);
+
+  //! write all pending thread blocks
+  void flush();
+
+  uint64_t dataSize() const { return dataSize_; }
+
+ private:
+  struct ThreadBlock {
+    uint32_t             tid       { 0 };
+    uint32_t             count     { 0 };
+    int64_t              baseStart { 0 };
+    int64_t              lastStart { 0 };
+    int64_t              minStart  { 0 };
+    int64_t              maxEnd    { 0 };
+    std::vector<uint8_t> bytes;
+  };
+
+  using ThreadBlocks = std::map<uint32_t, ThreadBlock>;
+  using FileIds      = std::vector<uint32_t>;
+
+  void flushBlock(ThreadBlock &block);
+
+  bool writeBlock(BlockType type, const void *data, size_t len);
+
+  void writeSync();
+
+  void writeIndex();
+
+  bool write(const void *data, size_t len);
+
+  bool mapSegment(size_t segment);
+  void unmapSegment();
+
+  Header *header() const { return static_cast<Header *>(headerMem_); }
+
+ private:
+  std::string  filename_;                 //!< file name
+  int          fd_           { -1 };      //!< file descriptor
+  void*        headerMem_    { nullptr }; //!< mapped header
+  uint8_t*     segmentMem_   { nullptr }; //!< mapped current data segment
+  size_t       segment_      { 0 };       //!< current data segment
+  uint64_t     dataSize_     { 0 };       //!< bytes written after header
+  uint64_t     numBlocks_    { 0 };       //!< number of blocks written
+  uint64_t     lastSync_     { 0 };       //!< data size at last sync
+  ThreadBlocks threadBlocks_;             //!< pending per-thread span blocks
+  FileIds      fileIds_;                  //!< file id + 1 by monitor id (0 if undefined)
+  TraceInfos   traceInfos_;               //!< per trace summary (by file id)
+  BlockInfos   blockInfos_;               //!< written span blocks
+};
+
+#endif
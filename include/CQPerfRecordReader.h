@@ -0,0 +1,114 @@
+#ifndef CQPerfRecordReader_H
+#define CQPerfRecordReader_H
+
+#include <CQPerfRecordFile.h>
+#include <CQPerfTimeCodec.h>
+#include <CQPerfKernels.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+class CQPerfCallTree;
+
+/*!
+ * \brief Read only access to a recording file written by CQPerfRecordFile
+ *
+ * The file is memory mapped and only its index is read on open (the INDEX block of a
+ * cleanly closed file, or a scan of the block headers if the recording process died)
+ * so large recordings open quickly. Span records are decoded on demand from the span
+ * blocks overlapping the requested time range.
+ */
+class CQPerfRecordReader {
+ public:
+  using Record       = CQPerfTimeCodec::Record;
+  using Records      = std::vector<Record>;
+  using TraceRecords = std::vector<Records>;
+  using Ids          = std::vector<uint32_t>;
+  using RangeStats   = CQPerfKernels::RangeStats;
+  using BlockInfo    = CQPerfRecordFile::BlockInfo;
+  using BlockInfos   = CQPerfRecordFile::BlockInfos;
+  using TraceInfo    = CQPerfRecordFile::TraceInfo;
+  using TraceInfos   = CQPerfRecordFile::TraceInfos;
+
+ public:
+  CQPerfRecordReader();
+ ~CQPerfRecordReader();
+
+  CQPerfRecordReader(const CQPerfRecordReader &) = delete;
+  CQPerfRecordReader &operator=(const CQPerfRecordReader &) = delete;
+
+  const std::string &filename() const { return filename_; }
+
+  bool isOpen() const { return mem_ != nullptr; }
+
+  bool open(const std::string &filename);
+  void close();
+
+  //! file was closed cleanly and index read from file
+  bool isIndexed() const { return indexed_; }
+
+  uint32_t pid() const { return pid_; }
+
+  //! time range of recorded spans (usecs)
+  int64_t startTime() const { return startTime_; }
+  int64_t endTime  () const { return endTime_  ; }
+
+  const TraceInfos &traceInfos() const { return traceInfos_; }
+
+  const TraceInfo *traceInfo(const std::string &name) const;
+
+  const BlockInfos &blockInfos() const { return blockInfos_; }
+
+  //! get spans of trace overlapping time range
+  void spans(uint32_t id, int64_t t1, int64_t t2, Records &records) const;
+
+  //! get spans of each trace overlapping time range (records[i] for ids[i]) in a
+  //! single pass over the blocks
+  void spans(const Ids &ids, int64_t t1, int64_t t2, TraceRecords &records) const;
+
+  //! aggregate spans of each trace with start in [t1, t2) into nb equal width bins
+  //! (bins[i*nb, (i + 1)*nb) for ids[i]) in a single pass over the blocks
+  void binSpans(const Ids &ids, int64_t t1, int64_t t2, uint32_t nb, RangeStats *bins) const;
+
+  //! export all spans as Chrome Trace Event JSON
+  bool exportTraceEvents(const std::string &filename) const;
+
+  //! get call tree of all spans
+  void getCallTree(CQPerfCallTree &tree) const;
+
+ private:
+  bool readIndex(uint64_t offset);
+
+  void scanBlocks();
+
+  void addTraceInfo(const TraceInfo &traceInfo);
+
+  const uint8_t *blockData(uint64_t offset, CQPerfRecordFile::BlockHeader &blockHeader) const;
+
+  template<typename VISITOR>
+  void visitBlock(const BlockInfo &blockInfo, VISITOR visitor) const;
+
+  //! get index of each trace id in ids (-1 if not present)
+  std::vector<int> idSlots(const Ids &ids) const;
+
+ private:
+  using NameIds = std::map<std::string, uint32_t>;
+
+  std::string    filename_;              //!< file name
+  int            fd_        { -1 };      //!< file descriptor
+  const uint8_t* mem_       { nullptr }; //!< mapped file
+  size_t         memSize_   { 0 };       //!< mapped size
+  uint64_t       dataSize_  { 0 };       //!< size of complete blocks
+  uint32_t       pid_       { 0 };       //!< recording process id
+  bool           indexed_   { false };   //!< index read from file
+  int64_t        startTime_ { 0 };       //!< min span start
+  int64_t        endTime_   { 0 };       //!< max span end
+  TraceInfos     traceInfos_;            //!< per trace summary (by id)
+  BlockInfos     blockInfos_;            //!< span blocks
+  NameIds        nameIds_;               //!< trace name to id
+};
+
+#endif
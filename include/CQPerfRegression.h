@@ -0,0 +1,84 @@
+#ifndef CQPerfRegression_H
+#define CQPerfRegression_H
+
+#include <CQPerfSnapshot.h>
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Compare trace stats of a run against a saved baseline snapshot
+ *
+ * A trace regresses when its p50, p99 or mean self time grows past the threshold ratio
+ * and the slowdown is significant: a one-sided Mann-Whitney U test on the two elapsed
+ * histograms (ties handled per log2 bucket) gives the probability that the current
+ * elapsed times are not larger than the baseline ones.
+ */
+class CQPerfRegression {
+ public:
+  enum Metric {
+    METRIC_P50  = (1<<0),
+    METRIC_P99  = (1<<1),
+    METRIC_SELF = (1<<2)
+  };
+
+  struct Thresholds {
+    double  p50Ratio  { 1.10 }; //!< max p50 ratio (current/baseline)
+    double  p99Ratio  { 1.25 }; //!< max p99 ratio (current/baseline)
+    double  selfRatio { 1.10 }; //!< max mean self time ratio (current/baseline)
+    int64_t minDelta  { 5 };    //!< ignore changes smaller than this (usecs)
+    int64_t minCalls  { 20 };   //!< min calls in both runs to compare trace
+    double  maxPValue { 0.01 }; //!< max p-value for significant slowdown
+  };
+
+  struct Result {
+    std::string name;            //!< trace name
+    int64_t     baseCalls { 0 }; //!< baseline calls
+    int64_t     calls     { 0 }; //!< current calls
+    int64_t     baseP50   { 0 }; //!< baseline p50 (usecs)
+    int64_t     p50       { 0 }; //!< current p50 (usecs)
+    int64_t     baseP99   { 0 }; //!< baseline p99 (usecs)
+    int64_t     p99       { 0 }; //!< current p99 (usecs)
+    double      baseSelf  { 0 }; //!< baseline mean self time (usecs)
+    double      self      { 0 }; //!< current mean self time (usecs)
+    double      pValue    { 1 }; //!< probability slowdown is chance
+    uint        regressed { 0 }; //!< regressed metrics (Metric mask)
+  };
+
+  using Results = std::vector<Result>;
+
+ public:
+  CQPerfRegression() { }
+
+  const Thresholds &thresholds() const { return thresholds_; }
+  void setThresholds(const Thresholds &t) { thresholds_ = t; }
+
+  //! compare current stats against baseline, returns number of regressed traces
+  int compare(const CQPerfSnapshot &baseline, const CQPerfSnapshot &current);
+
+  //! compared traces (called enough in both runs)
+  const Results &results() const { return results_; }
+
+  int numRegressions() const { return numRegressions_; }
+
+  //! traces only in baseline/current run
+  const std::vector<std::string> &missing() const { return missing_; }
+  const std::vector<std::string> &added  () const { return added_; }
+
+  //! write regressed traces (all compared traces if verbose)
+  void report(std::ostream &os, bool verbose=false) const;
+
+  //! one-sided Mann-Whitney U p-value that b is not stochastically larger than a
+  static double pValue(const CQPerfRollup::Totals &a, const CQPerfRollup::Totals &b);
+
+ private:
+  Thresholds               thresholds_;           //!< regression thresholds
+  Results                  results_;              //!< compared traces
+  std::vector<std::string> missing_;              //!< traces missing in current run
+  std::vector<std::string> added_;                //!< traces new in current run
+  int                      numRegressions_ { 0 }; //!< number of regressed traces
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef CQPerfReporter_H
+#define CQPerfReporter_H
+
+#include <CQPerfSnapshot.h>
+#include <CQPerfPeriodicWorker.h>
+#include <CQPerfRotatingFile.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/*!
+ * \brief Write per interval trace stats to a rotating JSONL or CSV file
+ *
+ * A background thread takes a monitor snapshot every interval and writes one line for
+ * each trace called since the previous snapshot with the interval count, total, self,
+ * mean and 50/90/99 percentiles of elapsed time (usecs). The series survives after the
+ * live window has moved on so long runs can be graphed afterwards.
+ */
+class CQPerfReporter {
+ public:
+  enum class Format {
+    JSONL,
+    CSV
+  };
+
+ public:
+  CQPerfReporter();
+ ~CQPerfReporter();
+
+  CQPerfReporter(const CQPerfReporter &) = delete;
+  CQPerfReporter &operator=(const CQPerfReporter &) = delete;
+
+  //! set report file rotated at max size (0 for no rotation)
+  bool setFile(const std::string &filename, Format format=Format::JSONL,
+               size_t maxSize=0, uint maxFiles=4);
+
+  const std::string &filename() const { return file_.filename(); }
+
+  Format format() const { return format_; }
+
+  //! report interval (usecs)
+  int64_t interval() const { return worker_.interval(); }
+  void setInterval(int64_t i);
+
+  //! write trace deltas since last report (or start)
+  void report();
+
+  //! write lines for delta snapshot
+  void writeDelta(const CQPerfSnapshot &delta);
+
+  bool isRunning() const;
+
+  void start();
+  void stop();
+
+ private:
+  void writeLines(const CQPerfSnapshot &delta);
+
+ private:
+  CQPerfPeriodicWorker    worker_;                      //!< report thread
+  std::mutex              fileMutex_;                   //!< file/snapshot mutex
+  CQPerfRotatingFile      file_     { "report" };       //!< report file
+  Format                  format_   { Format::JSONL };  //!< line format
+  CQPerfSnapshot          snapshot_;                    //!< last reported snapshot
+  CQPerfSnapshot          current_;                     //!< current snapshot
+  CQPerfSnapshot          delta_;                       //!< current delta
+};
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef CQPerfRollup_H
+#define CQPerfRollup_H
+
+#include <cstdint>
+#include <vector>
+
+/*!
+ * \brief Fixed resolution ring of pre-aggregated time buckets
+ *
+ * Each bucket holds the count, sum, min, max and log2 histogram of the elapsed
+ * times (usecs) of all calls starting in the bucket's time span.
+ */
+class CQPerfRollup {
+ public:
+  static const int NUM_HIST = 24;
+
+  struct Bucket {
+    int64_t  index { -1 };     //!< bucket index (start/resolution)
+    uint32_t count { 0 };      //!< number of calls
+    int64_t  sum   { 0 };      //!< total elapsed
+    int64_t  min   { 0 };      //!< min elapsed
+    int64_t  max   { 0 };      //!< max elapsed
+    uint32_t hist[NUM_HIST] { }; //!< elapsed histogram
+
+    void add(int64_t elapsed);
+    void add(const Bucket &bucket);
+
+    double mean() const { return (count > 0 ? double(sum)/count : 0.0); }
+
+    //! estimate elapsed at percentile (0-1) from histogram
+    int64_t percentile(double p) const;
+  };
+
+  //! lifetime count, sum, min, max and histogram of elapsed (64 bit counts so they
+  //! don't wrap for long running high frequency traces)
+  struct Totals {
+    uint64_t count { 0 };        //!< number of calls
+    int64_t  sum   { 0 };        //!< total elapsed
+    int64_t  min   { 0 };        //!< min elapsed
+    int64_t  max   { 0 };        //!< max elapsed
+    uint64_t hist[NUM_HIST] { }; //!< elapsed histogram
+
+    void add(int64_t elapsed);
+
+    double mean() const { return (count > 0 ? double(sum)/count : 0.0); }
+
+    //! estimate elapsed at percentile (0-1) from histogram
+    int64_t percentile(double p) const;
+  };
+
+  using Buckets = std::vector<Bucket>;
+
+ public:
+  CQPerfRollup(int64_t resolution, uint32_t numBuckets);
+
+  //! bucket width (usecs)
+  int64_t resolution() const { return resolution_; }
+
+  uint32_t numBuckets() const { return numBuckets_; }
+
+  bool isEmpty() const { return lastIndex_ < 0; }
+
+  //! start time of oldest bucket still held
+  int64_t startTime() const;
+
+  //! end time of newest bucket
+  int64_t endTime() const;
+
+  void add(int64_t start, int64_t elapsed);
+
+  void reset();
+
+  //! merge buckets starting in time range [t1, t2)
+  void details(int64_t t1, int64_t t2, Bucket &bucket) const;
+
+  //! histogram bucket of elapsed (usecs): 0 for 0, else i for [2^(i-1), 2^i)
+  static int histIndex(int64_t elapsed);
+
+ private:
+  int64_t  resolution_ { 1000 }; //!< bucket width (usecs)
+  uint32_t numBuckets_ { 0 };    //!< ring size
+  Buckets  buckets_;             //!< bucket ring (allocated on first add)
+  int64_t  lastIndex_  { -1 };   //!< newest bucket index
+};
+
+//---
+
+/*!
+ * \brief Set of rollups at increasing resolutions (1ms, 10ms, 100ms, 1s, 10s, 60s)
+ */
+class CQPerfRollups {
+ public:
+  using Rollups = std::vector<CQPerfRollup>;
+
+ public:
+  CQPerfRollups(uint32_t numBuckets);
+
+  uint32_t numBuckets() const { return numBuckets_; }
+
+  const Rollups &rollups() const { return rollups_; }
+
+  void add(int64_t start, int64_t elapsed);
+
+  void reset();
+
+  //! get coarsest rollup with resolution no larger than specified which holds time t
+  const CQPerfRollup *findRollup(int64_t resolution, int64_t t) const;
+
+ private:
+  uint32_t numBuckets_ { 0 }; //!< buckets per rollup
+  Rollups  rollups_;          //!< rollups (finest first)
+};
+
+#endif
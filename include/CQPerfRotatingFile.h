@@ -0,0 +1,69 @@
+#ifndef CQPerfRotatingFile_H
+#define CQPerfRotatingFile_H
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+/*!
+ * \brief Append only file rotated (file -> file.1 -> file.2 ...) at a maximum size
+ *
+ * A write which would take a non-empty file past the maximum size rotates it first.
+ * An optional header (e.g. CSV column names) is written at the start of each new file.
+ */
+class CQPerfRotatingFile {
+ public:
+  //! description is used in error messages (e.g. "log")
+  CQPerfRotatingFile(const std::string &description="log");
+ ~CQPerfRotatingFile();
+
+  CQPerfRotatingFile(const CQPerfRotatingFile &) = delete;
+  CQPerfRotatingFile &operator=(const CQPerfRotatingFile &) = delete;
+
+  const std::string &filename() const { return filename_; }
+
+  bool isOpen() const { return fp_ != nullptr; }
+
+  //! open file for append (empty filename to close), max size per file (0 for no
+  //! rotation), number of rotated files to keep and stdio buffer size (0 for default)
+  bool open(const std::string &filename, size_t maxSize=0, uint maxFiles=4,
+            size_t bufferSize=0);
+  void close();
+
+  //! header written at start of each new file (set before open)
+  void setHeader(const std::string &header) { header_ = header; }
+
+  //! current file size
+  size_t size() const { return size_; }
+
+  //! writing len bytes (after pending bytes not yet written) would take non-empty file
+  //! past max size
+  bool isFull(size_t len, size_t pending=0) const {
+    return fp_ && maxSize_ > 0 && size_ + pending > 0 && size_ + pending + len > maxSize_;
+  }
+
+  //! write data (rotating first if full)
+  void write(const char *data, size_t len);
+
+  void flush();
+
+  //! move file to file.1 (and older files up) and start new file
+  void rotate();
+
+ private:
+  bool openFile(const char *mode);
+
+  void writeHeader();
+
+ private:
+  std::string description_;            //!< description for errors
+  std::string filename_;               //!< file name (empty for none)
+  std::string header_;                 //!< header of each file
+  FILE*       fp_         { nullptr }; //!< file
+  size_t      size_       { 0 };       //!< current file size
+  size_t      maxSize_    { 0 };       //!< max file size (0 for no rotation)
+  uint        maxFiles_   { 4 };       //!< rotated files to keep
+  size_t      bufferSize_ { 0 };       //!< stdio buffer size
+};
+
+#endif
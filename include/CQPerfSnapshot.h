@@ -0,0 +1,76 @@
+#ifndef CQPerfSnapshot_H
+#define CQPerfSnapshot_H
+
+#include <CQPerfRollup.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Stats of all traces captured at one instant (see CQPerfMonitor::getSnapshot)
+ *
+ * Each trace holds its lifetime count, total, self, min, max and log2 histogram of
+ * elapsed times (usecs). The difference of two snapshots (delta) holds the calls and times of
+ * the interval between them so per interval rates, means and percentiles can be
+ * calculated without walking the live traces again.
+ */
+class CQPerfSnapshot {
+ public:
+  using Totals = CQPerfRollup::Totals;
+
+  struct Trace {
+    std::string name;             //!< trace name
+    uint32_t    id         { 0 }; //!< trace id
+    uint64_t    generation { 0 }; //!< reset generation (changes when trace reset)
+    Totals      stats;            //!< count, sum, min, max and histogram (usecs)
+    int64_t     self       { 0 }; //!< elapsed not in nested traces (usecs)
+
+    double mean() const { return stats.mean(); }
+
+    int64_t percentile(double p) const { return stats.percentile(p); }
+  };
+
+  using Traces = std::vector<Trace>;
+
+ public:
+  CQPerfSnapshot() { }
+
+  //! capture time (usecs)
+  int64_t time() const { return time_; }
+  void setTime(int64_t t) { time_ = t; }
+
+  //! interval covered (usecs), zero unless delta
+  int64_t duration() const { return duration_; }
+
+  bool isDelta() const { return duration_ > 0; }
+
+  //! traces sorted by name
+  const Traces &traces() const { return traces_; }
+
+  const Trace *trace(const std::string &name) const;
+
+  void addTrace(const Trace &trace) { traces_.push_back(trace); }
+
+  //! sort traces by name (required for trace lookup and delta)
+  void sortTraces();
+
+  //! calls per second of trace in delta interval
+  double rate(const Trace &trace) const;
+
+  //! get difference of this snapshot and an earlier one (trace min/max are lifetime
+  //! values of this snapshot, traces reset in between (generation changed) use this
+  //! snapshot's values)
+  void delta(const CQPerfSnapshot &prev, CQPerfSnapshot &delta) const;
+
+  //! save to/load from text file (e.g. baseline for CQPerfRegression)
+  bool save(const std::string &filename) const;
+  bool load(const std::string &filename);
+
+ private:
+  int64_t time_     { 0 }; //!< capture time (usecs)
+  int64_t duration_ { 0 }; //!< delta interval (usecs)
+  Traces  traces_;         //!< trace stats (sorted by name)
+};
+
+#endif
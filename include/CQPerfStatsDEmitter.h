@@ -0,0 +1,89 @@
+#ifndef CQPerfStatsDEmitter_H
+#define CQPerfStatsDEmitter_H
+
+#include <CQPerfSnapshot.h>
+#include <CQPerfPeriodicWorker.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/*!
+ * \brief Push per interval trace deltas to a StatsD server over UDP
+ *
+ * Each flush takes a monitor snapshot, subtracts the previous one and sends, for each
+ * trace called in the interval, a calls counter, an elapsed total counter and the
+ * elapsed histogram as sampled timers (one line per non-empty log2 bucket with sample
+ * rate 1/count). Lines are packed into datagrams of at most maxPacket bytes in a fixed
+ * buffer so network cost depends on the number of traces, not the number of calls.
+ */
+class CQPerfStatsDEmitter {
+ public:
+  static constexpr size_t MAX_PACKET = 65507;
+
+ public:
+  CQPerfStatsDEmitter();
+ ~CQPerfStatsDEmitter();
+
+  CQPerfStatsDEmitter(const CQPerfStatsDEmitter &) = delete;
+  CQPerfStatsDEmitter &operator=(const CQPerfStatsDEmitter &) = delete;
+
+  //! open UDP socket to StatsD server
+  bool open(const std::string &host="127.0.0.1", int port=8125);
+  void close();
+
+  bool isOpen() const { return fd_ >= 0; }
+
+  //! metric name prefix
+  const std::string &prefix() const { return prefix_; }
+  void setPrefix(const std::string &prefix);
+
+  //! max datagram size (bytes)
+  size_t maxPacket() const { return maxPacket_; }
+  void setMaxPacket(size_t n);
+
+  //! flush interval (usecs)
+  int64_t interval() const { return worker_.interval(); }
+  void setInterval(int64_t i);
+
+  //! send trace deltas since last flush (or start)
+  void flush();
+
+  //! send delta snapshot
+  void sendDelta(const CQPerfSnapshot &delta);
+
+  //! number of datagrams/bytes sent
+  uint64_t numPackets() const { return numPackets_; }
+  uint64_t numBytes  () const { return numBytes_; }
+
+  bool isRunning() const;
+
+  void start();
+  void stop();
+
+ private:
+  void emitDelta(const CQPerfSnapshot &delta);
+
+  void emitTrace(const CQPerfSnapshot::Trace &trace);
+
+  void addLine(const char *line, size_t len);
+
+  void sendPacket();
+
+ private:
+  CQPerfPeriodicWorker    worker_;                   //!< flush thread
+  std::mutex              flushMutex_;               //!< flush/packet mutex
+  int                     fd_         { -1 };        //!< UDP socket
+  std::string             prefix_     { "cqperf." }; //!< metric name prefix
+  size_t                  maxPacket_  { 1432 };      //!< max datagram size
+  CQPerfSnapshot          snapshot_;                 //!< last flushed snapshot
+  CQPerfSnapshot          current_;                  //!< current snapshot
+  CQPerfSnapshot          delta_;                    //!< current delta
+  char                    packet_[MAX_PACKET];       //!< packet buffer
+  size_t                  packetLen_  { 0 };         //!< packet length
+  std::atomic<uint64_t>   numPackets_ { 0 };         //!< number of packets sent
+  std::atomic<uint64_t>   numBytes_   { 0 };         //!< number of bytes sent
+};
+
+#endif
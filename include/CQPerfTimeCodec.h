@@ -0,0 +1,44 @@
+#ifndef CQPerfTimeCodec_H
+#define CQPerfTimeCodec_H
+
+#include <cstdint>
+
+/*!
+ * \brief Compact encoding of time data records
+ *
+ * Each record is encoded as:
+ *  . depth byte (0xFF escape followed by varint depth)
+ *  . start ticks as zigzag varint delta from previous record start
+ *  . elapsed ticks as 32 bit little endian (0xFFFFFFFF escape followed by 64 bit value)
+ *
+ * Typical records are 6-8 bytes.
+ */
+namespace CQPerfTimeCodec {
+
+struct Record {
+  int64_t  start   { 0 }; //!< start ticks
+  int64_t  elapsed { 0 }; //!< elapsed ticks
+  uint32_t depth   { 0 }; //!< depth
+};
+
+//! max size of encoded record
+constexpr int MAX_RECORD_SIZE = 1 + 5 + 10 + 4 + 8;
+
+constexpr uint8_t  DEPTH_ESCAPE   = 0xFF;
+constexpr uint32_t ELAPSED_ESCAPE = 0xFFFFFFFF;
+
+//! encode record into buffer (at least MAX_RECORD_SIZE bytes), returns number of bytes
+int encode(const Record &record, int64_t prevStart, uint8_t *buffer);
+
+//! decode record from buffer (ending at end), returns number of bytes (0 if record
+//! is truncated)
+int decode(const uint8_t *buffer, const uint8_t *end, int64_t prevStart, Record &record);
+
+//! encode/decode unsigned LEB128 varint (at most 10 bytes), returns number of bytes
+//! (decode returns 0 if varint is truncated by end)
+int encodeVarint(uint64_t v, uint8_t *buffer);
+int decodeVarint(const uint8_t *buffer, const uint8_t *end, uint64_t &v);
+
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef CQPerfTraceEventWriter_H
+#define CQPerfTraceEventWriter_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Streaming writer for Chrome Trace Event JSON (as loaded by chrome://tracing
+ *        and Perfetto)
+ *
+ * Events are written to the file as they are added (through a large stdio buffer) so
+ * the size of an export is not limited by memory.
+ *
+ * Spans are written as complete ("X") events with times in microseconds.
+ */
+class CQPerfTraceEventWriter {
+ public:
+  static const size_t BUFFER_SIZE = 1024*1024;
+
+ public:
+  CQPerfTraceEventWriter();
+ ~CQPerfTraceEventWriter();
+
+  CQPerfTraceEventWriter(const CQPerfTraceEventWriter &) = delete;
+  CQPerfTraceEventWriter &operator=(const CQPerfTraceEventWriter &) = delete;
+
+  bool isOpen() const { return fp_ != nullptr; }
+
+  bool open(const std::string &filename);
+  bool close();
+
+  //! add metadata event naming process
+  void setProcessName(uint32_t pid, const std::string &name);
+
+  //! add metadata event naming thread
+  void setThreadName(uint32_t pid, uint32_t tid, const std::string &name);
+
+  //! add complete event (start and duration in usecs)
+  void addComplete(const std::string &name, uint32_t pid, uint32_t tid,
+                   int64_t start, int64_t elapsed, uint32_t depth);
+
+  size_t numEvents() const { return numEvents_; }
+
+ private:
+  void startEvent();
+
+  void writeString(const std::string &str);
+
+ private:
+  using Buffer = std::vector<char>;
+
+  std::string filename_;              //!< file name
+  FILE*       fp_        { nullptr }; //!< output file
+  Buffer      buffer_;                //!< output buffer
+  size_t      numEvents_ { 0 };       //!< number of events written
+};
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef CQPerfTraceStats_H
+#define CQPerfTraceStats_H
+
+#include <CQPerfRollup.h>
+
+#include <atomic>
+#include <cstdint>
+
+/*!
+ * \brief Trace statistics published through a seqlock
+ *
+ * The (single, locked) writer bumps the sequence to odd, updates the values and
+ * bumps it back to even. Readers never block the writer: they retry if the sequence
+ * was odd or changed while reading so they always get a coherent snapshot.
+ *
+ * Lifetime totals (64 bit counts and histogram), self time and reset generation are
+ * published with the summary values and read separately (see readTotals).
+ *
+ * An optional epoch shared by all stats published under the same lock is bumped the
+ * same way so readers of several stats can check none changed (single instant).
+ */
+class CQPerfTraceStats {
+ public:
+  struct Snapshot {
+    int64_t calls      { 0 }; //!< number of calls
+    int64_t elapsed    { 0 }; //!< total elapsed (usecs)
+    int64_t elapsedMin { 0 }; //!< min elapsed (usecs)
+    int64_t elapsedMax { 0 }; //!< max elapsed (usecs)
+
+    double mean() const { return (calls > 0 ? double(elapsed)/calls : 0.0); }
+  };
+
+  struct Totals {
+    uint64_t             generation { 0 }; //!< reset generation
+    CQPerfRollup::Totals stats;            //!< lifetime count, sum, min, max and histogram
+    int64_t              self       { 0 }; //!< lifetime self elapsed (usecs)
+  };
+
+ public:
+  CQPerfTraceStats() { }
+
+  CQPerfTraceStats(const CQPerfTraceStats &) = delete;
+  CQPerfTraceStats &operator=(const CQPerfTraceStats &) = delete;
+
+  //! publish new values (caller must serialize writers). Only histogram bucket
+  //! histIndex is stored (all buckets if -1) as one call only changes one bucket.
+  //! Epoch (if any) is odd while publishing
+  void publish(const Snapshot &snapshot, uint64_t generation,
+               const CQPerfRollup::Totals &stats, int64_t self, int histIndex=-1,
+               std::atomic<uint64_t> *epoch=nullptr) {
+    uint64_t seq = seq_.load(std::memory_order_relaxed);
+
+    uint64_t epochSeq = (epoch ? epoch->load(std::memory_order_relaxed) : 0);
+
+    seq_.store(seq + 1, std::memory_order_relaxed);
+
+    if (epoch)
+      epoch->store(epochSeq + 1, std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    calls_     .store(snapshot.calls     , std::memory_order_relaxed);
+    elapsed_   .store(snapshot.elapsed   , std::memory_order_relaxed);
+    elapsedMin_.store(snapshot.elapsedMin, std::memory_order_relaxed);
+    elapsedMax_.store(snapshot.elapsedMax, std::memory_order_relaxed);
+
+    generation_.store(generation , std::memory_order_relaxed);
+    count_     .store(stats.count, std::memory_order_relaxed);
+    sum_       .store(stats.sum  , std::memory_order_relaxed);
+    min_       .store(stats.min  , std::memory_order_relaxed);
+    max_       .store(stats.max  , std::memory_order_relaxed);
+    self_      .store(self       , std::memory_order_relaxed);
+
+    if (histIndex >= 0)
+      hist_[histIndex].store(stats.hist[histIndex], std::memory_order_relaxed);
+    else {
+      for (int i = 0; i < CQPerfRollup::NUM_HIST; ++i)
+        hist_[i].store(stats.hist[i], std::memory_order_relaxed);
+    }
+
+    seq_.store(seq + 2, std::memory_order_release);
+
+    if (epoch)
+      epoch->store(epochSeq + 2, std::memory_order_release);
+  }
+
+  //! read coherent snapshot (lock-free, retries while a publish is in progress)
+  void read(Snapshot &snapshot) const {
+    for (;;) {
+      uint64_t seq1 = seq_.load(std::memory_order_acquire);
+
+      if (seq1 & 1)
+        continue;
+
+      snapshot.calls      = calls_     .load(std::memory_order_relaxed);
+      snapshot.elapsed    = elapsed_   .load(std::memory_order_relaxed);
+      snapshot.elapsedMin = elapsedMin_.load(std::memory_order_relaxed);
+      snapshot.elapsedMax = elapsedMax_.load(std::memory_order_relaxed);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      if (seq_.load(std::memory_order_relaxed) == seq1)
+        break;
+    }
+  }
+
+  //! read coherent lifetime totals (lock-free, retries while a publish is in progress)
+  void readTotals(Totals &totals) const {
+    for (;;) {
+      uint64_t seq1 = seq_.load(std::memory_order_acquire);
+
+      if (seq1 & 1)
+        continue;
+
+      totals.generation  = generation_.load(std::memory_order_relaxed);
+      totals.stats.count = count_     .load(std::memory_order_relaxed);
+      totals.stats.sum   = sum_       .load(std::memory_order_relaxed);
+      totals.stats.min   = min_       .load(std::memory_order_relaxed);
+      totals.stats.max   = max_       .load(std::memory_order_relaxed);
+      totals.self        = self_      .load(std::memory_order_relaxed);
+
+      for (int i = 0; i < CQPerfRollup::NUM_HIST; ++i)
+        totals.stats.hist[i] = hist_[i].load(std::memory_order_relaxed);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      if (seq_.load(std::memory_order_relaxed) == seq1)
+        break;
+    }
+  }
+
+  //! number of publishes (changes when values change)
+  uint64_t version() const { return seq_.load(std::memory_order_acquire)/2; }
+
+ private:
+  using Hist = std::atomic<uint64_t>[CQPerfRollup::NUM_HIST];
+
+  std::atomic<uint64_t> seq_        { 0 }; //!< sequence (odd while writing)
+  std::atomic<int64_t>  calls_      { 0 }; //!< number of calls
+  std::atomic<int64_t>  elapsed_    { 0 }; //!< total elapsed (usecs)
+  std::atomic<int64_t>  elapsedMin_ { 0 }; //!< min elapsed (usecs)
+  std::atomic<int64_t>  elapsedMax_ { 0 }; //!< max elapsed (usecs)
+  std::atomic<uint64_t> generation_ { 0 }; //!< reset generation
+  std::atomic<uint64_t> count_      { 0 }; //!< lifetime number of calls
+  std::atomic<int64_t>  sum_        { 0 }; //!< lifetime total elapsed (usecs)
+  std::atomic<int64_t>  min_        { 0 }; //!< lifetime min elapsed (usecs)
+  std::atomic<int64_t>  max_        { 0 }; //!< lifetime max elapsed (usecs)
+  std::atomic<int64_t>  self_       { 0 }; //!< lifetime self elapsed (usecs)
+  Hist                  hist_       { };   //!< lifetime elapsed histogram
+};
+
+#endif
@@ -0,0 +1,371 @@
+#include <CQPerfAlertEngine.h>
+#include <CQPerfMonitor.h>
+
+#include <algorithm>
+#include <sstream>
+
+CQPerfAlertEngine::
+CQPerfAlertEngine() :
+ worker_(1000000, [this](bool elapsed) {
+   // woken early to deliver queued alerts
+   process(CQPerfTimeData::timeToTicks(CQPerfMonitorInst->getTime()), elapsed);
+ })
+{
+}
+
+CQPerfAlertEngine::
+~CQPerfAlertEngine()
+{
+  stop();
+}
+
+void
+CQPerfAlertEngine::
+setInterval(int64_t i)
+{
+  worker_.setInterval(i);
+}
+
+uint
+CQPerfAlertEngine::
+limitActions() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  return limitActions_;
+}
+
+bool
+CQPerfAlertEngine::
+setLimitActions(uint actions)
+{
+  if (actions & ~uint(ACTION_LOG | ACTION_SIGNAL))
+    return false;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  limitActions_ = actions;
+
+  return true;
+}
+
+bool
+CQPerfAlertEngine::
+addRule(const Rule &rule)
+{
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (rule.name.empty() || ruleDatas_.find(rule.name) != ruleDatas_.end())
+      return false;
+
+    RuleData ruleData;
+
+    ruleData.rule = rule;
+
+    ruleData.rule.window   = std::max(rule.window, int64_t(1));
+    ruleData.rule.debounce = std::max(rule.debounce, 1U);
+
+    ruleDatas_[rule.name] = ruleData;
+  }
+
+  start();
+
+  return true;
+}
+
+bool
+CQPerfAlertEngine::
+removeRule(const std::string &name)
+{
+  bool recording = false;
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto p = ruleDatas_.find(name);
+
+    if (p == ruleDatas_.end())
+      return false;
+
+    recording = (*p).second.recording;
+
+    ruleDatas_.erase(p);
+  }
+
+  if (recording)
+    removeRecordHolder();
+
+  return true;
+}
+
+void
+CQPerfAlertEngine::
+clearRules()
+{
+  uint numRecording = 0;
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    for (const auto &rd : ruleDatas_) {
+      if (rd.second.recording)
+        ++numRecording;
+    }
+
+    ruleDatas_.clear();
+  }
+
+  if (numRecording > 0)
+    removeRecordHolder(numRecording);
+}
+
+void
+CQPerfAlertEngine::
+getRules(Rules &rules) const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  for (const auto &rd : ruleDatas_)
+    rules.push_back(rd.second.rule);
+}
+
+bool
+CQPerfAlertEngine::
+isRaised(const std::string &name) const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  auto p = ruleDatas_.find(name);
+
+  return (p != ruleDatas_.end() && (*p).second.raised);
+}
+
+void
+CQPerfAlertEngine::
+postAlert(const Alert &alert)
+{
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    alerts_.push_back(alert);
+  }
+
+  // thread started by first alert if not running
+  worker_.start();
+  worker_.wake();
+}
+
+void
+CQPerfAlertEngine::
+evaluate(int64_t t)
+{
+  process(t, true);
+}
+
+void
+CQPerfAlertEngine::
+process(int64_t t, bool evalRules)
+{
+  // copy rules so monitor is never locked while holding engine lock (hot path posts
+  // alerts with monitor locked)
+  Rules  rules;
+  Alerts alerts;
+  uint   limitActions = 0;
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (evalRules) {
+      for (const auto &rd : ruleDatas_)
+        rules.push_back(rd.second.rule);
+    }
+
+    std::swap(alerts, alerts_);
+
+    limitActions = limitActions_;
+  }
+
+  //---
+
+  using Values = std::map<std::string, double>;
+
+  Values values;
+
+  for (const auto &rule : rules) {
+    CQPerfRollup::Bucket bucket;
+
+    // use buckets of at most a tenth of the window
+    if (! CQPerfMonitorInst->traceRollupBucket(QString::fromStdString(rule.trace),
+                                               t - rule.window, t, rule.window/10, bucket))
+      continue;
+
+    values[rule.name] = metricValue(rule, bucket);
+  }
+
+  //---
+
+  Deliveries deliveries;
+
+  for (const auto &alert : alerts) {
+    Delivery delivery;
+
+    delivery.alert   = alert;
+    delivery.actions = limitActions;
+
+    deliveries.push_back(delivery);
+  }
+
+  if (! values.empty()) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    for (const auto &v : values) {
+      auto p = ruleDatas_.find(v.first);
+
+      if (p == ruleDatas_.end())
+        continue;
+
+      auto &ruleData = (*p).second;
+
+      const auto &rule = ruleData.rule;
+
+      double clearThreshold =
+        (rule.clearThreshold >= 0.0 ? rule.clearThreshold : rule.threshold);
+
+      // count consecutive evaluations past threshold in direction of change
+      bool changing = (ruleData.raised ? v.second <= clearThreshold : v.second > rule.threshold);
+
+      ruleData.count = (changing ? ruleData.count + 1 : 0);
+
+      if (ruleData.count < rule.debounce)
+        continue;
+
+      ruleData.raised = ! ruleData.raised;
+      ruleData.count  = 0;
+
+      Delivery delivery;
+
+      delivery.alert.rule      = rule.name;
+      delivery.alert.trace     = rule.trace;
+      delivery.alert.value     = v.second;
+      delivery.alert.threshold = (ruleData.raised ? rule.threshold : clearThreshold);
+      delivery.alert.active    = ruleData.raised;
+      delivery.actions         = rule.actions;
+      delivery.callback        = rule.callback;
+
+      if (rule.actions & ACTION_RECORD) {
+        delivery.record    = (ruleData.raised != ruleData.recording);
+        ruleData.recording = ruleData.raised;
+      }
+
+      deliveries.push_back(delivery);
+    }
+  }
+
+  //---
+
+  for (const auto &delivery : deliveries)
+    deliver(delivery);
+}
+
+double
+CQPerfAlertEngine::
+metricValue(const Rule &rule, const CQPerfRollup::Bucket &bucket)
+{
+  switch (rule.metric) {
+    case Metric::PERCENTILE: return double(bucket.percentile(rule.percentile));
+    case Metric::MEAN      : return bucket.mean();
+    case Metric::RATE      : return bucket.count/(rule.window/1000000.0);
+    case Metric::CALLS     : return bucket.count;
+  }
+
+  return 0.0;
+}
+
+void
+CQPerfAlertEngine::
+deliver(const Delivery &delivery)
+{
+  const auto &alert = delivery.alert;
+
+  if (delivery.actions & ACTION_LOG) {
+    std::stringstream ss;
+
+    ss << "Alert " << (alert.active ? "raised" : "cleared") << ": " << alert.rule <<
+          " (" << alert.trace << ") value " << alert.value << " threshold " << alert.threshold;
+
+    CQPerfMonitorInst->log(QString::fromStdString(ss.str()));
+  }
+
+  if ((delivery.actions & ACTION_CALLBACK) && delivery.callback)
+    delivery.callback(alert);
+
+  if (delivery.actions & ACTION_SIGNAL)
+    emit CQPerfMonitorInst->alertChanged(QString::fromStdString(alert.rule),
+                                         QString::fromStdString(alert.trace),
+                                         alert.value, alert.active);
+
+  if (delivery.record) {
+    if (alert.active)
+      addRecordHolder();
+    else
+      removeRecordHolder();
+  }
+}
+
+void
+CQPerfAlertEngine::
+addRecordHolder()
+{
+  std::unique_lock<std::mutex> lock(recordMutex_);
+
+  if (recordHolders_++ > 0)
+    return;
+
+  // leave existing (user) recording alone
+  if (CQPerfMonitorInst->isRecording())
+    return;
+
+  CQPerfMonitorInst->startRecording();
+
+  ownsRecording_ = true;
+}
+
+void
+CQPerfAlertEngine::
+removeRecordHolder(uint n)
+{
+  std::unique_lock<std::mutex> lock(recordMutex_);
+
+  recordHolders_ -= std::min(n, recordHolders_);
+
+  if (recordHolders_ > 0 || ! ownsRecording_)
+    return;
+
+  ownsRecording_ = false;
+
+  CQPerfMonitorInst->stopRecording();
+}
+
+//---
+
+bool
+CQPerfAlertEngine::
+isRunning() const
+{
+  return worker_.isRunning();
+}
+
+void
+CQPerfAlertEngine::
+start()
+{
+  worker_.start();
+}
+
+void
+CQPerfAlertEngine::
+stop()
+{
+  worker_.stop();
+}
@@ -0,0 +1,280 @@
+#include <CQPerfCallTree.h>
+
+#include <algorithm>
+#include <iostream>
+#include <cstdio>
+#include <cinttypes>
+
+CQPerfCallTree::
+CQPerfCallTree()
+{
+  clear();
+}
+
+void
+CQPerfCallTree::
+clear()
+{
+  spans_.clear();
+  nodes_.clear();
+  names_.clear();
+
+  nodes_.push_back(Node());
+
+  maxLevel_ = 0;
+}
+
+void
+CQPerfCallTree::
+setName(uint32_t id, const std::string &name)
+{
+  if (id >= names_.size())
+    names_.resize(id + 1);
+
+  names_[id] = name;
+}
+
+const std::string &
+CQPerfCallTree::
+name(uint32_t id) const
+{
+  static std::string noName;
+
+  return (id < names_.size() ? names_[id] : noName);
+}
+
+void
+CQPerfCallTree::
+addSpan(uint32_t id, uint32_t tid, int64_t start, int64_t elapsed, uint32_t depth)
+{
+  Span span;
+
+  span.start   = start;
+  span.elapsed = elapsed;
+  span.id      = id;
+  span.tid     = tid;
+  span.depth   = depth;
+
+  spans_.push_back(span);
+}
+
+void
+CQPerfCallTree::
+build()
+{
+  // group spans by thread keeping order (spans are normally added as they end so
+  // each thread's spans are already in end order and don't need sorting)
+  std::vector<std::pair<uint32_t, size_t>> tidCounts;
+
+  for (const auto &span : spans_) {
+    if (tidCounts.empty() || tidCounts.back().first != span.tid) {
+      auto p = std::find_if(tidCounts.begin(), tidCounts.end(),
+                            [&](const std::pair<uint32_t, size_t> &tc) {
+                              return tc.first == span.tid; });
+
+      if (p == tidCounts.end()) {
+        tidCounts.push_back(std::make_pair(span.tid, size_t(0)));
+
+        p = tidCounts.end() - 1;
+      }
+
+      std::iter_swap(p, tidCounts.end() - 1);
+    }
+
+    ++tidCounts.back().second;
+  }
+
+  if (tidCounts.size() > 1) {
+    std::vector<size_t> offsets;
+
+    size_t offset = 0;
+
+    for (const auto &tc : tidCounts) {
+      offsets.push_back(offset);
+
+      offset += tc.second;
+    }
+
+    Spans spans(spans_.size());
+
+    for (const auto &span : spans_) {
+      size_t i = 0;
+
+      while (tidCounts[i].first != span.tid)
+        ++i;
+
+      spans[offsets[i]++] = span;
+    }
+
+    spans_.swap(spans);
+  }
+
+  //---
+
+  // ends before (or same end and deeper) so children come before parents
+  auto endLess = [](const Span &lhs, const Span &rhs) {
+    int64_t lend = lhs.start + lhs.elapsed;
+    int64_t rend = rhs.start + rhs.elapsed;
+
+    if (lend != rend) return lend < rend;
+
+    return lhs.depth > rhs.depth;
+  };
+
+  struct StackEntry {
+    uint32_t node;
+    uint32_t depth;
+    int64_t  start;
+    int64_t  end;
+  };
+
+  std::vector<StackEntry> stack;
+
+  size_t pos = 0;
+
+  for (const auto &tc : tidCounts) {
+    auto b = spans_.begin() + long(pos);
+    auto e = b + long(tc.second);
+
+    pos += tc.second;
+
+    if (! std::is_sorted(b, e, endLess))
+      std::sort(b, e, endLess);
+
+    // walk in reverse end order so parents are visited before their children
+    stack.clear();
+
+    for (auto p = e; p != b; ) {
+      const auto &span = *--p;
+
+      int64_t end = span.start + span.elapsed;
+
+      // pop spans which don't enclose this one or are not shallower
+      while (! stack.empty() &&
+             (stack.back().start > span.start || stack.back().end < end ||
+              stack.back().depth >= span.depth))
+        stack.pop_back();
+
+      uint32_t parent = (! stack.empty() ? stack.back().node : ROOT);
+
+      uint32_t node = childNode(parent, span.id);
+
+      auto &nodeData = nodes_[node];
+
+      ++nodeData.count;
+
+      nodeData.total += span.elapsed;
+      nodeData.self  += span.elapsed;
+
+      // parent root has no self time
+      if (parent != ROOT)
+        nodes_[parent].self -= span.elapsed;
+
+      stack.push_back(StackEntry{node, span.depth, span.start, end});
+    }
+  }
+
+  spans_.clear();
+  spans_.shrink_to_fit();
+
+  //---
+
+  auto &root = nodes_[ROOT];
+
+  root.total = 0;
+  root.count = 0;
+
+  for (const auto &child : root.children) {
+    root.total += nodes_[child].total;
+    root.count += nodes_[child].count;
+  }
+}
+
+std::string
+CQPerfCallTree::
+path(uint32_t i, bool folded) const
+{
+  std::vector<uint32_t> ids;
+
+  for ( ; i != ROOT; i = nodes_[i].parent)
+    ids.push_back(nodes_[i].id);
+
+  std::string str;
+
+  for (auto p = ids.rbegin(); p != ids.rend(); ++p) {
+    if (! str.empty())
+      str += ";";
+
+    if (folded) {
+      // ';' separates frames and ' ' separates count in folded format
+      std::string name1 = name(*p);
+
+      std::replace(name1.begin(), name1.end(), ';', '_');
+      std::replace(name1.begin(), name1.end(), ' ', '_');
+
+      str += name1;
+    }
+    else
+      str += name(*p);
+  }
+
+  return str;
+}
+
+bool
+CQPerfCallTree::
+writeFolded(const std::string &filename) const
+{
+  FILE *fp = fopen(filename.c_str(), "w");
+
+  if (! fp) {
+    std::cerr << "Failed to open folded stack file " << filename << "\n";
+    return false;
+  }
+
+  for (uint32_t i = 1; i < uint32_t(nodes_.size()); ++i) {
+    const auto &node = nodes_[i];
+
+    if (node.self <= 0)
+      continue;
+
+    std::string str = path(i, /*folded*/true);
+
+    fprintf(fp, "%s %" PRId64 "\n", str.c_str(), node.self);
+  }
+
+  bool rc = (ferror(fp) == 0);
+
+  if (fclose(fp) != 0)
+    rc = false;
+
+  if (! rc)
+    std::cerr << "Failed to write folded stack file " << filename << "\n";
+
+  return rc;
+}
+
+uint32_t
+CQPerfCallTree::
+childNode(uint32_t parent, uint32_t id)
+{
+  for (const auto &child : nodes_[parent].children)
+    if (nodes_[child].id == id)
+      return child;
+
+  uint32_t child = uint32_t(nodes_.size());
+
+  Node node;
+
+  node.id     = id;
+  node.parent = parent;
+  node.level  = nodes_[parent].level + 1;
+
+  maxLevel_ = std::max(maxLevel_, node.level);
+
+  nodes_.push_back(node);
+
+  nodes_[parent].children.push_back(child);
+
+  return child;
+}
@@ -0,0 +1,91 @@
+#include <CQPerfChunkPool.h>
+
+CQPerfChunkPool *
+CQPerfChunkPool::
+getInstance()
+{
+  static CQPerfChunkPool *inst;
+
+  if (! inst)
+    inst = new CQPerfChunkPool;
+
+  return inst;
+}
+
+CQPerfChunkPool::
+CQPerfChunkPool()
+{
+}
+
+CQPerfChunkPool::
+~CQPerfChunkPool()
+{
+  for (auto *chunk : free_)
+    delete [] chunk;
+}
+
+void
+CQPerfChunkPool::
+setMaxFree(size_t n)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  maxFree_ = n;
+
+  while (free_.size() > maxFree_) {
+    delete [] free_.back();
+
+    free_.pop_back();
+  }
+}
+
+size_t
+CQPerfChunkPool::
+numFree() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  return free_.size();
+}
+
+size_t
+CQPerfChunkPool::
+numAllocated() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  return allocated_;
+}
+
+uint8_t *
+CQPerfChunkPool::
+alloc()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  ++allocated_;
+
+  if (! free_.empty()) {
+    auto *chunk = free_.back();
+
+    free_.pop_back();
+
+    return chunk;
+  }
+
+  return new uint8_t [CHUNK_SIZE];
+}
+
+void
+CQPerfChunkPool::
+release(uint8_t *chunk)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  --allocated_;
+
+  if (free_.size() < maxFree_)
+    free_.push_back(chunk);
+  else
+    delete [] chunk;
+}
@@ -0,0 +1,91 @@
+#include <CQPerfClock.h>
+
+#include <algorithm>
+#include <chrono>
+
+CQPerfVirtualClock::
+CQPerfVirtualClock(int64_t ticks) :
+ ticks_(ticks), realBase_(realTicks())
+{
+}
+
+CHRTime
+CQPerfVirtualClock::
+getTime() const
+{
+  CHRTime t;
+
+  t.setUSecs(double(ticks()));
+
+  return t;
+}
+
+int64_t
+CQPerfVirtualClock::
+ticks() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  return currentTicks();
+}
+
+void
+CQPerfVirtualClock::
+setTicks(int64_t ticks)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  ticks_    = ticks;
+  realBase_ = realTicks();
+}
+
+void
+CQPerfVirtualClock::
+advance(int64_t usecs)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  ticks_    = currentTicks() + usecs;
+  realBase_ = realTicks();
+}
+
+double
+CQPerfVirtualClock::
+speed() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  return speed_;
+}
+
+void
+CQPerfVirtualClock::
+setSpeed(double speed)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  // rebase so time is continuous at speed change
+  ticks_    = currentTicks();
+  realBase_ = realTicks();
+  speed_    = std::max(speed, 0.0);
+}
+
+int64_t
+CQPerfVirtualClock::
+currentTicks() const
+{
+  if (speed_ <= 0.0)
+    return ticks_;
+
+  return ticks_ + int64_t(double(realTicks() - realBase_)*speed_);
+}
+
+int64_t
+CQPerfVirtualClock::
+realTicks()
+{
+  using Clock = std::chrono::steady_clock;
+
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+           Clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,304 @@
+#include <CQPerfFlameGraph.h>
+#include <CQPerfGraph.h>
+
+#include <QPainter>
+#include <QContextMenuEvent>
+#include <QMouseEvent>
+#include <QMenu>
+#include <QAction>
+#include <QToolTip>
+#include <QFileDialog>
+
+namespace {
+
+using CQPerfGraphUtil::formatTime;
+
+// warm color from name hash so same function always has same color
+QColor nameColor(const std::string &name) {
+  uint h = 0;
+
+  for (auto c : name)
+    h = h*31 + uint(static_cast<unsigned char>(c));
+
+  return QColor(int(205 + (h % 50)), int(230*((h >> 8) % 100)/100), int((h >> 16) % 55));
+}
+
+}
+
+//---
+
+CQPerfFlameGraph::
+CQPerfFlameGraph(QWidget *parent) :
+ QFrame(parent)
+{
+  setObjectName("flameGraph");
+
+  setContextMenuPolicy(Qt::DefaultContextMenu);
+}
+
+CQPerfFlameGraph::
+~CQPerfFlameGraph()
+{
+}
+
+void
+CQPerfFlameGraph::
+setCallTree(const CQPerfCallTree &tree)
+{
+  tree_ = tree;
+
+  zoomNode_ = CQPerfCallTree::ROOT;
+
+  update();
+}
+
+void
+CQPerfFlameGraph::
+setZoomNode(uint32_t node)
+{
+  if (node < tree_.nodes().size())
+    zoomNode_ = node;
+
+  update();
+}
+
+void
+CQPerfFlameGraph::
+zoomOut()
+{
+  if (zoomNode_ != CQPerfCallTree::ROOT)
+    setZoomNode(tree_.node(zoomNode_).parent);
+}
+
+void
+CQPerfFlameGraph::
+resetZoom()
+{
+  setZoomNode(CQPerfCallTree::ROOT);
+}
+
+void
+CQPerfFlameGraph::
+contextMenuEvent(QContextMenuEvent *event)
+{
+  auto *menu = new QMenu;
+
+  //---
+
+  auto *zoomOutAction = new QAction("Zoom Out", menu);
+
+  zoomOutAction->setEnabled(zoomNode_ != CQPerfCallTree::ROOT);
+
+  connect(zoomOutAction, SIGNAL(triggered()), this, SLOT(zoomOut()));
+
+  menu->addAction(zoomOutAction);
+
+  auto *resetZoomAction = new QAction("Reset Zoom", menu);
+
+  connect(resetZoomAction, SIGNAL(triggered()), this, SLOT(resetZoom()));
+
+  menu->addAction(resetZoomAction);
+
+  //---
+
+  auto *icicleAction = new QAction("Icicle", menu);
+
+  icicleAction->setCheckable(true);
+  icicleAction->setChecked(isIcicle());
+  icicleAction->setToolTip("Draw root at top");
+
+  connect(icicleAction, SIGNAL(triggered(bool)), this, SLOT(setIcicle(bool)));
+
+  menu->addAction(icicleAction);
+
+  //---
+
+  menu->addSeparator();
+
+  auto *reloadAction = new QAction("Reload", menu);
+
+  connect(reloadAction, SIGNAL(triggered()), this, SIGNAL(reloadRequested()));
+
+  menu->addAction(reloadAction);
+
+  auto *saveAction = new QAction("Save Folded Stacks...", menu);
+
+  connect(saveAction, SIGNAL(triggered()), this, SLOT(saveFoldedSlot()));
+
+  menu->addAction(saveAction);
+
+  //---
+
+  (void) menu->exec(event->globalPos());
+
+  delete menu;
+}
+
+void
+CQPerfFlameGraph::
+saveFoldedSlot()
+{
+  QString filename = QFileDialog::getSaveFileName(this, "Save Folded Stacks", "",
+                                                  "Folded Stacks (*.folded);;All Files (*)");
+
+  if (filename != "")
+    (void) tree_.writeFolded(filename.toStdString());
+}
+
+void
+CQPerfFlameGraph::
+mousePressEvent(QMouseEvent *event)
+{
+  if (event->button() != Qt::LeftButton)
+    return;
+
+  int node = nodeAt(event->pos());
+
+  if (node >= 0)
+    setZoomNode(uint32_t(node));
+}
+
+void
+CQPerfFlameGraph::
+paintEvent(QPaintEvent *)
+{
+  QPainter p(this);
+
+  p.fillRect(rect(), QBrush(Qt::white));
+
+  nodeRects_.clear();
+
+  QFontMetrics fm(font());
+
+  rowHeight_ = fm.height() + 4;
+
+  const auto &zoomNode = tree_.node(zoomNode_);
+
+  if (zoomNode.total <= 0)
+    return;
+
+  drawNode(&p, zoomNode_, 0.0, width(), 0);
+}
+
+void
+CQPerfFlameGraph::
+drawNode(QPainter *p, uint32_t node, double x, double w, uint level)
+{
+  // skip boxes too small to see (and their children)
+  if (w < 1.0)
+    return;
+
+  const auto &nodeData = tree_.node(node);
+
+  QRectF rect = levelRect(x, w, level);
+
+  if (rect.bottom() < 0 || rect.top() > height())
+    return;
+
+  //---
+
+  QString name = (node != CQPerfCallTree::ROOT ?
+    QString::fromStdString(tree_.name(nodeData.id)) : QString("all"));
+
+  QColor c = (node != CQPerfCallTree::ROOT ? nameColor(tree_.name(nodeData.id)) :
+                                             QColor(0xC0,0xC0,0xC0));
+
+  p->setPen(QColor(255,255,255));
+  p->setBrush(c);
+
+  p->drawRect(rect);
+
+  QFontMetrics fm(font());
+
+  if (rect.width() > fm.horizontalAdvance("..")) {
+    p->setPen(Qt::black);
+
+    QString text = fm.elidedText(name, Qt::ElideRight, int(rect.width() - 4));
+
+    p->drawText(rect.adjusted(2, 0, -2, 0), Qt::AlignLeft | Qt::AlignVCenter, text);
+  }
+
+  nodeRects_.push_back(NodeRect(rect, node));
+
+  //---
+
+  // children laid out left to right scaled by total time
+  double scale = w/double(nodeData.total);
+
+  double cx = x;
+
+  for (const auto &child : nodeData.children) {
+    double cw = double(tree_.node(child).total)*scale;
+
+    drawNode(p, child, cx, cw, level + 1);
+
+    cx += cw;
+  }
+}
+
+QRectF
+CQPerfFlameGraph::
+levelRect(double x, double w, uint level) const
+{
+  double y;
+
+  if (isIcicle())
+    y = level*rowHeight_;
+  else
+    y = height() - (level + 1)*rowHeight_;
+
+  return QRectF(x, y, w, rowHeight_);
+}
+
+int
+CQPerfFlameGraph::
+nodeAt(const QPoint &pos) const
+{
+  for (const auto &nodeRect : nodeRects_)
+    if (nodeRect.rect.contains(pos))
+      return int(nodeRect.node);
+
+  return -1;
+}
+
+bool
+CQPerfFlameGraph::
+event(QEvent *e)
+{
+  if (e->type() == QEvent::ToolTip) {
+    auto *helpEvent = static_cast<QHelpEvent *>(e);
+
+    int node = nodeAt(helpEvent->pos());
+
+    if (node > 0) {
+      const auto &nodeData = tree_.node(uint32_t(node));
+
+      double percent = 100.0*double(nodeData.total)/double(tree_.node(zoomNode_).total);
+
+      QString tipText =
+        QString("<table>"
+                "<tr><td colspan=2>%1</td></tr>"
+                "<tr><td>Total</td><td>%2 (%3%)</td></tr>"
+                "<tr><td>Self</td><td>%4</td></tr>"
+                "<tr><td>Calls</td><td>%5</td></tr>"
+                "</table>").
+                arg(QString::fromStdString(tree_.path(uint32_t(node)))).
+                arg(formatTime(double(nodeData.total))).
+                arg(percent, 0, 'f', 2).
+                arg(formatTime(double(nodeData.self))).
+                arg(nodeData.count);
+
+      QToolTip::showText(helpEvent->globalPos(), tipText, this);
+
+      return true;
+    }
+
+    QToolTip::hideText();
+
+    e->ignore();
+
+    return true;
+  }
+
+  return QFrame::event(e);
+}
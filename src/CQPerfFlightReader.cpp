@@ -0,0 +1,231 @@
+#include <CQPerfFlightReader.h>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+CQPerfFlightReader::
+CQPerfFlightReader()
+{
+}
+
+CQPerfFlightReader::
+~CQPerfFlightReader()
+{
+  close();
+}
+
+bool
+CQPerfFlightReader::
+open(const std::string &filename)
+{
+  close();
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+
+  if (fd < 0) {
+    std::cerr << "Failed to open flight recorder file " << filename << "\n";
+    return false;
+  }
+
+  struct stat st;
+
+  if (fstat(fd, &st) != 0 || size_t(st.st_size) < CQPerfFlightRecorder::HEADER_SIZE) {
+    std::cerr << "Invalid flight recorder file " << filename << "\n";
+    ::close(fd);
+    return false;
+  }
+
+  size_t size = size_t(st.st_size);
+
+  void *mem = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+  ::close(fd);
+
+  if (mem == MAP_FAILED) {
+    std::cerr << "Failed to map flight recorder file " << filename << "\n";
+    return false;
+  }
+
+  mem_     = static_cast<uint8_t *>(mem);
+  memSize_ = size;
+
+  const auto *h = header();
+
+  if (memcmp(h->magic, CQPerfFlightRecorder::magic(), sizeof(h->magic)) != 0 ||
+      h->version != CQPerfFlightRecorder::VERSION ||
+      (h->capacity & (h->capacity - 1)) != 0 ||
+      CQPerfFlightRecorder::fileSize(h->capacity, h->maxNames) > size) {
+    std::cerr << "Invalid flight recorder file " << filename << "\n";
+    close();
+    return false;
+  }
+
+  filename_ = filename;
+
+  return true;
+}
+
+void
+CQPerfFlightReader::
+close()
+{
+  if (! mem_)
+    return;
+
+  munmap(mem_, memSize_);
+
+  mem_     = nullptr;
+  memSize_ = 0;
+
+  filename_.clear();
+}
+
+uint32_t
+CQPerfFlightReader::
+pid() const
+{
+  return (mem_ ? header()->pid : 0);
+}
+
+uint32_t
+CQPerfFlightReader::
+capacity() const
+{
+  return (mem_ ? header()->capacity : 0);
+}
+
+uint64_t
+CQPerfFlightReader::
+numWritten() const
+{
+  return (mem_ ? header()->head.load(std::memory_order_acquire) : 0);
+}
+
+std::string
+CQPerfFlightReader::
+name(uint32_t id) const
+{
+  if (mem_ && id < header()->maxNames) {
+    const auto *entry = reinterpret_cast<const NameEntry *>(
+      mem_ + CQPerfFlightRecorder::HEADER_SIZE + size_t(id)*sizeof(NameEntry));
+
+    uint32_t len = entry->state.load(std::memory_order_acquire);
+
+    if (len > 0 && len <= CQPerfFlightRecorder::NAME_SIZE)
+      return std::string(entry->name, len);
+
+    if (len == CQPerfFlightRecorder::NAME_EMPTY)
+      return "";
+  }
+
+  return "trace " + std::to_string(id);
+}
+
+void
+CQPerfFlightReader::
+spans(Spans &spans) const
+{
+  spans.clear();
+
+  if (! mem_)
+    return;
+
+  const auto *h = header();
+
+  uint64_t head     = h->head.load(std::memory_order_acquire);
+  uint64_t capacity = h->capacity;
+
+  const auto *slots = reinterpret_cast<const Slot *>(
+    mem_ + CQPerfFlightRecorder::HEADER_SIZE + size_t(h->maxNames)*sizeof(NameEntry));
+
+  uint64_t first = (head > capacity ? head - capacity : 0);
+
+  spans.reserve(size_t(head - first));
+
+  for (uint64_t index = first; index < head; ++index) {
+    const auto &slot = slots[index & (capacity - 1)];
+
+    // skip slot not written (yet) for this index or torn by a concurrent write
+    uint64_t seq1 = slot.seq.load(std::memory_order_acquire);
+
+    if (seq1 != 2*index + 2)
+      continue;
+
+    Span span;
+
+    span.index   = index;
+    span.start   = slot.start  .load(std::memory_order_relaxed);
+    span.elapsed = slot.elapsed.load(std::memory_order_relaxed);
+    span.id      = slot.id     .load(std::memory_order_relaxed);
+    span.tid     = slot.tid    .load(std::memory_order_relaxed);
+    span.depth   = slot.depth  .load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    uint64_t seq2 = slot.seq.load(std::memory_order_relaxed);
+
+    if (seq2 != seq1)
+      continue;
+
+    spans.push_back(span);
+  }
+}
+
+void
+CQPerfFlightReader::
+dump(std::ostream &os, double secs) const
+{
+  Spans spans;
+
+  this->spans(spans);
+
+  if (spans.empty())
+    return;
+
+  int64_t lastEnd = 0;
+
+  for (const auto &span : spans)
+    lastEnd = std::max(lastEnd, span.start + span.elapsed);
+
+  int64_t minEnd = lastEnd - int64_t(secs*1000000);
+
+  //---
+
+  // group by thread keeping start order
+  std::map<uint32_t, Spans> threadSpans;
+
+  for (const auto &span : spans)
+    if (span.start + span.elapsed >= minEnd)
+      threadSpans[span.tid].push_back(span);
+
+  os << "pid " << pid() << " (" << numWritten() << " spans written, last " <<
+        secs << " secs)\n";
+
+  for (auto &ts : threadSpans) {
+    auto &spans1 = ts.second;
+
+    std::sort(spans1.begin(), spans1.end(), [](const Span &lhs, const Span &rhs) {
+      if (lhs.start != rhs.start) return lhs.start < rhs.start;
+      return lhs.depth < rhs.depth;
+    });
+
+    os << "thread " << ts.first << "\n";
+
+    for (const auto &span : spans1) {
+      char buffer[64];
+
+      // time relative to last span end
+      snprintf(buffer, sizeof(buffer), "%14.6f %12.3f ms ",
+               double(span.start - lastEnd)/1000000.0, double(span.elapsed)/1000.0);
+
+      os << buffer << std::string(std::min(span.depth, 32U)*2, ' ') << name(span.id) << "\n";
+    }
+  }
+}
@@ -0,0 +1,210 @@
+#include <CQPerfFlightRecorder.h>
+#include <CQPerfRecordFile.h>
+
+#include <algorithm>
+#include <iostream>
+#include <new>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+
+std::string
+CQPerfFlightRecorder::
+defaultFilename()
+{
+  return "/dev/shm/CQPerfFlight." + std::to_string(getpid());
+}
+
+size_t
+CQPerfFlightRecorder::
+fileSize(uint32_t capacity, uint32_t maxNames)
+{
+  return HEADER_SIZE + size_t(maxNames)*sizeof(NameEntry) + size_t(capacity)*sizeof(Slot);
+}
+
+CQPerfFlightRecorder::
+CQPerfFlightRecorder()
+{
+}
+
+CQPerfFlightRecorder::
+~CQPerfFlightRecorder()
+{
+  close();
+}
+
+bool
+CQPerfFlightRecorder::
+open(const std::string &filename, uint32_t capacity, bool keepFile)
+{
+  close();
+
+  // round capacity up to power of 2 so slot index is a mask
+  uint32_t capacity1 = 1;
+
+  while (capacity1 < capacity && capacity1 < (1U << 31))
+    capacity1 <<= 1;
+
+  std::string filename1 = (! filename.empty() ? filename : defaultFilename());
+
+  int fd = ::open(filename1.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+  if (fd < 0) {
+    std::cerr << "Failed to open flight recorder file " << filename1 << "\n";
+    return false;
+  }
+
+  size_t size = fileSize(capacity1, MAX_NAMES);
+
+  if (ftruncate(fd, off_t(size)) != 0) {
+    std::cerr << "Failed to size flight recorder file " << filename1 << "\n";
+    ::close(fd);
+    return false;
+  }
+
+  void *mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+  // mapping stays valid after file closed
+  ::close(fd);
+
+  if (mem == MAP_FAILED) {
+    std::cerr << "Failed to map flight recorder file " << filename1 << "\n";
+    return false;
+  }
+
+  filename_ = filename1;
+  keepFile_ = keepFile;
+  mem_      = static_cast<uint8_t *>(mem);
+  memSize_  = size;
+  maxNames_ = MAX_NAMES;
+  mask_     = capacity1 - 1;
+
+  //---
+
+  // file is zero filled so only header needs initializing
+  struct timeval tv;
+
+  gettimeofday(&tv, nullptr);
+
+  auto *h = new (mem_) Header;
+
+  memcpy(h->magic, magic(), sizeof(h->magic));
+
+  h->version   = VERSION;
+  h->pid       = uint32_t(getpid());
+  h->capacity  = capacity1;
+  h->maxNames  = maxNames_;
+  h->startTime = int64_t(tv.tv_sec)*1000000 + tv.tv_usec;
+
+  h->head.store(0, std::memory_order_release);
+
+  return true;
+}
+
+void
+CQPerfFlightRecorder::
+close()
+{
+  if (! mem_)
+    return;
+
+  munmap(mem_, memSize_);
+
+  mem_     = nullptr;
+  memSize_ = 0;
+
+  // file is only needed by reader after crash
+  if (! keepFile_)
+    ::unlink(filename_.c_str());
+}
+
+bool
+CQPerfFlightRecorder::
+isTraceDefined(uint32_t id) const
+{
+  auto *entry = nameEntry(id);
+
+  // ids past name table are not named
+  if (! entry)
+    return true;
+
+  return entry->state.load(std::memory_order_acquire) != 0;
+}
+
+void
+CQPerfFlightRecorder::
+defineTrace(uint32_t id, const std::string &name)
+{
+  auto *entry = nameEntry(id);
+
+  if (! entry)
+    return;
+
+  // claim entry (another thread may be defining it)
+  uint32_t state = 0;
+
+  if (! entry->state.compare_exchange_strong(state, NAME_WRITING, std::memory_order_acquire))
+    return;
+
+  uint32_t len = uint32_t(std::min(name.size(), NAME_SIZE));
+
+  memcpy(entry->name, name.c_str(), len);
+
+  entry->state.store(len > 0 ? len : NAME_EMPTY, std::memory_order_release);
+}
+
+void
+CQPerfFlightRecorder::
+addSpan(uint32_t id, int64_t start, int64_t elapsed, uint32_t depth)
+{
+  if (! mem_)
+    return;
+
+  uint64_t index = header()->head.fetch_add(1, std::memory_order_relaxed);
+
+  auto *s = slot(index);
+
+  // mark slot as being written before updating data (unless already claimed by a newer
+  // writer lapping the ring)
+  uint64_t seq = s->seq.load(std::memory_order_relaxed);
+
+  do {
+    if (seq > 2*index)
+      return;
+  } while (! s->seq.compare_exchange_weak(seq, 2*index + 1, std::memory_order_relaxed));
+
+  std::atomic_thread_fence(std::memory_order_release);
+
+  s->start  .store(start  , std::memory_order_relaxed);
+  s->elapsed.store(elapsed, std::memory_order_relaxed);
+  s->id     .store(id     , std::memory_order_relaxed);
+  s->tid    .store(CQPerfRecordFile::currentThreadId(), std::memory_order_relaxed);
+  s->depth  .store(depth  , std::memory_order_relaxed);
+
+  // only mark written if not claimed by a newer writer meanwhile
+  uint64_t writing = 2*index + 1;
+
+  s->seq.compare_exchange_strong(writing, 2*index + 2, std::memory_order_release,
+                                 std::memory_order_relaxed);
+}
+
+CQPerfFlightRecorder::NameEntry *
+CQPerfFlightRecorder::
+nameEntry(uint32_t id) const
+{
+  if (! mem_ || id >= maxNames_)
+    return nullptr;
+
+  return reinterpret_cast<NameEntry *>(mem_ + HEADER_SIZE + size_t(id)*sizeof(NameEntry));
+}
+
+CQPerfFlightRecorder::Slot *
+CQPerfFlightRecorder::
+slot(uint64_t index) const
+{
+  size_t offset = HEADER_SIZE + size_t(maxNames_)*sizeof(NameEntry);
+
+  return reinterpret_cast<Slot *>(mem_ + offset + size_t(index & mask_)*sizeof(Slot));
+}
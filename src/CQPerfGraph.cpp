@@ -1,5 +1,8 @@
 #include <CQPerfGraph.h>
 #include <CQPerfMonitor.h>
+#include <CQPerfRecordReader.h>
+#include <CQPerfFlameGraph.h>
+#include <CQPerfCallTree.h>
 #include <CQTabSplit.h>
 #include <CQUtil.h>
 #include <CInterval.h>
@@ -21,9 +24,11 @@
 #include <QMenu>
 #include <QAction>
 #include <QToolTip>
+#include <QFileDialog>
 
 #include <svg/perf_record_svg.h>
 #include <svg/perf_stop_svg.h>
+#include <svg/perf_load_svg.h>
 #include <svg/perf_zoom_out_svg.h>
 #include <svg/perf_zoom_in_svg.h>
 
@@ -57,6 +62,48 @@ QColor bgColor(int i) {
   return bg_colors[i % num_bg_colors];
 }
 
+using CQPerfGraphUtil::formatTime;
+
+QString formatTime(const CHRTime &t) {
+  return formatTime(t.getUSecs());
+}
+
+// get number of calls and elapsed for time range using pre-aggregated buckets
+// when they are fine enough for the step size, otherwise scan history
+void intervalDetails(const CQPerfTraceData *trace, const CHRTime &t1, const CHRTime &t2,
+                     double dt, CQPerfTraceData::WindowData &windowData) {
+  if (! trace->rollupDetails(t1, t2, dt, windowData))
+    trace->windowDetails(t1, t2, windowData);
+}
+
+// get number of calls and elapsed for nb steps of size dt from t1 using pre-aggregated
+// buckets when they are fine enough, otherwise bin history in one pass
+void intervalDetails(const CQPerfTraceData *trace, double t1, double dt, uint nb,
+                     CQPerfTraceData::WindowDatas &windowDatas) {
+  windowDatas.clear();
+  windowDatas.resize(nb);
+
+  for (uint j = 0; j < nb; ++j) {
+    CHRTime stepStartTime; stepStartTime.setUSecs(t1 + j*dt);
+    CHRTime stepEndTime  ; stepEndTime  .setUSecs(t1 + (j + 1)*dt);
+
+    if (! trace->rollupDetails(stepStartTime, stepEndTime, dt, windowDatas[j])) {
+      CHRTime startTime; startTime.setUSecs(t1);
+      CHRTime endTime  ; endTime  .setUSecs(t1 + nb*dt);
+
+      windowDatas.clear();
+
+      trace->windowDetails(startTime, endTime, nb, windowDatas);
+
+      return;
+    }
+  }
+}
+
+};
+
+namespace CQPerfGraphUtil {
+
 QString formatTime(double usecs) {
   if      (usecs >= 1000000)
     return QString::asprintf("%.3f secs", usecs/1000000);
@@ -66,11 +113,9 @@ QString formatTime(double usecs) {
     return QString::asprintf("%.3f usecs", usecs);
 }
 
-QString formatTime(const CHRTime &t) {
-  return formatTime(t.getUSecs());
 }
 
-};
+//---
 
 CQPerfDialog *
 CQPerfDialog::
@@ -172,6 +217,15 @@ CQPerfDialog(QWidget *parent) :
 
   controlLayout->addWidget(recordButton_);
 
+  loadButton_ = new CQImageButton(CQPixmapCacheInst->getIcon("PERF_LOAD"));
+  loadButton_->setObjectName("loadButton");
+
+  loadButton_->setToolTip("Load Recording");
+
+  connect(loadButton_, SIGNAL(clicked()), this, SLOT(loadSlot()));
+
+  controlLayout->addWidget(loadButton_);
+
   //---
 
   controlLayout->addStretch(1);
@@ -258,6 +312,14 @@ CQPerfDialog(QWidget *parent) :
 
   //----
 
+  flameGraph_ = new CQPerfFlameGraph(this);
+
+  splitter->addWidget(flameGraph_, "Flame Graph");
+
+  connect(flameGraph_, SIGNAL(reloadRequested()), this, SLOT(updateFlameGraph()));
+
+  //----
+
   stateSlot();
 
   if      (graph_->isShowTotal())
@@ -300,6 +362,8 @@ CQPerfDialog::
 ~CQPerfDialog()
 {
   delete timer_;
+
+  delete reader_;
 }
 
 void
@@ -433,9 +497,108 @@ recordSlot()
     recordButton_->setIcon(CQPixmapCacheInst->getIcon("PERF_RECORD"));
 
     CQPerfMonitorInst->stopRecording();
+
+    updateFlameGraph();
   }
 }
 
+void
+CQPerfDialog::
+loadSlot()
+{
+  if (reader_) {
+    unloadRecording();
+    return;
+  }
+
+  QString filename = QFileDialog::getOpenFileName(this, "Load Recording", "",
+                                                  "Recordings (*.cqperf);;All Files (*)");
+
+  if (filename != "")
+    (void) loadRecording(filename);
+}
+
+bool
+CQPerfDialog::
+loadRecording(const QString &filename)
+{
+  auto *reader = new CQPerfRecordReader;
+
+  if (! reader->open(filename.toStdString())) {
+    delete reader;
+    return false;
+  }
+
+  unloadRecording();
+
+  reader_ = reader;
+
+  graph_->setReader(reader_);
+  list_ ->setReader(reader_);
+
+  graph_->setNames(QStringList());
+
+  // live controls do not apply to recording
+  enableCheck_   ->setEnabled(false);
+  debugCheck_    ->setEnabled(false);
+  windowSizeSpin_->setEnabled(false);
+  recordButton_  ->setEnabled(false);
+
+  loadButton_->setToolTip("Close Recording");
+
+  setWindowTitle(QString("Performance Monitor Graph - %1").arg(filename));
+
+  graph_->update();
+
+  updateFlameGraph();
+
+  return true;
+}
+
+void
+CQPerfDialog::
+unloadRecording()
+{
+  if (! reader_)
+    return;
+
+  graph_->setReader(nullptr);
+  list_ ->setReader(nullptr);
+
+  graph_->setNames(QStringList());
+
+  delete reader_;
+
+  reader_ = nullptr;
+
+  enableCheck_   ->setEnabled(true);
+  debugCheck_    ->setEnabled(true);
+  windowSizeSpin_->setEnabled(true);
+  recordButton_  ->setEnabled(true);
+
+  loadButton_->setToolTip("Load Recording");
+
+  setWindowTitle("Performance Monitor Graph");
+
+  graph_->update();
+
+  updateFlameGraph();
+}
+
+void
+CQPerfDialog::
+updateFlameGraph()
+{
+  CQPerfCallTree tree;
+
+  if (reader_)
+    reader_->getCallTree(tree);
+  else
+    CQPerfMonitorInst->getCallTree(tree);
+
+  flameGraph_->setCallTree(tree);
+}
+
 void
 CQPerfDialog::
 stateSlot()
@@ -575,7 +738,7 @@ paintEvent(QPaintEvent *)
 
   //---
 
-  if (CQPerfMonitorInst->isEnabled()) {
+  if (reader_ || CQPerfMonitorInst->isEnabled()) {
     if (! isShowDepth() && ! isShowRecording())
       drawIntervalGraph(&p);
     else
@@ -593,10 +756,17 @@ void
 CQPerfGraph::
 drawIntervalGraph(QPainter *p)
 {
-  CHRTime endTime = CHRTime::getTime();
-  CHRTime startTime;
+  CHRTime endTime, startTime;
 
-  startTime.setUSecs(endTime.getUSecs() - windowSize()*1000);
+  if (reader_) {
+    startTime = CQPerfTimeData::ticksToTime(reader_->startTime());
+    endTime   = CQPerfTimeData::ticksToTime(reader_->endTime  ());
+  }
+  else {
+    endTime = CQPerfMonitorInst->getTime();
+
+    startTime.setUSecs(endTime.getUSecs() - windowSize()*1000);
+  }
 
   //---
 
@@ -616,41 +786,68 @@ drawIntervalGraph(QPainter *p)
 
   //---
 
-  // get max calls and elapsed
+  // get number of calls and elapsed for each step of each trace and max calls and elapsed
+  using TraceWindowDatas = std::vector<CQPerfTraceData::WindowDatas>;
+
+  TraceWindowDatas traceWindowDatas;
+
+  traceWindowDatas.resize(uint(names_.size()));
+
   int    maxCalls   = 0;
   double maxElapsed = 0;
 
-  for (int i = 0; i < names_.length(); ++i) {
-    CQPerfTraceData *trace = CQPerfMonitorInst->getTrace(names_[i]);
+  if (reader_)
+    updateRecordBins(xmin_, dt, nb, (isShowTotal() ? startTime.getUSecs() : xmin_));
 
-    if (isShowTotal()) {
-      CQPerfTraceData::WindowData windowData;
+  for (uint i = 0; i < uint(names_.length()); ++i) {
+    CQPerfTraceData *trace = (! reader_ ? CQPerfMonitorInst->getTrace(names_[int(i)]) : nullptr);
 
-      trace->windowDetails(startTime, endTime, windowData);
+    auto &windowDatas = traceWindowDatas[i];
+
+    if (reader_) {
+      windowDatas.resize(nb);
 
-      maxCalls   = std::max(maxCalls  , windowData.numCalls);
-      maxElapsed = std::max(maxElapsed, windowData.elapsed.getUSecs());
-    }
-    else {
       for (uint j = 0; j < nb; ++j) {
-        // get step time range
-        double tt1 = xmin_ + j*dt;
-        double tt2 = tt1 + dt;
+        const auto &bin = recordBins_.bins[i*nb + j];
 
-        CHRTime stepStartTime; stepStartTime.setUSecs(tt1);
-        CHRTime stepEndTime  ; stepEndTime  .setUSecs(tt2);
+        windowDatas[j].numCalls = int(bin.count);
+        windowDatas[j].elapsed  = CQPerfTimeData::ticksToTime(bin.sum);
+      }
+    }
+    else
+      intervalDetails(trace, xmin_, dt, nb, windowDatas);
 
-        //---
+    // accumulate from start of window for totals
+    if (isShowTotal()) {
+      CQPerfTraceData::WindowData totalData;
 
-        CQPerfTraceData::WindowData windowData;
+      if (xmin_ > startTime.getUSecs()) {
+        if (reader_) {
+          const auto &bin = recordBins_.startBins[i];
 
-        // get number of calls and elapsed for step time range
-        trace->windowDetails(stepStartTime, stepEndTime, windowData);
+          totalData.numCalls = int(bin.count);
+          totalData.elapsed  = CQPerfTimeData::ticksToTime(bin.sum);
+        }
+        else {
+          CHRTime stepStartTime; stepStartTime.setUSecs(xmin_);
 
-        maxCalls   = std::max(maxCalls  , windowData.numCalls);
-        maxElapsed = std::max(maxElapsed, windowData.elapsed.getUSecs());
+          intervalDetails(trace, startTime, stepStartTime, dt, totalData);
+        }
+      }
+
+      for (auto &windowData : windowDatas) {
+        totalData.numCalls += windowData.numCalls;
+        totalData.elapsed  += windowData.elapsed;
+
+        windowData.numCalls = totalData.numCalls;
+        windowData.elapsed  = totalData.elapsed;
       }
     }
+
+    for (const auto &windowData : windowDatas) {
+      maxCalls   = std::max(maxCalls  , windowData.numCalls);
+      maxElapsed = std::max(maxElapsed, windowData.elapsed.getUSecs());
+    }
   }
 
   //---
@@ -770,10 +967,6 @@ drawIntervalGraph(QPainter *p)
   //---
 
   for (uint i = 0; i < uint(names_.length()); ++i) {
-    auto *trace = CQPerfMonitorInst->getTrace(names_[int(i)]);
-
-    //---
-
     TraceDrawData &traceDrawData = traceDrawDatas[i];
 
     if (isShowPoints()) {
@@ -793,21 +986,7 @@ drawIntervalGraph(QPainter *p)
       double tt1 = xmin_ + j*dt;
       double tt2 = tt1 + dt;
 
-      CHRTime stepStartTime; stepStartTime.setUSecs(tt1);
-      CHRTime stepEndTime  ; stepEndTime  .setUSecs(tt2);
-
-      //---
-
-      CQPerfTraceData::WindowData windowData;
-
-      if (isShowTotal()) {
-        // get number of calls and elapsed from start of window to delta time
-        trace->windowDetails(startTime, stepEndTime, windowData);
-      }
-      else {
-        // get number of calls and elapsed for step time range
-        trace->windowDetails(stepStartTime, stepEndTime, windowData);
-      }
+      const auto &windowData = traceWindowDatas[i][j];
 
       //---
 
@@ -936,13 +1115,17 @@ drawDepthGraph(QPainter *p)
 {
   CHRTime minTime, maxTime;
 
-  if (isShowDepth()) {
-    maxTime = CHRTime::getTime();
+  if      (reader_) {
+    minTime = CQPerfTimeData::ticksToTime(reader_->startTime());
+    maxTime = CQPerfTimeData::ticksToTime(reader_->endTime  ());
+  }
+  else if (isShowDepth()) {
+    maxTime = CQPerfMonitorInst->getTime();
 
     minTime.setUSecs(maxTime.getUSecs() - windowSize()*1000);
   }
   else {
-    minTime = CHRTime::getTime();
+    minTime = CQPerfMonitorInst->getTime();
     maxTime = 0;
   }
 
@@ -952,6 +1135,15 @@ drawDepthGraph(QPainter *p)
   uint maxDepth = 0;
 
   for (int i = 0; i < names_.length(); ++i) {
+    if (reader_) {
+      const auto *traceInfo = reader_->traceInfo(names_[i].toStdString());
+
+      if (traceInfo)
+        maxDepth = std::max(maxDepth, uint(traceInfo->maxDepth));
+
+      continue;
+    }
+
     CQPerfTraceData *trace = CQPerfMonitorInst->getTrace(names_[i]);
 
     if (isShowDepth()) {
@@ -963,7 +1155,7 @@ drawDepthGraph(QPainter *p)
         maxDepth = std::max(maxDepth, timeData.depth);
     }
     else {
-      const CQPerfTraceData::TimeDatas &timeDatas = trace->recordTimes();
+      const CQPerfTraceData::TimeStream &timeDatas = trace->recordTimes();
 
       for (const auto &timeData : timeDatas) {
         maxDepth = std::max(maxDepth, timeData.depth);
@@ -1082,54 +1274,62 @@ drawDepthGraph(QPainter *p)
 
   //---
 
-  for (uint i = 0; i < uint(names_.length()); ++i) {
-    auto *trace = CQPerfMonitorInst->getTrace(names_[int(i)]);
+  // only decode recording file spans in visible range (all traces in one pass)
+  CQPerfRecordReader::TraceRecords traceRecords;
 
-    TraceRectTips &traceRectTips = traceDrawDatas[i];
+  if (reader_) {
+    CQPerfRecordReader::Ids ids;
 
-    //---
+    for (const auto &name : names_) {
+      const auto *traceInfo = reader_->traceInfo(name.toStdString());
 
-    if (isShowDepth()) {
-      CQPerfTraceData::TimeDatas timeDatas;
+      ids.push_back(traceInfo ? traceInfo->id : uint32_t(-1));
+    }
 
-      trace->windowDetails(minTime, maxTime, timeDatas);
+    reader_->spans(ids, int64_t(xmin_), int64_t(xmax_), traceRecords);
+  }
 
-      for (const auto &timeData : timeDatas) {
-        double startTime = timeData.start.getUSecs();
-        double deltaTime = timeData.elapsed.getUSecs();
+  for (uint i = 0; i < uint(names_.length()); ++i) {
+    TraceRectTips &traceRectTips = traceDrawDatas[i];
 
-        QString tipText =
-          QString("<table>"
-                  "<tr><td colspan=2>%1</td></tr>"
-                  "<tr><td>Elapsed</td><td>%2</td></tr>"
-                  "</table>").
-                  arg(names_[int(i)]).
-                  arg(formatTime(deltaTime));
+    auto addRectTip = [&](double startTime, double deltaTime, uint depth) {
+      QString tipText =
+        QString("<table>"
+                "<tr><td colspan=2>%1</td></tr>"
+                "<tr><td>Elapsed</td><td>%2</td></tr>"
+                "</table>").
+                arg(names_[int(i)]).
+                arg(formatTime(deltaTime));
 
-        QRectF rect(startTime, timeData.depth - 1, deltaTime, 1);
+      QRectF rect(startTime, depth - 1, deltaTime, 1);
 
-        traceRectTips.rectTips.push_back(RectTip(rect, names_[int(i)], tipText));
-      }
+      traceRectTips.rectTips.push_back(RectTip(rect, names_[int(i)], tipText));
+    };
+
+    //---
+
+    if (reader_) {
+      for (const auto &record : traceRecords[i])
+        addRectTip(double(record.start), double(record.elapsed), record.depth);
+
+      continue;
     }
-    else {
-      const CQPerfTraceData::TimeDatas &timeDatas = trace->recordTimes();
 
-      for (const auto &timeData : timeDatas) {
-        double startTime = timeData.start.getUSecs();
-        double deltaTime = timeData.elapsed.getUSecs();
+    auto *trace = CQPerfMonitorInst->getTrace(names_[int(i)]);
 
-        QString tipText =
-          QString("<table>"
-                  "<tr><td colspan=2>%1</td></tr>"
-                  "<tr><td>Elapsed</td><td>%2</td></tr>"
-                  "</table>").
-                  arg(names_[int(i)]).
-                  arg(formatTime(deltaTime));
+    if (isShowDepth()) {
+      CQPerfTraceData::TimeDatas timeDatas;
 
-        QRectF rect(startTime, timeData.depth - 1, deltaTime, 1);
+      trace->windowDetails(minTime, maxTime, timeDatas);
 
-        traceRectTips.rectTips.push_back(RectTip(rect, names_[int(i)], tipText));
-      }
+      for (const auto &timeData : timeDatas)
+        addRectTip(timeData.start.getUSecs(), timeData.elapsed.getUSecs(), timeData.depth);
+    }
+    else {
+      const CQPerfTraceData::TimeStream &timeDatas = trace->recordTimes();
+
+      for (const auto &timeData : timeDatas)
+        addRectTip(timeData.start.getUSecs(), timeData.elapsed.getUSecs(), timeData.depth);
     }
   }
 
@@ -1205,8 +1405,12 @@ drawStatsGraph(QPainter *p)
   for (int i = 0; i < names_.length(); ++i) {
     CQPerfTraceData *trace = CQPerfMonitorInst->getTrace(names_[i]);
 
-    maxCalls   = std::max(maxCalls  , trace->numCalls());
-    maxElapsed = std::max(maxElapsed, trace->elapsedMax().getMSecs());
+    CQPerfTraceStats::Snapshot stats;
+
+    trace->getStats(stats);
+
+    maxCalls   = std::max(maxCalls  , int(stats.calls));
+    maxElapsed = std::max(maxElapsed, stats.elapsedMax/1000.0);
   }
 
   //---
@@ -1322,6 +1526,10 @@ drawStatsGraph(QPainter *p)
   for (int i = 0; i < names_.length(); ++i) {
     CQPerfTraceData *trace = CQPerfMonitorInst->getTrace(names_[i]);
 
+    CQPerfTraceStats::Snapshot stats;
+
+    trace->getStats(stats);
+
     QString tipText =
       QString("<table>"
               "<tr><td colspan=2>%1</td></tr>"
@@ -1330,15 +1538,15 @@ drawStatsGraph(QPainter *p)
               "<tr><td>Max</td><td>%4</td></tr>"
               "</table>").
               arg(names_[i]).
-              arg(trace->numCalls()).
-              arg(formatTime(trace->elapsedMin())).
-              arg(formatTime(trace->elapsedMax()));
+              arg(int(stats.calls)).
+              arg(formatTime(double(stats.elapsedMin))).
+              arg(formatTime(double(stats.elapsedMax)));
 
     if      (isShowElapsed() && isShowCount()) {
       double px1, py1, px2, py2;
 
-      countToPixel(i + 0.0, 0                , px1, py1);
-      countToPixel(i + 0.5, trace->numCalls(), px2, py2);
+      countToPixel(i + 0.0, 0               , px1, py1);
+      countToPixel(i + 0.5, int(stats.calls), px2, py2);
 
       QRectF rect1(px1, py1, px2 - px1, py2 - py1);
 
@@ -1351,8 +1559,8 @@ drawStatsGraph(QPainter *p)
 
       //---
 
-      elapsedToPixel(i + 0.5, trace->elapsedMin().getMSecs(), px1, py1);
-      elapsedToPixel(i + 1.0, trace->elapsedMax().getMSecs(), px2, py2);
+      elapsedToPixel(i + 0.5, stats.elapsedMin/1000.0, px1, py1);
+      elapsedToPixel(i + 1.0, stats.elapsedMax/1000.0, px2, py2);
 
       QRectF rect2(px1, py1, px2 - px1, py2 - py1);
 
@@ -1366,8 +1574,8 @@ drawStatsGraph(QPainter *p)
     else if (isShowElapsed()) {
       double px1, py1, px2, py2;
 
-      elapsedToPixel(i + 0.0, trace->elapsedMin().getMSecs(), px1, py1);
-      elapsedToPixel(i + 1.0, trace->elapsedMax().getMSecs(), px2, py2);
+      elapsedToPixel(i + 0.0, stats.elapsedMin/1000.0, px1, py1);
+      elapsedToPixel(i + 1.0, stats.elapsedMax/1000.0, px2, py2);
 
       QRectF rect(px1, py1, px2 - px1, py2 - py1);
 
@@ -1381,8 +1589,8 @@ drawStatsGraph(QPainter *p)
     else if (isShowCount()) {
       double px1, py1, px2, py2;
 
-      countToPixel(i + 0.0, 0                , px1, py1);
-      countToPixel(i + 1.0, trace->numCalls(), px2, py2);
+      countToPixel(i + 0.0, 0               , px1, py1);
+      countToPixel(i + 1.0, int(stats.calls), px2, py2);
 
       QRectF rect(px1, py1, px2 - px1, py2 - py1);
 
@@ -1544,6 +1752,49 @@ elapsedToPixel(double x, double y, double &px, double &py)
     py = height() - bmargin_;
 }
 
+// get number of calls and elapsed for nb steps of size dt from t1 (and totals from
+// start time to t1) for all traces from recording file in one pass over the blocks
+// overlapping the time range. Results are kept until the range or traces change.
+void
+CQPerfGraph::
+updateRecordBins(double t1, double dt, uint nb, double startTime)
+{
+  auto &rb = recordBins_;
+
+  if (rb.names == names_ && rb.t1 == t1 && rb.dt == dt && rb.nb == nb &&
+      rb.startTime == startTime && rb.bins.size() == size_t(names_.size())*nb)
+    return;
+
+  rb.names     = names_;
+  rb.t1        = t1;
+  rb.dt        = dt;
+  rb.nb        = nb;
+  rb.startTime = startTime;
+
+  rb.bins     .clear();
+  rb.startBins.clear();
+
+  rb.bins     .resize(size_t(names_.size())*nb);
+  rb.startBins.resize(size_t(names_.size()));
+
+  // unknown traces use an id with no spans
+  CQPerfRecordReader::Ids ids;
+
+  for (const auto &name : names_) {
+    const auto *traceInfo = reader_->traceInfo(name.toStdString());
+
+    ids.push_back(traceInfo ? traceInfo->id : uint32_t(-1));
+  }
+
+  int64_t it1 = int64_t(t1);
+  int64_t it2 = int64_t(t1 + nb*dt);
+
+  reader_->binSpans(ids, it1, it2, nb, rb.bins.data());
+
+  if (startTime < t1)
+    reader_->binSpans(ids, int64_t(startTime), it1, 1, rb.startBins.data());
+}
+
 //---
 
 class CQPerfListRealItem : public QTableWidgetItem {
@@ -1616,6 +1867,15 @@ CQPerfList(QWidget *parent) :
   connect(this, SIGNAL(cellClicked(int, int)), this, SLOT(clickSlot(int, int)));
 }
 
+void
+CQPerfList::
+setReader(CQPerfRecordReader *reader)
+{
+  reader_ = reader;
+
+  reload();
+}
+
 void
 CQPerfList::
 reload()
@@ -1624,7 +1884,13 @@ reload()
 
   QStringList names;
 
-  CQPerfMonitorInst->getTraceNames(names);
+  if (reader_) {
+    for (const auto &traceInfo : reader_->traceInfos())
+      if (! traceInfo.name.empty())
+        names.push_back(QString::fromStdString(traceInfo.name));
+  }
+  else
+    CQPerfMonitorInst->getTraceNames(names);
 
   clear();
 
@@ -1648,8 +1914,11 @@ reload()
     auto *minItem     = new CQPerfListRealItem();
     auto *maxItem     = new CQPerfListRealItem();
 
-    enabledItem->setCheckState(Qt::Unchecked);
-    debugItem  ->setCheckState(Qt::Unchecked);
+    // no enable/debug control for recording
+    if (! reader_) {
+      enabledItem->setCheckState(Qt::Unchecked);
+      debugItem  ->setCheckState(Qt::Unchecked);
+    }
 
     setItem(i, 0, enabledItem);
     setItem(i, 1, debugItem  );
@@ -1681,15 +1950,32 @@ refresh()
 
     QString name = nameItem->text();
 
-    CQPerfTraceData *data = CQPerfMonitorInst->getTrace(name);
+    if (reader_) {
+      const auto *traceInfo = reader_->traceInfo(name.toStdString());
+
+      if (traceInfo) {
+        countItem  ->setValue(int(traceInfo->count));
+        elapsedItem->setValue(double(traceInfo->elapsed)/1000000.0);
+        minItem    ->setValue(double(traceInfo->min    )/1000.0);
+        maxItem    ->setValue(double(traceInfo->max    )/1000.0);
+      }
+    }
+    else {
+      CQPerfTraceData *data = CQPerfMonitorInst->getTrace(name);
+
+      enabledItem->setCheckState(data->isEnabled() ? Qt::Checked : Qt::Unchecked);
+      debugItem  ->setCheckState(data->isDebug  () ? Qt::Checked : Qt::Unchecked);
+
+      // coherent stats without blocking traced threads
+      CQPerfTraceStats::Snapshot stats;
 
-    enabledItem->setCheckState(data->isEnabled() ? Qt::Checked : Qt::Unchecked);
-    debugItem  ->setCheckState(data->isDebug  () ? Qt::Checked : Qt::Unchecked);
+      data->getStats(stats);
 
-    countItem  ->setValue(data->numCalls());
-    elapsedItem->setValue(data->elapsed   ().getSecs ());
-    minItem    ->setValue(data->elapsedMin().getMSecs());
-    maxItem    ->setValue(data->elapsedMax().getMSecs());
+      countItem  ->setValue(int(stats.calls));
+      elapsedItem->setValue(double(stats.elapsed   )/1000000.0);
+      minItem    ->setValue(double(stats.elapsedMin)/1000.0);
+      maxItem    ->setValue(double(stats.elapsedMax)/1000.0);
+    }
 
     nameItem   ->setToolTip(nameItem   ->text());
     countItem  ->setToolTip(countItem  ->text());
@@ -1737,6 +2023,9 @@ void
 CQPerfList::
 clickSlot(int row, int column)
 {
+  if (reader_)
+    return;
+
   QTableWidgetItem *nameItem = item(row, 2);
 
   QString name = nameItem->text();
@@ -0,0 +1,291 @@
+#include <CQPerfKernels.h>
+
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CQPERF_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace CQPerfKernels {
+
+void
+RangeStats::
+add(int64_t start, int64_t elapsed)
+{
+  ++count;
+
+  sum += elapsed;
+
+  minStart   = std::min(minStart  , start);
+  maxEnd     = std::max(maxEnd    , start + elapsed);
+  minElapsed = std::min(minElapsed, elapsed);
+  maxElapsed = std::max(maxElapsed, elapsed);
+}
+
+void
+RangeStats::
+add(const RangeStats &stats)
+{
+  count += stats.count;
+  sum   += stats.sum;
+
+  minStart   = std::min(minStart  , stats.minStart  );
+  maxEnd     = std::max(maxEnd    , stats.maxEnd    );
+  minElapsed = std::min(minElapsed, stats.minElapsed);
+  maxElapsed = std::max(maxElapsed, stats.maxElapsed);
+}
+
+//---
+
+namespace {
+
+void rangeStatsScalar(const int64_t *starts, const uint32_t *elapseds, uint32_t i1, uint32_t n,
+                      int64_t t1, int64_t t2, RangeStats &stats) {
+  for (uint32_t i = i1; i < n; ++i) {
+    if (starts[i] >= t1 && starts[i] <= t2)
+      stats.add(starts[i], int64_t(elapseds[i]));
+  }
+}
+
+#ifdef CQPERF_KERNELS_X86
+__attribute__((target("sse4.2")))
+void rangeStatsSSE42(const int64_t *starts, const uint32_t *elapseds, uint32_t n,
+                     int64_t t1, int64_t t2, RangeStats &stats) {
+  const __m128i t1v   = _mm_set1_epi64x(t1 - 1);
+  const __m128i t2v   = _mm_set1_epi64x(t2);
+  const __m128i maxv  = _mm_set1_epi64x(INT64_MAX);
+  const __m128i minv  = _mm_set1_epi64x(INT64_MIN);
+  const __m128i zerov = _mm_setzero_si128();
+
+  __m128i countv      = zerov;
+  __m128i sumv        = zerov;
+  __m128i minStartv   = maxv;
+  __m128i maxEndv     = minv;
+  __m128i minElapsedv = maxv;
+  __m128i maxElapsedv = minv;
+
+  uint32_t n2 = n & ~1U;
+
+  for (uint32_t i = 0; i < n2; i += 2) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(starts   + i));
+    __m128i e = _mm_cvtepu32_epi64(
+                  _mm_loadl_epi64(reinterpret_cast<const __m128i *>(elapseds + i)));
+
+    // mask = (s > t1 - 1) && ! (s > t2)
+    __m128i mask = _mm_andnot_si128(_mm_cmpgt_epi64(s, t2v), _mm_cmpgt_epi64(s, t1v));
+
+    countv = _mm_sub_epi64(countv, mask);
+    sumv   = _mm_add_epi64(sumv, _mm_and_si128(e, mask));
+
+    __m128i se  = _mm_add_epi64(s, e);
+    __m128i ms  = _mm_blendv_epi8(maxv, s , mask);
+    __m128i mse = _mm_blendv_epi8(minv, se, mask);
+    __m128i me1 = _mm_blendv_epi8(maxv, e , mask);
+    __m128i me2 = _mm_blendv_epi8(minv, e , mask);
+
+    minStartv   = _mm_blendv_epi8(minStartv  , ms , _mm_cmpgt_epi64(minStartv, ms  ));
+    maxEndv     = _mm_blendv_epi8(maxEndv    , mse, _mm_cmpgt_epi64(mse, maxEndv    ));
+    minElapsedv = _mm_blendv_epi8(minElapsedv, me1, _mm_cmpgt_epi64(minElapsedv, me1));
+    maxElapsedv = _mm_blendv_epi8(maxElapsedv, me2, _mm_cmpgt_epi64(me2, maxElapsedv));
+  }
+
+  alignas(16) int64_t a[2];
+
+  _mm_store_si128(reinterpret_cast<__m128i *>(a), countv);
+
+  RangeStats stats1;
+
+  stats1.count = a[0] + a[1];
+
+  _mm_store_si128(reinterpret_cast<__m128i *>(a), sumv);
+
+  stats1.sum = a[0] + a[1];
+
+  _mm_store_si128(reinterpret_cast<__m128i *>(a), minStartv);
+
+  stats1.minStart = std::min(a[0], a[1]);
+
+  _mm_store_si128(reinterpret_cast<__m128i *>(a), maxEndv);
+
+  stats1.maxEnd = std::max(a[0], a[1]);
+
+  _mm_store_si128(reinterpret_cast<__m128i *>(a), minElapsedv);
+
+  stats1.minElapsed = std::min(a[0], a[1]);
+
+  _mm_store_si128(reinterpret_cast<__m128i *>(a), maxElapsedv);
+
+  stats1.maxElapsed = std::max(a[0], a[1]);
+
+  rangeStatsScalar(starts, elapseds, n2, n, t1, t2, stats1);
+
+  stats.add(stats1);
+}
+
+__attribute__((target("avx2")))
+int64_t reduceSumAVX2(const __m256i &v) {
+  alignas(32) int64_t a[4];
+
+  _mm256_store_si256(reinterpret_cast<__m256i *>(a), v);
+
+  return a[0] + a[1] + a[2] + a[3];
+}
+
+__attribute__((target("avx2")))
+int64_t reduceMinAVX2(const __m256i &v) {
+  alignas(32) int64_t a[4];
+
+  _mm256_store_si256(reinterpret_cast<__m256i *>(a), v);
+
+  return std::min(std::min(a[0], a[1]), std::min(a[2], a[3]));
+}
+
+__attribute__((target("avx2")))
+int64_t reduceMaxAVX2(const __m256i &v) {
+  alignas(32) int64_t a[4];
+
+  _mm256_store_si256(reinterpret_cast<__m256i *>(a), v);
+
+  return std::max(std::max(a[0], a[1]), std::max(a[2], a[3]));
+}
+
+__attribute__((target("avx2")))
+void rangeStatsAVX2(const int64_t *starts, const uint32_t *elapseds, uint32_t n,
+                    int64_t t1, int64_t t2, RangeStats &stats) {
+  const __m256i t1v   = _mm256_set1_epi64x(t1 - 1);
+  const __m256i t2v   = _mm256_set1_epi64x(t2);
+  const __m256i maxv  = _mm256_set1_epi64x(INT64_MAX);
+  const __m256i minv  = _mm256_set1_epi64x(INT64_MIN);
+  const __m256i zerov = _mm256_setzero_si256();
+
+  __m256i countv      = zerov;
+  __m256i sumv        = zerov;
+  __m256i minStartv   = maxv;
+  __m256i maxEndv     = minv;
+  __m256i minElapsedv = maxv;
+  __m256i maxElapsedv = minv;
+
+  uint32_t n4 = n & ~3U;
+
+  for (uint32_t i = 0; i < n4; i += 4) {
+    __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(starts   + i));
+    __m256i e = _mm256_cvtepu32_epi64(
+                  _mm_loadu_si128(reinterpret_cast<const __m128i *>(elapseds + i)));
+
+    // mask = (s > t1 - 1) && ! (s > t2)
+    __m256i mask = _mm256_andnot_si256(_mm256_cmpgt_epi64(s, t2v), _mm256_cmpgt_epi64(s, t1v));
+
+    countv = _mm256_sub_epi64(countv, mask);
+    sumv   = _mm256_add_epi64(sumv, _mm256_and_si256(e, mask));
+
+    __m256i se  = _mm256_add_epi64(s, e);
+    __m256i ms  = _mm256_blendv_epi8(maxv, s , mask);
+    __m256i mse = _mm256_blendv_epi8(minv, se, mask);
+    __m256i me1 = _mm256_blendv_epi8(maxv, e , mask);
+    __m256i me2 = _mm256_blendv_epi8(minv, e , mask);
+
+    minStartv   = _mm256_blendv_epi8(minStartv  , ms , _mm256_cmpgt_epi64(minStartv, ms  ));
+    maxEndv     = _mm256_blendv_epi8(maxEndv    , mse, _mm256_cmpgt_epi64(mse, maxEndv    ));
+    minElapsedv = _mm256_blendv_epi8(minElapsedv, me1, _mm256_cmpgt_epi64(minElapsedv, me1));
+    maxElapsedv = _mm256_blendv_epi8(maxElapsedv, me2, _mm256_cmpgt_epi64(me2, maxElapsedv));
+  }
+
+  RangeStats stats1;
+
+  stats1.count      = reduceSumAVX2(countv);
+  stats1.sum        = reduceSumAVX2(sumv);
+  stats1.minStart   = reduceMinAVX2(minStartv);
+  stats1.maxEnd     = reduceMaxAVX2(maxEndv);
+  stats1.minElapsed = reduceMinAVX2(minElapsedv);
+  stats1.maxElapsed = reduceMaxAVX2(maxElapsedv);
+
+  rangeStatsScalar(starts, elapseds, n4, n, t1, t2, stats1);
+
+  stats.add(stats1);
+}
+#endif
+
+Impl detectImpl() {
+#ifdef CQPERF_KERNELS_X86
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2"))
+    return Impl::AVX2;
+
+  if (__builtin_cpu_supports("sse4.2"))
+    return Impl::SSE42;
+#endif
+
+  return Impl::SCALAR;
+}
+
+Impl s_impl = detectImpl();
+
+}
+
+//---
+
+Impl
+impl()
+{
+  return s_impl;
+}
+
+void
+setImpl(Impl impl)
+{
+  s_impl = std::min(impl, detectImpl());
+}
+
+void
+rangeStats(const int64_t *starts, const uint32_t *elapseds, uint32_t n,
+           int64_t t1, int64_t t2, RangeStats &stats)
+{
+  if (n == 0 || t2 < t1)
+    return;
+
+  // t1 - 1 is used for the inclusive compare
+  if (t1 == INT64_MIN)
+    t1 = INT64_MIN + 1;
+
+#ifdef CQPERF_KERNELS_X86
+  if      (s_impl == Impl::AVX2)
+    rangeStatsAVX2(starts, elapseds, n, t1, t2, stats);
+  else if (s_impl == Impl::SSE42)
+    rangeStatsSSE42(starts, elapseds, n, t1, t2, stats);
+  else
+#endif
+    rangeStatsScalar(starts, elapseds, 0, n, t1, t2, stats);
+}
+
+uint32_t
+binIndex(int64_t start, int64_t t1, double scale, uint32_t nb)
+{
+  return std::min(uint32_t(double(start - t1)*scale), nb - 1);
+}
+
+void
+binStats(const int64_t *starts, const uint32_t *elapseds, uint32_t n,
+         int64_t t1, int64_t t2, uint32_t nb, RangeStats *bins)
+{
+  if (n == 0 || nb == 0 || t2 <= t1)
+    return;
+
+  // bin index computation and scatter do not vectorize well so use a single
+  // scalar pass instead of one range scan per bin
+  double scale = double(nb)/double(t2 - t1);
+
+  for (uint32_t i = 0; i < n; ++i) {
+    int64_t start = starts[i];
+
+    if (start < t1 || start >= t2)
+      continue;
+
+    auto ib = binIndex(start, t1, scale, nb);
+
+    bins[ib].add(start, int64_t(elapseds[i]));
+  }
+}
+
+}
@@ -0,0 +1,350 @@
+#include <CQPerfLogger.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+CQPerfLogger::
+CQPerfLogger(uint32_t capacity)
+{
+  // round capacity up to power of 2 so cell index is a mask (cells are allocated
+  // on first use)
+  uint64_t capacity1 = 2;
+
+  while (capacity1 < capacity)
+    capacity1 <<= 1;
+
+  mask_ = capacity1 - 1;
+}
+
+CQPerfLogger::
+~CQPerfLogger()
+{
+  // writer drains queue before exiting
+  stop_.store(true);
+
+  wake();
+
+  if (thread_.joinable())
+    thread_.join();
+}
+
+bool
+CQPerfLogger::
+setFile(const std::string &filename, size_t maxSize, uint maxFiles)
+{
+  flush();
+
+  std::unique_lock<std::mutex> lock(fileMutex_);
+
+  return file_.open(filename, maxSize, maxFiles);
+}
+
+void
+CQPerfLogger::
+defineName(uint32_t id, const std::string &name)
+{
+  std::unique_lock<std::mutex> lock(namesMutex_);
+
+  if (id >= names_.size())
+    names_.resize(id + 1);
+
+  names_[id] = name;
+}
+
+bool
+CQPerfLogger::
+log(const char *str, size_t len)
+{
+  uint64_t pos;
+
+  auto *cell = claimCell(pos);
+
+  if (! cell)
+    return false;
+
+  cell->type = EventType::TEXT;
+  cell->len  = uint32_t(std::min(len, LINE_SIZE));
+
+  memcpy(cell->str, str, cell->len);
+
+  publish(cell, pos);
+
+  return true;
+}
+
+bool
+CQPerfLogger::
+logEvent(const Event &event)
+{
+  uint64_t pos;
+
+  auto *cell = claimCell(pos);
+
+  if (! cell)
+    return false;
+
+  cell->type = event.type;
+  cell->len  = uint32_t(sizeof(Event));
+
+  memcpy(cell->str, &event, sizeof(Event));
+
+  publish(cell, pos);
+
+  return true;
+}
+
+CQPerfLogger::Cell *
+CQPerfLogger::
+claimCell(uint64_t &pos)
+{
+  std::call_once(startFlag_, [this]() { start(); });
+
+  // claim cell (bounded MPMC ring of D. Vyukov, used with single consumer)
+  pos = enqueuePos_.load(std::memory_order_relaxed);
+
+  for (;;) {
+    auto *cell = &cells_[pos & mask_];
+
+    uint64_t seq = cell->seq.load(std::memory_order_acquire);
+
+    int64_t diff = int64_t(seq) - int64_t(pos);
+
+    if      (diff == 0) {
+      if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        return cell;
+    }
+    else if (diff < 0) {
+      // full
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    else
+      pos = enqueuePos_.load(std::memory_order_relaxed);
+  }
+}
+
+void
+CQPerfLogger::
+publish(Cell *cell, uint64_t pos)
+{
+  cell->seq.store(pos + 1, std::memory_order_release);
+
+  // only take park lock if writer is parked
+  if (parked_.load(std::memory_order_relaxed))
+    wake();
+}
+
+void
+CQPerfLogger::
+flush()
+{
+  uint64_t pos = enqueuePos_.load(std::memory_order_acquire);
+
+  if (thread_.joinable() && written_.load(std::memory_order_acquire) < pos)
+    wake();
+
+  while (thread_.joinable() && written_.load(std::memory_order_acquire) < pos)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void
+CQPerfLogger::
+start()
+{
+  cells_ = Cells(mask_ + 1);
+
+  for (uint64_t i = 0; i <= mask_; ++i)
+    cells_[i].seq.store(i, std::memory_order_relaxed);
+
+  buffer_.reserve(65536);
+
+  thread_ = std::thread(&CQPerfLogger::run, this);
+}
+
+void
+CQPerfLogger::
+run()
+{
+  int idle = 0;
+
+  for (;;) {
+    bool stop = stop_.load();
+
+    size_t n = writeQueued();
+
+    if (n > 0) {
+      idle = 0;
+      continue;
+    }
+
+    if (stop)
+      break;
+
+    // nothing to write so poll while lines have recently arrived (producers never
+    // block to wake writer)
+    if (++idle < MAX_IDLE_POLLS) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      continue;
+    }
+
+    // park until woken by producer. Producers check parked without a fence so a
+    // wake can be missed, the timeout bounds the delay of such a line
+    std::unique_lock<std::mutex> lock(parkMutex_);
+
+    parked_.store(true);
+
+    if (isQueueEmpty() && ! stop_.load())
+      parkCond_.wait_for(lock, std::chrono::seconds(1));
+
+    parked_.store(false);
+
+    idle = 0;
+  }
+}
+
+bool
+CQPerfLogger::
+isQueueEmpty() const
+{
+  const auto &cell = cells_[dequeuePos_ & mask_];
+
+  return (cell.seq.load(std::memory_order_acquire) != dequeuePos_ + 1);
+}
+
+void
+CQPerfLogger::
+wake()
+{
+  std::unique_lock<std::mutex> lock(parkMutex_);
+
+  parkCond_.notify_one();
+}
+
+size_t
+CQPerfLogger::
+writeQueued()
+{
+  std::unique_lock<std::mutex> lock(fileMutex_);
+
+  size_t n = 0;
+
+  for (;;) {
+    auto &cell = cells_[dequeuePos_ & mask_];
+
+    uint64_t seq = cell.seq.load(std::memory_order_acquire);
+
+    if (seq != dequeuePos_ + 1)
+      break;
+
+    if (cell.type == EventType::TEXT)
+      writeLine(cell.str, cell.len);
+    else {
+      Event event;
+
+      memcpy(&event, cell.str, sizeof(Event));
+
+      writeEvent(event);
+    }
+
+    // release cell for next use
+    cell.seq.store(dequeuePos_ + mask_ + 1, std::memory_order_release);
+
+    ++dequeuePos_;
+    ++n;
+  }
+
+  //---
+
+  // report dropped lines
+  uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+
+  if (dropped != reported_) {
+    auto msg = "CQPerfLogger: " + std::to_string(dropped - reported_) + " lines dropped";
+
+    writeLine(msg.c_str(), msg.size());
+
+    reported_ = dropped;
+  }
+
+  //---
+
+  // write batch
+  if (! buffer_.empty()) {
+    if (file_.isOpen()) {
+      file_.write(&buffer_[0], buffer_.size());
+
+      file_.flush();
+    }
+    else {
+      fwrite(&buffer_[0], 1, buffer_.size(), stderr);
+
+      fflush(stderr);
+    }
+
+    buffer_.clear();
+  }
+
+  written_.store(dequeuePos_, std::memory_order_release);
+
+  return n;
+}
+
+void
+CQPerfLogger::
+writeLine(const char *str, size_t len)
+{
+  // rotate before line which would take file past max size (lines already in batch
+  // are written to current file)
+  if (file_.isFull(len + 1, buffer_.size())) {
+    if (! buffer_.empty()) {
+      file_.write(&buffer_[0], buffer_.size());
+
+      buffer_.clear();
+    }
+
+    file_.rotate();
+  }
+
+  buffer_.insert(buffer_.end(), str, str + len);
+
+  buffer_.push_back('\n');
+}
+
+void
+CQPerfLogger::
+writeEvent(const Event &event)
+{
+  std::string name;
+
+  {
+    std::unique_lock<std::mutex> lock(namesMutex_);
+
+    if (event.id < names_.size())
+      name = names_[event.id];
+  }
+
+  if (name.empty())
+    name = "trace " + std::to_string(event.id);
+
+  //---
+
+  // tag by thread as depth is per thread
+  std::string line = "[" + std::to_string(event.tid) + "] ";
+
+  if      (event.type == EventType::START) line += ">";
+  else if (event.type == EventType::END  ) line += "<";
+
+  line += std::string(event.depth, ' ') + name;
+
+  if (event.type != EventType::START) {
+    char buffer[32];
+
+    snprintf(buffer, sizeof(buffer), " %.6f", double(event.elapsed)/1000000.0);
+
+    line += buffer;
+  }
+
+  writeLine(line.c_str(), line.size());
+}
@@ -0,0 +1,291 @@
+#include <CQPerfMetricsServer.h>
+#include <CQPerfMonitor.h>
+#include <CQPerfSnapshot.h>
+
+#include <charconv>
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace {
+
+void appendLabel(std::string &text, const std::string &name) {
+  // escape label value
+  for (const auto &c : name) {
+    if      (c == '\\') text += "\\\\";
+    else if (c == '"' ) text += "\\\"";
+    else if (c == '\n') text += "\\n";
+    else                text += c;
+  }
+}
+
+void appendInt(std::string &text, int64_t i) {
+  char buffer[32];
+
+  auto res = std::to_chars(buffer, buffer + sizeof(buffer), i);
+
+  text.append(buffer, res.ptr);
+}
+
+void appendReal(std::string &text, double r) {
+  char buffer[32];
+
+  int len = snprintf(buffer, sizeof(buffer), "%.9g", r);
+
+  text.append(buffer, size_t(len));
+}
+
+bool sendAll(int fd, const char *data, size_t len) {
+  while (len > 0) {
+    auto n = ::send(fd, data, len, MSG_NOSIGNAL);
+
+    if (n <= 0)
+      return false;
+
+    data += n;
+    len  -= size_t(n);
+  }
+
+  return true;
+}
+
+}
+
+//---
+
+CQPerfMetricsServer::
+CQPerfMetricsServer()
+{
+}
+
+CQPerfMetricsServer::
+~CQPerfMetricsServer()
+{
+  stop();
+}
+
+bool
+CQPerfMetricsServer::
+start(int port, const std::string &address)
+{
+  stop();
+
+  fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+
+  if (fd_ < 0) {
+    std::cerr << "Failed to create metrics socket\n";
+    return false;
+  }
+
+  int on = 1;
+
+  setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+  struct sockaddr_in addr;
+
+  memset(&addr, 0, sizeof(addr));
+
+  addr.sin_family = AF_INET;
+  addr.sin_port   = htons(uint16_t(port));
+
+  if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1 ||
+      ::bind(fd_, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      ::listen(fd_, 16) != 0) {
+    std::cerr << "Failed to listen for metrics on " << address << ":" << port << "\n";
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+
+  // get bound port (if any port requested)
+  socklen_t len = sizeof(addr);
+
+  getsockname(fd_, reinterpret_cast<struct sockaddr *>(&addr), &len);
+
+  port_ = ntohs(addr.sin_port);
+
+  stop_ = false;
+
+  thread_ = std::thread(&CQPerfMetricsServer::run, this);
+
+  return true;
+}
+
+void
+CQPerfMetricsServer::
+stop()
+{
+  if (fd_ < 0)
+    return;
+
+  stop_ = true;
+
+  thread_.join();
+
+  ::close(fd_);
+
+  fd_   = -1;
+  port_ = 0;
+}
+
+void
+CQPerfMetricsServer::
+run()
+{
+  while (! stop_) {
+    // poll so stop is noticed
+    struct pollfd pfd;
+
+    pfd.fd      = fd_;
+    pfd.events  = POLLIN;
+    pfd.revents = 0;
+
+    if (poll(&pfd, 1, 200) <= 0)
+      continue;
+
+    int cfd = ::accept(fd_, nullptr, nullptr);
+
+    if (cfd < 0)
+      continue;
+
+    handleClient(cfd);
+
+    ::close(cfd);
+  }
+}
+
+void
+CQPerfMetricsServer::
+handleClient(int fd)
+{
+  // read request header (with timeout so slow client can't stall server)
+  std::string request;
+
+  while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+    struct pollfd pfd;
+
+    pfd.fd      = fd;
+    pfd.events  = POLLIN;
+    pfd.revents = 0;
+
+    if (poll(&pfd, 1, 1000) <= 0)
+      return;
+
+    char buffer[1024];
+
+    auto n = ::recv(fd, buffer, sizeof(buffer), 0);
+
+    if (n <= 0)
+      break;
+
+    request.append(buffer, size_t(n));
+  }
+
+  //---
+
+  auto pos = request.find("\r\n");
+
+  auto line = request.substr(0, pos);
+
+  std::string status = "200 OK", body;
+
+  if      (line.compare(0, 4, "GET ") != 0) {
+    status = "405 Method Not Allowed";
+  }
+  else if (line.compare(4, 9, "/metrics ") != 0 && line.compare(4, 9, "/metrics?") != 0) {
+    status = "404 Not Found";
+  }
+  else {
+    CQPerfSnapshot snapshot;
+
+    CQPerfMonitorInst->getSnapshot(snapshot);
+
+    renderMetrics(snapshot, body);
+  }
+
+  std::string header = "HTTP/1.1 " + status + "\r\n"
+    "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+    "Content-Length: " + std::to_string(body.size()) + "\r\n"
+    "Connection: close\r\n\r\n";
+
+  if (sendAll(fd, header.c_str(), header.size()))
+    sendAll(fd, body.c_str(), body.size());
+}
+
+void
+CQPerfMetricsServer::
+renderMetrics(const CQPerfSnapshot &snapshot, std::string &text)
+{
+  const auto &traces = snapshot.traces();
+
+  // ~24 histogram lines per trace
+  text.reserve(text.size() + traces.size()*2048);
+
+  text += "# HELP cqperf_calls_total Number of calls of trace.\n";
+  text += "# TYPE cqperf_calls_total counter\n";
+
+  for (const auto &trace : traces) {
+    text += "cqperf_calls_total{trace=\"";
+    appendLabel(text, trace.name);
+    text += "\"} ";
+    appendInt(text, trace.stats.count);
+    text += "\n";
+  }
+
+  //---
+
+  text += "# HELP cqperf_elapsed_seconds Elapsed time of trace calls.\n";
+  text += "# TYPE cqperf_elapsed_seconds histogram\n";
+
+  // histogram bucket i holds (whole usecs) elapsed below 2^i, i.e. at most 2^i - 1,
+  // which is its inclusive le bound (last is unbounded)
+  std::string le[CQPerfRollup::NUM_HIST];
+
+  for (int i = 0; i < CQPerfRollup::NUM_HIST; ++i) {
+    le[i] = "\",le=\"";
+
+    if (i < CQPerfRollup::NUM_HIST - 1)
+      appendReal(le[i], double((int64_t(1) << i) - 1)/1000000.0);
+    else
+      le[i] += "+Inf";
+
+    le[i] += "\"} ";
+  }
+
+  std::string label;
+
+  for (const auto &trace : traces) {
+    label = "{trace=\"";
+
+    appendLabel(label, trace.name);
+
+    uint64_t count = 0;
+
+    for (int i = 0; i < CQPerfRollup::NUM_HIST; ++i) {
+      count += trace.stats.hist[i];
+
+      text += "cqperf_elapsed_seconds_bucket";
+      text += label;
+      text += le[i];
+      appendInt(text, int64_t(count));
+      text += "\n";
+    }
+
+    text += "cqperf_elapsed_seconds_sum";
+    text += label;
+    text += "\"} ";
+    appendReal(text, double(trace.stats.sum)/1000000.0);
+    text += "\n";
+
+    text += "cqperf_elapsed_seconds_count";
+    text += label;
+    text += "\"} ";
+    appendInt(text, trace.stats.count);
+    text += "\n";
+  }
+}
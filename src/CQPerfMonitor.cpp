@@ -4,21 +4,207 @@
 #include <CMessage.h>
 #endif
 
+#include <CQPerfKernels.h>
+#include <CQPerfTimeCodec.h>
+#include <CQPerfRecordFile.h>
+#include <CQPerfRecordReader.h>
+#include <CQPerfFlightRecorder.h>
+#include <CQPerfAlertEngine.h>
+#include <CQPerfTraceEventWriter.h>
+#include <CQPerfCallTree.h>
+#include <CQPerfSnapshot.h>
+#include <CQPerfMetricsServer.h>
+#include <CQPerfStatsDEmitter.h>
+#include <CQPerfReporter.h>
+#include <CQPerfRegression.h>
 #include <CEnv.h>
 
 #include <QTimer>
 
+#include <cstdlib>
+#include <set>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// debug call stack of current thread
+struct DebugEntry {
+  uint    id      { 0 };     //!< trace id
+  int64_t start   { 0 };     //!< start (usecs)
+  bool    flushed { false }; //!< start shown
+
+  DebugEntry(uint id, int64_t start) : id(id), start(start) { }
+};
+
+using DebugStack = std::vector<DebugEntry>;
+
+DebugStack &threadDebugStack() {
+  static thread_local DebugStack stack;
+
+  return stack;
+}
+
+// trace call stack of current thread (for self time and depth). Start is kept per
+// call so concurrent calls of a shared trace don't use each other's start time
+struct TraceEntry {
+  uint    id    { 0 }; //!< trace id
+  CHRTime start;       //!< call start time
+  int64_t child { 0 }; //!< elapsed of nested traces (usecs)
+
+  TraceEntry(uint id, const CHRTime &start) : id(id), start(start) { }
+};
+
+using TraceStack = std::vector<TraceEntry>;
+
+TraceStack &threadTraceStack() {
+  static thread_local TraceStack stack;
+
+  return stack;
+}
+
+}
+
 CQPerfMonitor::
 CQPerfMonitor()
 {
   CEnvInst.get("CQ_PERF_MONITOR_ENABLED" , enabled_);
   CEnvInst.get("CQ_PERF_MONITOR_DEBUG"   , debug_  );
   CEnvInst.get("CQ_PERF_MONITOR_MIN_TIME", minTime_);
+
+  int rollupSize = int(rollupSize_);
+
+  CEnvInst.get("CQ_PERF_MONITOR_ROLLUP_SIZE", rollupSize);
+
+  rollupSize_ = uint(std::max(rollupSize, 0));
+
+  std::string enablePattern = "*", debugPattern = "*";
+
+  CEnvInst.get("CQ_PERF_MONITOR_ENABLE_PATTERN", enablePattern);
+  CEnvInst.get("CQ_PERF_MONITOR_DEBUG_PATTERN" , debugPattern );
+
+  // empty (set but blank) pattern matches all
+  if (enablePattern.empty()) enablePattern = "*";
+  if (debugPattern .empty()) debugPattern  = "*";
+
+  enablePattern_.setPatterns(enablePattern);
+  debugPattern_ .setPatterns(debugPattern );
+
+  alertEngine_ = new CQPerfAlertEngine;
+
+  //---
+
+  logger_ = new CQPerfLogger;
+
+  std::string logFilename;
+
+  CEnvInst.get("CQ_PERF_MONITOR_LOG_FILE", logFilename);
+
+  if (! logFilename.empty()) {
+    int logSize  = 0;
+    int logFiles = 4;
+
+    CEnvInst.get("CQ_PERF_MONITOR_LOG_SIZE" , logSize );
+    CEnvInst.get("CQ_PERF_MONITOR_LOG_FILES", logFiles);
+
+    logger_->setFile(logFilename, size_t(std::max(logSize, 0)), uint(std::max(logFiles, 1)));
+  }
+
+  //---
+
+  std::string flightFilename;
+
+  CEnvInst.get("CQ_PERF_MONITOR_FLIGHT_RECORDER", flightFilename);
+
+  if (! flightFilename.empty()) {
+    int  flightSize = 65536;
+    bool flightKeep = false;
+
+    CEnvInst.get("CQ_PERF_MONITOR_FLIGHT_RECORDER_SIZE", flightSize);
+    CEnvInst.get("CQ_PERF_MONITOR_FLIGHT_RECORDER_KEEP", flightKeep);
+
+    // "1" uses default file name
+    if (flightFilename == "1")
+      flightFilename.clear();
+
+    startFlightRecorder(QString::fromStdString(flightFilename), uint(std::max(flightSize, 1)),
+                        flightKeep);
+  }
+
+  //---
+
+  int metricsPort = -1;
+
+  CEnvInst.get("CQ_PERF_MONITOR_METRICS_PORT", metricsPort);
+
+  if (metricsPort >= 0) {
+    std::string metricsAddress = "127.0.0.1";
+
+    CEnvInst.get("CQ_PERF_MONITOR_METRICS_ADDRESS", metricsAddress);
+
+    startMetricsServer(metricsPort, QString::fromStdString(metricsAddress));
+  }
+
+  //---
+
+  std::string statsD;
+
+  CEnvInst.get("CQ_PERF_MONITOR_STATSD", statsD);
+
+  if (! statsD.empty()) {
+    std::string statsDHost   = "127.0.0.1";
+    int         statsDPort   = 8125;
+    int         statsDTime   = 10000;
+    std::string statsDPrefix = "cqperf.";
+
+    // "1" uses default host and port, otherwise host[:port]
+    if (statsD != "1") {
+      auto pos = statsD.rfind(':');
+
+      statsDHost = statsD.substr(0, pos);
+
+      if (pos != std::string::npos)
+        statsDPort = std::atoi(statsD.substr(pos + 1).c_str());
+    }
+
+    CEnvInst.get("CQ_PERF_MONITOR_STATSD_INTERVAL", statsDTime);
+    CEnvInst.get("CQ_PERF_MONITOR_STATSD_PREFIX"  , statsDPrefix);
+
+    startStatsD(QString::fromStdString(statsDHost), statsDPort, statsDTime,
+                QString::fromStdString(statsDPrefix));
+  }
+
+  //---
+
+  std::string reportFilename;
+
+  CEnvInst.get("CQ_PERF_MONITOR_REPORT_FILE", reportFilename);
+
+  if (! reportFilename.empty()) {
+    int reportTime  = 10000;
+    int reportSize  = 0;
+    int reportFiles = 4;
+
+    CEnvInst.get("CQ_PERF_MONITOR_REPORT_INTERVAL", reportTime );
+    CEnvInst.get("CQ_PERF_MONITOR_REPORT_SIZE"    , reportSize );
+    CEnvInst.get("CQ_PERF_MONITOR_REPORT_FILES"   , reportFiles);
+
+    startReporter(QString::fromStdString(reportFilename), reportTime,
+                  size_t(std::max(reportSize, 0)), uint(std::max(reportFiles, 1)));
+  }
 }
 
 CQPerfMonitor::
 ~CQPerfMonitor()
 {
+  // server/emitter threads read monitor so stop first
+  delete metricsServer_;
+  delete statsDEmitter_;
+  delete reporter_;
+  delete alertEngine_;
+  delete flightRecorder_;
+  delete logger_;
+
 #ifdef CQPERF_MESSAGE
   delete message_;
 #endif
@@ -123,6 +309,32 @@ clientSlot()
 
 //---
 
+void
+CQPerfMonitor::
+setEnablePattern(const QString &pattern)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  enablePattern_.setPatterns(pattern.toStdString());
+
+  for (auto &nt : traces_)
+    nt.second->setEnabled(enablePattern_.match(nt.first.toStdString()));
+}
+
+void
+CQPerfMonitor::
+setDebugPattern(const QString &pattern)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  debugPattern_.setPatterns(pattern.toStdString());
+
+  for (auto &nt : traces_)
+    nt.second->setDebug(debugPattern_.match(nt.first.toStdString()));
+}
+
+//---
+
 void
 CQPerfMonitor::
 startTrace(const QString &name, TraceType)
@@ -135,11 +347,16 @@ startTrace(const QString &name, TraceType)
   auto *data = getTrace(name);
 
   if (data->isEnabled()) {
-    std::unique_lock<std::mutex> lock(mutex_);
+    auto &stack = threadTraceStack();
 
-    ++numTrace_;
+    stack.push_back(TraceEntry(data->id(), getTime()));
 
-    data->startTrace(numTrace_);
+    // depth is number of active traces of this thread
+    uint depth = uint(stack.size());
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    data->startTrace(stack.back().start, depth);
   }
 }
 
@@ -154,12 +371,68 @@ endTrace(const QString &name, TraceType traceType)
 
   auto *data = getTrace(name);
 
-  if (data->isEnabled()) {
-    std::unique_lock<std::mutex> lock(mutex_);
+  auto &stack = threadTraceStack();
+
+  // find matching start on this thread (discarding unmatched inner starts). Always
+  // popped so a trace disabled while active doesn't leave a stale entry
+  size_t n = stack.size();
+
+  while (n > 0 && stack[n - 1].id != data->id())
+    --n;
+
+  if (n > 0) {
+    stack.erase(stack.begin() + long(n), stack.end());
+
+    TraceEntry entry = stack.back();
+
+    stack.pop_back();
+
+    if (! data->isEnabled())
+      return;
+
+    // time in nested traces is excluded from self time
+    TimeData timeData;
+
+    timeData.depth   = uint(n);
+    timeData.tid     = CQPerfRecordFile::currentThreadId();
+    timeData.start   = entry.start;
+    timeData.elapsed = CHRTime::diffTime(entry.start, getTime());
+
+    CQPerfFlightRecorder *flightRecorder = nullptr;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      data->endTrace(timeData, traceType, entry.child);
+
+      flightRecorder = useFlightRecorder();
+    }
+
+    // flight recorder ring is lock-free so written after unlock
+    if (flightRecorder)
+      addFlightSpan(flightRecorder, data, timeData);
+
+    if (! stack.empty())
+      stack.back().child += TimeData::timeToTicks(timeData.elapsed);
+  }
+  else if (data->isEnabled()) {
+    // unmatched end uses trace's last start
+    TimeData timeData;
+
+    CQPerfFlightRecorder *flightRecorder = nullptr;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      data->endTrace(traceType);
 
-    data->endTrace(traceType);
+      timeData = data->lastTimeData();
 
-    --numTrace_;
+      flightRecorder = useFlightRecorder();
+    }
+
+    if (flightRecorder)
+      addFlightSpan(flightRecorder, data, timeData);
   }
 }
 
@@ -170,11 +443,24 @@ addTrace(const QString &name, const TimeData &timeData, TraceType traceType)
   auto *data = getTrace(name);
 
   if (data->isEnabled()) {
-    std::unique_lock<std::mutex> lock(mutex_);
+    // added span is on calling thread unless thread specified
+    TimeData timeData1 = timeData;
+
+    if (timeData1.tid == 0)
+      timeData1.tid = CQPerfRecordFile::currentThreadId();
 
-    data->addTrace(timeData, traceType);
+    CQPerfFlightRecorder *flightRecorder = nullptr;
 
-    --numTrace_;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      data->addTrace(timeData1, traceType);
+
+      flightRecorder = useFlightRecorder();
+    }
+
+    if (flightRecorder)
+      addFlightSpan(flightRecorder, data, timeData1);
   }
 }
 
@@ -185,20 +471,18 @@ startDebug(const QString &name)
   auto *data = getTrace(name);
 
   if (data->isDebug()) {
-    std::unique_lock<std::mutex> lock(mutex_);
+    auto &stack = threadDebugStack();
 
-    ++numDebug_;
+    DebugEntry entry(data->id(), TimeData::timeToTicks(getTime()));
 
-    if (minTime() > 0) {
-      names_.emplace_back(name);
-    }
-    else {
-      auto msg = QString(">%1%2").arg(" ", int(numDebug_)).arg(name);
+    // show start now unless buffered until call chain is known to be slow
+    if (minTime() <= 0) {
+      logDebug(CQPerfLogger::EventType::START, entry.id, uint(stack.size() + 1), entry.start);
 
-      log(msg);
+      entry.flushed = true;
     }
 
-    data->startDebug();
+    stack.push_back(entry);
   }
 }
 
@@ -209,61 +493,51 @@ endDebug(const QString &name)
   auto *data = getTrace(name);
 
   if (data->isDebug()) {
-    std::unique_lock<std::mutex> lock(mutex_);
+    int64_t end = TimeData::timeToTicks(getTime());
 
-    data->endDebug();
+    auto &stack = threadDebugStack();
 
-    const auto &e = data->elapsedTime();
+    // find matching start on this thread (discarding unmatched inner starts)
+    size_t n = stack.size();
 
-    if (minTime() > 0) {
-      // if longer than elapsed flush stack
-      if (e.getMSecs() >= minTime()) {
-        uint n  = uint(names_.size());
-        uint nd = numDebug_ - n + 1;
+    while (n > 0 && stack[n - 1].id != data->id())
+      --n;
 
-        // show unflushed start names
-        for (uint i = 0; i < n; ++i) {
-          auto &nameData = names_[i];
+    if (n == 0)
+      return;
 
-          if (! nameData.flushed) {
-            auto smsg = QString(">%1%2").arg(" ", int(nd)).arg(nameData.name);
+    stack.erase(stack.begin() + long(n), stack.end());
 
-            log(smsg);
+    const auto &entry = stack.back();
 
-            nameData.flushed = true;
-          }
+    TimeData timeData;
 
-          ++nd;
-        }
+    timeData.start   = TimeData::ticksToTime(entry.start);
+    timeData.elapsed = TimeData::ticksToTime(end - entry.start);
+    timeData.depth   = uint(n);
 
-        --nd;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
 
-        // show end name
-        if (n > 0) {
-          const auto &nameData = names_[n - 1];
+      data->addDebug(timeData);
+    }
 
-          auto emsg = QString("<%1%2 %3").arg(" ", int(nd)).
-                        arg(nameData.name).arg(e.getSecs(), 0, 'f', 6);
+    // if longer than min time flush enclosing call chain and show end
+    if (minTime() <= 0 || timeData.elapsed.getMSecs() >= minTime()) {
+      for (size_t i = 0; i < n; ++i) {
+        auto &entry1 = stack[i];
 
-          log(emsg);
+        if (! entry1.flushed) {
+          logDebug(CQPerfLogger::EventType::START, entry1.id, uint(i + 1), entry1.start);
 
-          names_.pop_back();
+          entry1.flushed = true;
         }
       }
-      // skip if less than elapsed
-      else {
-        if (! names_.empty())
-          names_.pop_back();
-      }
-    }
-    else {
-      auto msg = QString("<%1%2 %3").arg(" ", int(numDebug_)).
-                   arg(name).arg(e.getSecs(), 0, 'f', 6);
 
-      log(msg);
+      logDebug(CQPerfLogger::EventType::END, entry.id, uint(n), entry.start, end - entry.start);
     }
 
-    --numDebug_;
+    stack.pop_back();
   }
 }
 
@@ -274,16 +548,14 @@ addDebug(const QString &name, const TimeData &timeData)
   auto *data = getTrace(name);
 
   if (data->isDebug()) {
-    std::unique_lock<std::mutex> lock(mutex_);
-
-    data->addDebug(timeData);
-
-    const CHRTime &e = timeData.elapsed;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
 
-    auto msg = QString("%1%2 %3").arg(" ", int(numDebug_)).
-                 arg(name).arg(e.getSecs(), 0, 'f', 6);
+      data->addDebug(timeData);
+    }
 
-    log(msg);
+    logDebug(CQPerfLogger::EventType::SPAN, data->id(), uint(threadDebugStack().size()),
+             TimeData::timeToTicks(timeData.start), TimeData::timeToTicks(timeData.elapsed));
   }
 }
 
@@ -304,10 +576,12 @@ resetStartsWith(const QString &name)
 {
   std::unique_lock<std::mutex> lock(mutex_);
 
-  for (auto &nt : traces_) {
-    if (nt.second->name().startsWith(name))
-      nt.second->reset();
-  }
+  CQPerfNameIndex::Traces traces;
+
+  nameIndex_.getTraces(name.toStdString(), traces);
+
+  for (auto *trace : traces)
+    trace->reset();
 }
 
 void
@@ -322,10 +596,36 @@ resetAll()
 
 void
 CQPerfMonitor::
-startRecording()
+startRecording(const QString &filename)
 {
   std::unique_lock<std::mutex> lock(mutex_);
 
+  std::string recordFilename = filename.toStdString();
+
+  if (recordFilename.empty())
+    CEnvInst.get("CQ_PERF_MONITOR_RECORD_FILE", recordFilename);
+
+  // in-memory records are released by restart so wait for exports reading them
+  recordCond_.wait(lock, [&]() { return recordReaders_ == 0; });
+
+  delete recordFile_;
+
+  recordFile_ = nullptr;
+
+  recordFilename_.clear();
+
+  if (! recordFilename.empty()) {
+    recordFile_ = new CQPerfRecordFile;
+
+    if (recordFile_->open(recordFilename))
+      recordFilename_ = recordFilename;
+    else {
+      delete recordFile_;
+
+      recordFile_ = nullptr;
+    }
+  }
+
   recording_ = true;
 
   for (auto &nt : traces_)
@@ -342,205 +642,1056 @@ stopRecording()
     nt.second->stopRecording();
 
   recording_ = false;
+
+  delete recordFile_;
+
+  recordFile_ = nullptr;
 }
 
 bool
 CQPerfMonitor::
-isTraceEnabled(const QString &name) const
+startFlightRecorder(const QString &filename, uint capacity, bool keepFile)
 {
-  auto *data = const_cast<CQPerfMonitor *>(this)->getTrace(name);
+  // close old recorder first as it may remove the (same) file on close
+  setFlightRecorder(nullptr);
 
-  return data->isEnabled();
-}
+  auto *flightRecorder = new CQPerfFlightRecorder;
 
-void
-CQPerfMonitor::
-setTraceEnabled(const QString &name, bool enabled)
-{
-  auto *data = getTrace(name);
+  if (! flightRecorder->open(filename.toStdString(), capacity, keepFile)) {
+    delete flightRecorder;
 
-  std::unique_lock<std::mutex> lock(mutex_);
+    return false;
+  }
 
-  data->setEnabled(enabled);
+  setFlightRecorder(flightRecorder);
+
+  return true;
 }
 
-bool
+void
 CQPerfMonitor::
-isTraceDebug(const QString &name) const
+stopFlightRecorder()
 {
-  auto *data = const_cast<CQPerfMonitor *>(this)->getTrace(name);
-
-  return data->isDebug();
+  setFlightRecorder(nullptr);
 }
 
 void
 CQPerfMonitor::
-setTraceDebug(const QString &name, bool debug)
+setFlightRecorder(CQPerfFlightRecorder *flightRecorder)
 {
-  auto *data = getTrace(name);
+  CQPerfFlightRecorder *oldFlightRecorder = nullptr;
 
-  std::unique_lock<std::mutex> lock(mutex_);
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
 
-  data->setDebug(debug);
-}
+    oldFlightRecorder = flightRecorder_;
 
-void
-CQPerfMonitor::
-setTraceMaxTime(const QString &name, const CHRTime &t)
-{
-  auto *data = getTrace(name);
+    flightRecorder_ = flightRecorder;
+  }
 
-  std::unique_lock<std::mutex> lock(mutex_);
+  if (! oldFlightRecorder)
+    return;
 
-  data->setMaxTime(t);
+  // no new users once replaced so wait for spans being written
+  while (oldFlightRecorder->hasUsers())
+    std::this_thread::yield();
+
+  delete oldFlightRecorder;
 }
 
-void
+CQPerfFlightRecorder *
 CQPerfMonitor::
-setTraceMaxCalls(const QString &name, int n)
+useFlightRecorder()
 {
-  auto *data = getTrace(name);
+  if (flightRecorder_)
+    flightRecorder_->addUser();
 
-  std::unique_lock<std::mutex> lock(mutex_);
-
-  data->setMaxCalls(n);
+  return flightRecorder_;
 }
 
 void
 CQPerfMonitor::
-reportStats(const QString &name) const
+addFlightSpan(CQPerfFlightRecorder *flightRecorder, const CQPerfTraceData *data,
+              const TimeData &timeData)
 {
-  auto *data = const_cast<CQPerfMonitor *>(this)->getTrace(name);
+  if (! flightRecorder->isTraceDefined(data->id()))
+    flightRecorder->defineTrace(data->id(), data->utf8Name());
 
-  data->reportStats();
+  flightRecorder->addSpan(data->id(), TimeData::timeToTicks(timeData.start),
+                          TimeData::timeToTicks(timeData.elapsed), timeData.depth);
+
+  flightRecorder->removeUser();
 }
 
-void
+bool
 CQPerfMonitor::
-getTraceNames(QStringList &names) const
+startMetricsServer(int port, const QString &address)
 {
-  std::unique_lock<std::mutex> lock(mutex_);
+  stopMetricsServer();
 
-  for (auto &nt : traces_)
-    names.push_back(nt.second->name());
+  metricsServer_ = new CQPerfMetricsServer;
+
+  if (! metricsServer_->start(port, address.toStdString())) {
+    delete metricsServer_;
+
+    metricsServer_ = nullptr;
+
+    return false;
+  }
+
+  return true;
 }
 
 void
 CQPerfMonitor::
-getTracesStartingWith(const QString &name, TraceList &traces)
+stopMetricsServer()
 {
-  std::unique_lock<std::mutex> lock(mutex_);
+  delete metricsServer_;
 
-  for (auto &nt : traces_) {
-    if (nt.second->name().startsWith(name))
-      traces.push_back(nt.second);
-  }
+  metricsServer_ = nullptr;
 }
 
-CQPerfTraceData *
+bool
 CQPerfMonitor::
-getTrace(const QString &name)
+startStatsD(const QString &host, int port, int interval, const QString &prefix)
 {
-  bool added = false;
-
-  Traces::iterator p = traces_.find(name);
-
-  if (p == traces_.end()) {
-    std::unique_lock<std::mutex> lock(mutex_);
+  stopStatsD();
 
-    auto *traceData = new CQPerfTraceData(name);
+  statsDEmitter_ = new CQPerfStatsDEmitter;
 
-    p = traces_.insert(p, Traces::value_type(name, traceData));
+  if (! statsDEmitter_->open(host.toStdString(), port)) {
+    delete statsDEmitter_;
 
-    if (recording_)
-      traceData->startRecording();
+    statsDEmitter_ = nullptr;
 
-    added = true;
+    return false;
   }
 
-  if (added)
-    emit traceAdded(name);
+  statsDEmitter_->setPrefix  (prefix.toStdString());
+  statsDEmitter_->setInterval(int64_t(interval)*1000);
 
-  return (*p).second;
+  statsDEmitter_->start();
+
+  return true;
 }
 
 void
 CQPerfMonitor::
-alert(const CQPerfTraceData *trace, CQPerfMonitor::AlertType type)
+stopStatsD()
 {
-  // TODO: customize behavior
-  std::cerr << "Alert: " << trace->name().toStdString();
-  if      (type == AlertType::CALLS) std::cerr << " (Calls)";
-  else if (type == AlertType::TIME ) std::cerr << " (Time)";
-  std::cerr << "\n";
+  delete statsDEmitter_;
 
-  assert(false);
+  statsDEmitter_ = nullptr;
 }
 
-void
+bool
 CQPerfMonitor::
-log(const QString &msg) const
+startReporter(const QString &filename, int interval, size_t maxSize, uint maxFiles)
 {
-  // TODO: log file
-  std::cerr << msg.toStdString() << "\n";
-}
+  stopReporter();
 
-//---
+  auto format = (filename.endsWith(".csv", Qt::CaseInsensitive) ?
+                 CQPerfReporter::Format::CSV : CQPerfReporter::Format::JSONL);
 
-CQPerfTraceData::
-CQPerfTraceData(const QString &name) :
- name_(name)
-{
-  std::string pattern;
+  reporter_ = new CQPerfReporter;
 
-  CEnvInst.get("CQ_PERF_MONITOR_DEBUG_PATTERN", pattern);
+  if (! reporter_->setFile(filename.toStdString(), format, maxSize, maxFiles)) {
+    delete reporter_;
 
-  if (pattern.empty())
-    pattern = "*";
+    reporter_ = nullptr;
 
-  auto patterns = QString(pattern.c_str()).split("|", Qt::SkipEmptyParts);
+    return false;
+  }
 
-  for (int i = 0; i < patterns.length(); ++i) {
-    QRegExp regexp(patterns[i], Qt::CaseSensitive, QRegExp::WildcardUnix);
+  reporter_->setInterval(int64_t(interval)*1000);
 
-    if (regexp.exactMatch(name)) {
-      debug_ = true;
-      break;
-    }
-  }
-}
+  reporter_->start();
 
-//---
+  return true;
+}
 
 void
-CQPerfTraceData::
-startTrace(uint depth)
+CQPerfMonitor::
+stopReporter()
 {
-  timeData_.depth = depth;
-  timeData_.start = CHRTime::getTime();
+  delete reporter_;
+
+  reporter_ = nullptr;
 }
 
-void
-CQPerfTraceData::
-endTrace(TraceType traceType)
+bool
+CQPerfMonitor::
+openRecordReader(CQPerfRecordReader &reader) const
 {
-  // calc elapsed time
-  CHRTime endTime = CHRTime::getTime();
+  std::unique_lock<std::mutex> lock(mutex_);
 
-  timeData_.elapsed = CHRTime::diffTime(timeData_.start, endTime);
+  if (recordFilename_.empty())
+    return false;
 
-  addTrace(timeData_, traceType);
+  // write pending thread blocks of active recording so reader sees all spans
+  if (recordFile_)
+    recordFile_->flush();
+
+  return reader.open(recordFilename_);
 }
 
-void
+bool
+CQPerfMonitor::
+exportRecording(const QString &filename) const
+{
+  CQPerfRecordReader reader;
+
+  if (openRecordReader(reader))
+    return reader.exportTraceEvents(filename.toStdString());
+
+  //---
+
+  CQPerfTraceEventWriter writer;
+
+  if (! writer.open(filename.toStdString()))
+    return false;
+
+  uint32_t pid = uint32_t(getpid());
+
+  writer.setProcessName(pid, "CQPerfMonitor");
+
+  // copy chunk list of each trace under lock and decode records straight into writer
+  // unlocked so traced threads are not blocked by the file output (records are
+  // appended after copied chunk lengths and restart waits until export is done)
+  struct TraceRange {
+    std::string             name;  //!< trace name
+    CQPerfTimeStream::Range range; //!< recorded chunks
+  };
+
+  std::vector<TraceRange> ranges;
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    for (const auto &nt : traces_) {
+      const auto *trace = nt.second;
+
+      if (! trace->recordTimes().empty())
+        ranges.push_back(TraceRange { trace->utf8Name(), trace->recordTimes().range() });
+    }
+
+    ++recordReaders_;
+  }
+
+  std::set<uint32_t> tids;
+
+  for (const auto &traceRange : ranges) {
+    for (const auto &timeData : traceRange.range) {
+      if (tids.insert(timeData.tid).second)
+        writer.setThreadName(pid, timeData.tid, "thread " + std::to_string(timeData.tid));
+
+      writer.addComplete(traceRange.name, pid, timeData.tid,
+                         CQPerfTimeData::timeToTicks(timeData.start),
+                         CQPerfTimeData::timeToTicks(timeData.elapsed), timeData.depth);
+    }
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    --recordReaders_;
+  }
+
+  recordCond_.notify_all();
+
+  return writer.close();
+}
+
+void
+CQPerfMonitor::
+getCallTree(CQPerfCallTree &tree) const
+{
+  CQPerfRecordReader reader;
+
+  if (openRecordReader(reader)) {
+    reader.getCallTree(tree);
+    return;
+  }
+
+  //---
+
+  tree.clear();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  // spans are nested per thread
+  for (const auto &nt : traces_) {
+    const auto *trace = nt.second;
+
+    tree.setName(trace->id(), trace->utf8Name());
+
+    for (const auto &timeData : trace->recordTimes())
+      tree.addSpan(trace->id(), timeData.tid, CQPerfTimeData::timeToTicks(timeData.start),
+                   CQPerfTimeData::timeToTicks(timeData.elapsed), timeData.depth);
+  }
+
+  lock.unlock();
+
+  tree.build();
+}
+
+bool
+CQPerfMonitor::
+exportFoldedStacks(const QString &filename) const
+{
+  CQPerfCallTree tree;
+
+  getCallTree(tree);
+
+  return tree.writeFolded(filename.toStdString());
+}
+
+bool
+CQPerfMonitor::
+isTraceEnabled(const QString &name) const
+{
+  auto *data = const_cast<CQPerfMonitor *>(this)->getTrace(name);
+
+  return data->isEnabled();
+}
+
+void
+CQPerfMonitor::
+setTraceEnabled(const QString &name, bool enabled)
+{
+  auto *data = getTrace(name);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  data->setEnabled(enabled);
+}
+
+bool
+CQPerfMonitor::
+isTraceDebug(const QString &name) const
+{
+  auto *data = const_cast<CQPerfMonitor *>(this)->getTrace(name);
+
+  return data->isDebug();
+}
+
+void
+CQPerfMonitor::
+setTraceDebug(const QString &name, bool debug)
+{
+  auto *data = getTrace(name);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  data->setDebug(debug);
+}
+
+void
+CQPerfMonitor::
+setTraceMaxTime(const QString &name, const CHRTime &t)
+{
+  auto *data = getTrace(name);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  data->setMaxTime(t);
+}
+
+void
+CQPerfMonitor::
+setTraceMaxCalls(const QString &name, int n)
+{
+  auto *data = getTrace(name);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  data->setMaxCalls(n);
+}
+
+void
+CQPerfMonitor::
+reportStats(const QString &name) const
+{
+  auto *data = const_cast<CQPerfMonitor *>(this)->getTrace(name);
+
+  data->reportStats();
+}
+
+void
+CQPerfMonitor::
+getTraceNames(QStringList &names) const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  for (auto &nt : traces_)
+    names.push_back(nt.second->name());
+}
+
+void
+CQPerfMonitor::
+getTracesStartingWith(const QString &name, TraceList &traces)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  nameIndex_.getTraces(name.toStdString(), traces);
+}
+
+void
+CQPerfMonitor::
+getSnapshot(CQPerfSnapshot &snapshot) const
+{
+  int64_t time = TimeData::timeToTicks(getTime());
+
+  // all stats are published under the monitor lock with the stats epoch odd while
+  // publishing. Only trace pointers (traces are never deleted) and the epoch are read
+  // under the lock so scrapes and report ticks don't block trace updates, and an
+  // unchanged epoch after reading the stats means no trace changed in between.
+  // Retry a few times then read under the lock if publishes keep overlapping the reads
+  TraceList traces;
+
+  for (int i = 0; i < 4; ++i) {
+    uint64_t epoch = 0;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      getTraces(traces);
+
+      epoch = statsEpoch_.load(std::memory_order_relaxed);
+    }
+
+    getSnapshot(traces, time, snapshot);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (statsEpoch_.load(std::memory_order_relaxed) == epoch)
+      return;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  getTraces(traces);
+
+  getSnapshot(traces, time, snapshot);
+}
+
+void
+CQPerfMonitor::
+getTraces(TraceList &traces) const
+{
+  traces.clear();
+
+  traces.reserve(traces_.size());
+
+  for (const auto &nt : traces_)
+    traces.push_back(nt.second);
+}
+
+void
+CQPerfMonitor::
+getSnapshot(const TraceList &traces, int64_t time, CQPerfSnapshot &snapshot)
+{
+  snapshot = CQPerfSnapshot();
+
+  snapshot.setTime(time);
+
+  CQPerfTraceStats::Totals totals;
+
+  for (const auto *data : traces) {
+    CQPerfSnapshot::Trace trace;
+
+    data->getTotals(totals);
+
+    trace.name       = data->utf8Name();
+    trace.id         = data->id();
+    trace.generation = totals.generation;
+    trace.stats      = totals.stats;
+    trace.self       = totals.self;
+
+    snapshot.addTrace(trace);
+  }
+
+  snapshot.sortTraces();
+}
+
+bool
+CQPerfMonitor::
+saveBaseline(const QString &filename) const
+{
+  CQPerfSnapshot snapshot;
+
+  getSnapshot(snapshot);
+
+  return snapshot.save(filename.toStdString());
+}
+
+int
+CQPerfMonitor::
+compareBaseline(const QString &filename, std::ostream &os) const
+{
+  CQPerfSnapshot baseline;
+
+  if (! baseline.load(filename.toStdString()))
+    return -1;
+
+  CQPerfSnapshot snapshot;
+
+  getSnapshot(snapshot);
+
+  CQPerfRegression regression;
+
+  int n = regression.compare(baseline, snapshot);
+
+  regression.report(os);
+
+  return n;
+}
+
+bool
+CQPerfMonitor::
+getPrefixStats(const QString &prefix, int64_t &calls, CHRTime &elapsed) const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  const auto *node = nameIndex_.findNode(prefix.toStdString());
+
+  if (! node)
+    return false;
+
+  calls   = node->calls;
+  elapsed = TimeData::ticksToTime(node->elapsed);
+
+  return true;
+}
+
+CQPerfTraceData *
+CQPerfMonitor::
+getTrace(const QString &name)
+{
+  bool added = false;
+
+  Traces::iterator p = traces_.find(name);
+
+  if (p == traces_.end()) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto *traceData = new CQPerfTraceData(name, uint(traces_.size()));
+
+    auto name1 = name.toStdString();
+
+    traceData->setEnabled(enablePattern_.match(name1));
+    traceData->setDebug  (debugPattern_ .match(name1));
+
+    logger_->defineName(traceData->id(), name1);
+
+    traceData->setIndexNode(nameIndex_.add(name1, traceData));
+
+    p = traces_.insert(p, Traces::value_type(name, traceData));
+
+    if (recording_)
+      traceData->startRecording();
+
+    added = true;
+  }
+
+  if (added)
+    emit traceAdded(name);
+
+  return (*p).second;
+}
+
+bool
+CQPerfMonitor::
+traceRollupBucket(const QString &name, int64_t t1, int64_t t2, int64_t resolution,
+                  CQPerfRollup::Bucket &bucket) const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  auto p = traces_.find(name);
+
+  if (p == traces_.end())
+    return false;
+
+  return ((*p).second->rollupBucket(t1, t2, resolution, bucket) != nullptr);
+}
+
+void
+CQPerfMonitor::
+alert(const CQPerfTraceData *trace, CQPerfMonitor::AlertType type)
+{
+  // called on hot path (with monitor locked) so queue for alert thread
+  CQPerfAlertEngine::Alert alert;
+
+  alert.trace = trace->name().toStdString();
+
+  if      (type == AlertType::CALLS) {
+    alert.rule      = "Calls";
+    alert.value     = trace->numCalls();
+    alert.threshold = trace->maxCalls();
+  }
+  else if (type == AlertType::TIME) {
+    alert.rule      = "Time";
+    alert.value     = TimeData::timeToTicks(trace->elapsedMax());
+    alert.threshold = TimeData::timeToTicks(trace->maxTime());
+  }
+
+  alertEngine_->postAlert(alert);
+}
+
+bool
+CQPerfMonitor::
+setLogFile(const QString &filename, size_t maxSize, uint maxFiles)
+{
+  return logger_->setFile(filename.toStdString(), maxSize, maxFiles);
+}
+
+void
+CQPerfMonitor::
+log(const QString &msg) const
+{
+  // queue only (called with monitor locked)
+  auto ba = msg.toUtf8();
+
+  logger_->log(ba.constData(), size_t(ba.size()));
+}
+
+void
+CQPerfMonitor::
+logDebug(CQPerfLogger::EventType type, uint id, uint depth, int64_t start, int64_t elapsed) const
+{
+  CQPerfLogger::Event event;
+
+  event.type    = type;
+  event.id      = id;
+  event.depth   = depth;
+  event.time    = start;
+  event.elapsed = elapsed;
+  event.tid     = CQPerfRecordFile::currentThreadId();
+
+  logger_->logEvent(event);
+}
+
+//---
+
+void
+CQPerfTimeColumns::
+clear()
+{
+  starts_  .clear();
+  elapseds_.clear();
+  depths_  .clear();
+
+  wideElapseds_.clear();
+  wideDepths_  .clear();
+}
+
+void
+CQPerfTimeColumns::
+reserve(uint n)
+{
+  starts_  .reserve(n);
+  elapseds_.reserve(n);
+  depths_  .reserve(n);
+}
+
+void
+CQPerfTimeColumns::
+push_back(const TimeData &timeData)
+{
+  uint i = size();
+
+  starts_  .push_back(TimeData::timeToTicks(timeData.start));
+  elapseds_.push_back(0);
+  depths_  .push_back(0);
+
+  setElapsed(i, TimeData::timeToTicks(timeData.elapsed));
+  setDepth  (i, timeData.depth);
+}
+
+CQPerfTimeData
+CQPerfTimeColumns::
+timeData(uint i) const
+{
+  assert(i < size());
+
+  TimeData timeData;
+
+  timeData.depth   = depth(i);
+  timeData.start   = TimeData::ticksToTime(starts_[i]);
+  timeData.elapsed = TimeData::ticksToTime(elapsed(i));
+
+  return timeData;
+}
+
+void
+CQPerfTimeColumns::
+setTimeData(uint i, const TimeData &timeData)
+{
+  assert(i < size());
+
+  starts_[i] = TimeData::timeToTicks(timeData.start);
+
+  setElapsed(i, TimeData::timeToTicks(timeData.elapsed));
+  setDepth  (i, timeData.depth);
+}
+
+int64_t
+CQPerfTimeColumns::
+elapsed(uint i) const
+{
+  if (elapseds_[i] != ELAPSED_ESCAPE)
+    return elapseds_[i];
+
+  auto p = wideElapseds_.find(i);
+  assert(p != wideElapseds_.end());
+
+  return (*p).second;
+}
+
+uint
+CQPerfTimeColumns::
+depth(uint i) const
+{
+  if (depths_[i] != DEPTH_ESCAPE)
+    return depths_[i];
+
+  auto p = wideDepths_.find(i);
+  assert(p != wideDepths_.end());
+
+  return (*p).second;
+}
+
+void
+CQPerfTimeColumns::
+setElapsed(uint i, int64_t elapsed)
+{
+  if (elapseds_[i] == ELAPSED_ESCAPE)
+    wideElapseds_.erase(i);
+
+  if (elapsed >= 0 && elapsed < int64_t(ELAPSED_ESCAPE))
+    elapseds_[i] = uint32_t(elapsed);
+  else {
+    elapseds_[i] = ELAPSED_ESCAPE;
+
+    wideElapseds_[i] = elapsed;
+  }
+}
+
+void
+CQPerfTimeColumns::
+setDepth(uint i, uint depth)
+{
+  if (depths_[i] == DEPTH_ESCAPE)
+    wideDepths_.erase(i);
+
+  if (depth < DEPTH_ESCAPE)
+    depths_[i] = uint8_t(depth);
+  else {
+    depths_[i] = DEPTH_ESCAPE;
+
+    wideDepths_[i] = depth;
+  }
+}
+
+void
+CQPerfTimeColumns::
+rangeStats(int64_t t1, int64_t t2, RangeStats &stats) const
+{
+  RangeStats stats1;
+
+  CQPerfKernels::rangeStats(starts(), elapseds(), size(), t1, t2, stats1);
+
+  // kernel sees escaped elapsed so replace with wide values
+  bool fixMax = false;
+
+  for (const auto &pe : wideElapseds_) {
+    int64_t start = starts_[pe.first];
+
+    if (start >= t1 && start <= t2) {
+      if (fixWideStats(stats1, start, pe.second))
+        fixMax = true;
+    }
+  }
+
+  // escape value counted as max so recalc max from real values
+  if (fixMax) {
+    stats1.maxElapsed = INT64_MIN;
+    stats1.maxEnd     = INT64_MIN;
+
+    for (uint i = 0; i < size(); ++i) {
+      int64_t start = starts_[i];
+
+      if (start >= t1 && start <= t2)
+        fixWideMax(stats1, start, elapsed(i));
+    }
+  }
+
+  stats.add(stats1);
+}
+
+void
+CQPerfTimeColumns::
+binStats(int64_t t1, int64_t t2, uint nb, RangeStats *bins) const
+{
+  CQPerfKernels::binStats(starts(), elapseds(), size(), t1, t2, nb, bins);
+
+  if (wideElapseds_.empty() || nb == 0 || t2 <= t1)
+    return;
+
+  // kernel sees escaped elapsed so replace with wide values
+  double scale = double(nb)/double(t2 - t1);
+
+  std::vector<bool> fixMax;
+
+  for (const auto &pe : wideElapseds_) {
+    int64_t start = starts_[pe.first];
+
+    if (start < t1 || start >= t2)
+      continue;
+
+    auto ib = CQPerfKernels::binIndex(start, t1, scale, nb);
+
+    if (fixWideStats(bins[ib], start, pe.second)) {
+      if (fixMax.empty())
+        fixMax.resize(nb);
+
+      fixMax[ib] = true;
+    }
+  }
+
+  if (fixMax.empty())
+    return;
+
+  // escape value counted as max so recalc max of those bins from real values
+  for (uint ib = 0; ib < nb; ++ib) {
+    if (fixMax[ib]) {
+      bins[ib].maxElapsed = INT64_MIN;
+      bins[ib].maxEnd     = INT64_MIN;
+    }
+  }
+
+  for (uint i = 0; i < size(); ++i) {
+    int64_t start = starts_[i];
+
+    if (start < t1 || start >= t2)
+      continue;
+
+    auto ib = CQPerfKernels::binIndex(start, t1, scale, nb);
+
+    if (fixMax[ib])
+      fixWideMax(bins[ib], start, elapsed(i));
+  }
+}
+
+bool
+CQPerfTimeColumns::
+fixWideStats(RangeStats &stats, int64_t start, int64_t elapsed) const
+{
+  stats.sum += elapsed - int64_t(ELAPSED_ESCAPE);
+
+  // only escaped values in range so min is from wide values
+  if (stats.minElapsed == int64_t(ELAPSED_ESCAPE))
+    stats.minElapsed = elapsed;
+  else
+    stats.minElapsed = std::min(stats.minElapsed, elapsed);
+
+  // wide values are either negative or larger than escape value, negative values
+  // leave escape value as max so it needs recalculating
+  if (elapsed < 0)
+    return true;
+
+  fixWideMax(stats, start, elapsed);
+
+  return false;
+}
+
+void
+CQPerfTimeColumns::
+fixWideMax(RangeStats &stats, int64_t start, int64_t elapsed) const
+{
+  stats.maxElapsed = std::max(stats.maxElapsed, elapsed);
+  stats.maxEnd     = std::max(stats.maxEnd    , start + elapsed);
+}
+
+size_t
+CQPerfTimeColumns::
+memorySize() const
+{
+  return starts_.capacity()*sizeof(int64_t) + elapseds_.capacity()*sizeof(uint32_t) +
+         depths_.capacity()*sizeof(uint8_t) +
+         (wideElapseds_.size() + wideDepths_.size())*4*sizeof(int64_t);
+}
+
+//---
+
+CQPerfTimeStream::
+~CQPerfTimeStream()
+{
+  clear();
+}
+
+void
+CQPerfTimeStream::
+clear()
+{
+  for (auto &chunk : chunks_)
+    CQPerfChunkPoolInst->release(chunk.data);
+
+  chunks_.clear();
+
+  size_      = 0;
+  lastStart_ = 0;
+  lastTid_   = 0;
+}
+
+void
+CQPerfTimeStream::
+push_back(const TimeData &timeData)
+{
+  CQPerfTimeCodec::Record record;
+
+  record.start   = TimeData::timeToTicks(timeData.start);
+  record.elapsed = TimeData::timeToTicks(timeData.elapsed);
+  record.depth   = timeData.depth;
+
+  // start new chunk if not enough space for largest record
+  if (chunks_.empty() || chunks_.back().len + MAX_RECORD_SIZE > CQPerfChunkPool::CHUNK_SIZE)
+    chunks_.emplace_back(CQPerfChunkPoolInst->alloc());
+
+  auto &chunk = chunks_.back();
+
+  // thread id delta (one byte while calls come from same thread)
+  int64_t  tidDelta  = int64_t(timeData.tid) - int64_t(lastTid_);
+  uint64_t tidZigzag = (uint64_t(tidDelta) << 1) ^ uint64_t(tidDelta >> 63);
+
+  chunk.len += size_t(CQPerfTimeCodec::encodeVarint(tidZigzag, &chunk.data[chunk.len]));
+
+  chunk.len += size_t(CQPerfTimeCodec::encode(record, lastStart_, &chunk.data[chunk.len]));
+
+  lastStart_ = record.start;
+  lastTid_   = timeData.tid;
+
+  ++size_;
+}
+
+CQPerfTimeStream::const_iterator::
+const_iterator(const Chunks *chunks, size_t chunk, size_t pos) :
+ chunks_(chunks), chunk_(chunk), pos_(pos)
+{
+  decode();
+}
+
+CQPerfTimeStream::const_iterator &
+CQPerfTimeStream::const_iterator::
+operator++()
+{
+  pos_ += len_;
+
+  // move to next chunk at end of current chunk
+  if (pos_ >= (*chunks_)[chunk_].len) {
+    ++chunk_;
+
+    pos_ = 0;
+  }
+
+  decode();
+
+  return *this;
+}
+
+void
+CQPerfTimeStream::const_iterator::
+decode()
+{
+  if (chunk_ >= chunks_->size())
+    return;
+
+  const auto &chunk = (*chunks_)[chunk_];
+
+  const uint8_t *p   = &chunk.data[pos_];
+  const uint8_t *end = &chunk.data[chunk.len];
+
+  uint64_t tidZigzag;
+
+  int n = CQPerfTimeCodec::decodeVarint(p, end, tidZigzag);
+  assert(n > 0);
+
+  CQPerfTimeCodec::Record record;
+
+  int n1 = CQPerfTimeCodec::decode(p + n, end, start_, record);
+  assert(n1 > 0);
+
+  len_ = size_t(n + n1);
+
+  start_ = record.start;
+  tid_   = uint32_t(int64_t(tid_) + (int64_t(tidZigzag >> 1) ^ -int64_t(tidZigzag & 1)));
+
+  timeData_.depth   = record.depth;
+  timeData_.tid     = tid_;
+  timeData_.start   = TimeData::ticksToTime(record.start);
+  timeData_.elapsed = TimeData::ticksToTime(record.elapsed);
+}
+
+//---
+
+CQPerfTraceData::
+CQPerfTraceData(const QString &name, uint id) :
+ name_(name), utf8Name_(name.toStdString()), id_(id),
+ rollups_(CQPerfMonitorInst->rollupSize())
+{
+}
+
+//---
+
+void
+CQPerfTraceData::
+startTrace(const CHRTime &start, uint depth)
+{
+  timeData_.depth = depth;
+  timeData_.start = start;
+}
+
+void
+CQPerfTraceData::
+endTrace(TraceType traceType)
+{
+  // calc elapsed time from last start
+  TimeData timeData = timeData_;
+
+  timeData.tid     = CQPerfRecordFile::currentThreadId();
+  timeData.elapsed = CHRTime::diffTime(timeData.start, CQPerfMonitorInst->getTime());
+
+  endTrace(timeData, traceType, 0);
+}
+
+void
+CQPerfTraceData::
+endTrace(const TimeData &timeData, TraceType traceType, int64_t childElapsed)
+{
+  timeData_ = timeData;
+
+  addTrace(timeData, traceType, childElapsed);
+}
+
+void
 CQPerfTraceData::
-addTrace(const TimeData &timeData, TraceType traceType)
+addTrace(const TimeData &timeData, TraceType traceType, int64_t childElapsed)
 {
+  int64_t elapsed = TimeData::timeToTicks(timeData.elapsed);
+
   // update number of calls, total time, max and min time
   ++calls_;
 
   elapsed_ += timeData.elapsed;
 
+  if (indexNode_)
+    CQPerfNameIndex::addStats(indexNode_, 1, elapsed);
+
+  totals_.add(elapsed);
+
+  // time in nested traces is not self time
+  selfElapsed_ += elapsed - std::min(childElapsed, elapsed);
+
   if (elapsedMin_.isSet()) {
     elapsedMin_ = std::min(elapsedMin_, timeData.elapsed);
     elapsedMax_ = std::max(elapsedMax_, timeData.elapsed);
@@ -550,6 +1701,8 @@ addTrace(const TimeData &timeData, TraceType traceType)
     elapsedMax_ = timeData.elapsed;
   }
 
+  publishStats(CQPerfRollup::histIndex(elapsed));
+
   //---
 
   // get limits of window count and time
@@ -585,55 +1738,57 @@ addTrace(const TimeData &timeData, TraceType traceType)
     times_.push_back(timeData);
 
   if (recording_) {
-    if (traceType != TraceType::NO_RECORD)
-      recordTimes_.push_back(timeData);
+    if (traceType != TraceType::NO_RECORD) {
+      auto *recordFile = CQPerfMonitorInst->recordFile();
+
+      if (recordFile) {
+        if (! recordFile->isTraceDefined(id_))
+          recordFile->defineTrace(id_, utf8Name_);
+
+        recordFile->addSpan(id_, TimeData::timeToTicks(timeData.start),
+                            TimeData::timeToTicks(timeData.elapsed), timeData.depth);
+      }
+      else
+        recordTimes_.push_back(timeData);
+    }
   }
 
+  rollups_.add(TimeData::timeToTicks(timeData.start), TimeData::timeToTicks(timeData.elapsed));
+
   //---
 
   if (windowTime.isSet()) {
+    int64_t windowTicks = TimeData::timeToTicks(windowTime);
+
     uint i = 0;
     uint n = windowCount;
 
     for ( ; i < n; ++i) {
       int pos = fixPos(posStart_ + int(i));
 
-      if (this->timeData(pos).start >= windowTime)
+      if (times_.start(uint(pos)) >= windowTicks)
         break;
     }
   }
 
   //---
 
-  if (maxCalls_ > 0 && calls_ > maxCalls_)
+  // alert once until reset or limit changed
+  if (maxCalls_ > 0 && calls_ > maxCalls_ && ! callsAlerted_) {
+    callsAlerted_ = true;
+
     CQPerfMonitorInst->alert(this, CQPerfMonitor::AlertType::CALLS);
+  }
+
+  if (maxTime_.isSet() && elapsedMax_ > maxTime_ && ! timeAlerted_) {
+    timeAlerted_ = true;
 
-  if (maxTime_.isSet() && elapsedMax_ > maxTime_)
     CQPerfMonitorInst->alert(this, CQPerfMonitor::AlertType::TIME);
+  }
 }
 
 //---
 
-void
-CQPerfTraceData::
-startDebug(uint depth)
-{
-  timeData_.depth = depth;
-  timeData_.start = CHRTime::getTime();
-}
-
-void
-CQPerfTraceData::
-endDebug()
-{
-  // calc elapsed time
-  CHRTime endTime = CHRTime::getTime();
-
-  timeData_.elapsed = CHRTime::diffTime(timeData_.start, endTime);
-
-  addDebug(timeData_);
-}
-
 void
 CQPerfTraceData::
 addDebug(const TimeData &timeData)
@@ -643,6 +1798,11 @@ addDebug(const TimeData &timeData)
 
     elapsed_ += timeData.elapsed;
 
+    if (indexNode_)
+      CQPerfNameIndex::addStats(indexNode_, 1, TimeData::timeToTicks(timeData.elapsed));
+
+    totals_.add(TimeData::timeToTicks(timeData.elapsed));
+
     if (elapsedMin_.isSet()) {
       elapsedMin_ = std::min(elapsedMin_, timeData.elapsed);
       elapsedMax_ = std::max(elapsedMax_, timeData.elapsed);
@@ -651,9 +1811,26 @@ addDebug(const TimeData &timeData)
       elapsedMin_ = timeData.elapsed;
       elapsedMax_ = timeData.elapsed;
     }
+
+    publishStats(CQPerfRollup::histIndex(TimeData::timeToTicks(timeData.elapsed)));
   }
 }
 
+void
+CQPerfTraceData::
+publishStats(int histIndex)
+{
+  CQPerfTraceStats::Snapshot snapshot;
+
+  snapshot.calls      = calls_;
+  snapshot.elapsed    = TimeData::timeToTicks(elapsed_   );
+  snapshot.elapsedMin = TimeData::timeToTicks(elapsedMin_);
+  snapshot.elapsedMax = TimeData::timeToTicks(elapsedMax_);
+
+  stats_.publish(snapshot, generation_, totals_, selfElapsed_, histIndex,
+                 CQPerfMonitorInst->statsEpoch());
+}
+
 //---
 
 void
@@ -669,6 +1846,21 @@ reset()
   elapsed_    = CHRTime();
   elapsedMin_ = CHRTime();
   elapsedMax_ = CHRTime();
+
+  callsAlerted_ = false;
+  timeAlerted_  = false;
+
+  if (indexNode_)
+    CQPerfNameIndex::resetStats(indexNode_);
+
+  totals_      = CQPerfRollup::Totals();
+  selfElapsed_ = 0;
+
+  ++generation_;
+
+  publishStats(-1);
+
+  rollups_.reset();
 }
 
 //---
@@ -691,78 +1883,59 @@ stopRecording()
 
 //---
 
-const CHRTime &
+CHRTime
 CQPerfTraceData::
 windowStartTime() const
 {
   int pos = fixPos(posStart_);
 
-  return timeData(pos).start;
+  return TimeData::ticksToTime(times_.start(uint(pos)));
 }
 
-const CHRTime &
+CHRTime
 CQPerfTraceData::
 windowEndTime() const
 {
   int pos = posEnd();
 
-  return timeData(pos).start;
+  return TimeData::ticksToTime(times_.start(uint(pos)));
 }
 
 void
 CQPerfTraceData::
 windowDetails(WindowData &windowData) const
 {
-  uint n = windowSize();
-
-  for (uint i = 0; i < n; ++i) {
-    int pos = fixPos(posStart_ + int(i));
-
-    const TimeData &data = timeData(pos);
-
-    if (windowData.minT.isSet())
-      windowData.minT = std::min(windowData.minT, data.start);
-    else
-      windowData.minT = data.start;
+  // order of entries does not matter for aggregation so stream columns in storage order
+  CQPerfKernels::RangeStats stats;
 
-    if (windowData.maxT.isSet())
-      windowData.maxT = std::max(windowData.maxT, data.start + data.elapsed);
-    else
-      windowData.maxT = data.start + data.elapsed;
+  times_.rangeStats(INT64_MIN, INT64_MAX, stats);
 
-    ++windowData.numCalls;
-
-    windowData.elapsed += data.elapsed;
-  }
+  addWindowData(windowData, stats);
 }
 
 void
 CQPerfTraceData::
 windowDetails(const CHRTime &t1, const CHRTime &t2, WindowData &windowData) const
 {
-  uint n = windowSize();
+  CQPerfKernels::RangeStats stats;
 
-  for (uint i = 0; i < n; ++i) {
-    int pos = fixPos(posStart_ + int(i));
+  times_.rangeStats(TimeData::timeToTicks(t1), TimeData::timeToTicks(t2), stats);
 
-    const TimeData &data = timeData(pos);
+  addWindowData(windowData, stats);
+}
 
-    if (data.start >= t1 && data.start <= t2) {
-      if (windowData.minT.isSet())
-        windowData.minT = std::min(windowData.minT, data.start);
-      else
-        windowData.minT = data.start;
+void
+CQPerfTraceData::
+windowDetails(const CHRTime &t1, const CHRTime &t2, uint n, WindowDatas &windowDatas) const
+{
+  windowDatas.resize(n);
 
-      if (windowData.maxT.isSet())
-        windowData.maxT = std::max(windowData.maxT, data.start + data.elapsed);
-      else
-        windowData.maxT = data.start + data.elapsed;
+  std::vector<CQPerfKernels::RangeStats> bins(n);
 
-      ++windowData.numCalls;
+  times_.binStats(TimeData::timeToTicks(t1), TimeData::timeToTicks(t2), n, bins.data());
 
-      windowData.elapsed += data.elapsed;
-    }
-  }
+  for (uint i = 0; i < n; ++i)
+    addWindowData(windowDatas[i], bins[i]);
 }
 
 void
@@ -771,16 +1944,89 @@ windowDetails(const CHRTime &t1, const CHRTime &t2, TimeDatas &timeDatas) const
 {
   uint n = windowSize();
 
+  int64_t it1 = TimeData::timeToTicks(t1);
+  int64_t it2 = TimeData::timeToTicks(t2);
+
   for (uint i = 0; i < n; ++i) {
     int pos = fixPos(posStart_ + int(i));
 
-    const TimeData &data = timeData(pos);
+    int64_t start = times_.start(uint(pos));
 
-    if (data.start >= t1 && data.start <= t2)
-      timeDatas.push_back(data);
+    if (start >= it1 && start <= it2)
+      timeDatas.push_back(timeData(pos));
   }
 }
 
+void
+CQPerfTraceData::
+addWindowData(WindowData &windowData, const CQPerfKernels::RangeStats &stats) const
+{
+  if (stats.count > 0)
+    addWindowData(windowData, int(stats.count), stats.sum, stats.minStart, stats.maxEnd);
+}
+
+void
+CQPerfTraceData::
+addWindowData(WindowData &windowData, int numCalls, int64_t elapsed,
+              int64_t minT, int64_t maxT) const
+{
+  auto minT1 = TimeData::ticksToTime(minT);
+  auto maxT1 = TimeData::ticksToTime(maxT);
+
+  if (windowData.minT.isSet())
+    windowData.minT = std::min(windowData.minT, minT1);
+  else
+    windowData.minT = minT1;
+
+  if (windowData.maxT.isSet())
+    windowData.maxT = std::max(windowData.maxT, maxT1);
+  else
+    windowData.maxT = maxT1;
+
+  windowData.numCalls += numCalls;
+
+  windowData.elapsed += TimeData::ticksToTime(elapsed);
+}
+
+bool
+CQPerfTraceData::
+rollupDetails(const CHRTime &t1, const CHRTime &t2, double resolution,
+              WindowData &windowData) const
+{
+  int64_t it1 = TimeData::timeToTicks(t1);
+  int64_t it2 = TimeData::timeToTicks(t2);
+
+  CQPerfRollup::Bucket bucket;
+
+  const auto *rollup = rollupBucket(it1, it2, int64_t(resolution), bucket);
+
+  if (! rollup)
+    return false;
+
+  if (bucket.count == 0)
+    return true;
+
+  int64_t bt1 = std::max(it1, rollup->startTime());
+  int64_t bt2 = std::min(it2, rollup->endTime  ());
+
+  addWindowData(windowData, int(bucket.count), bucket.sum, bt1, bt2);
+
+  return true;
+}
+
+const CQPerfRollup *
+CQPerfTraceData::
+rollupBucket(int64_t t1, int64_t t2, int64_t resolution, CQPerfRollup::Bucket &bucket) const
+{
+  // use coarsest buckets which are fine enough for resolution and still hold start time
+  const auto *rollup = rollups_.findRollup(resolution, t1);
+
+  if (rollup)
+    rollup->details(t1, t2, bucket);
+
+  return rollup;
+}
+
 //---
 
 void
@@ -15,11 +15,58 @@ MOC_DIR = .moc
 SOURCES += \
 CQPerfMonitor.cpp \
 CQPerfGraph.cpp \
+CQPerfRollup.cpp \
+CQPerfKernels.cpp \
+CQPerfTimeCodec.cpp \
+CQPerfChunkPool.cpp \
+CQPerfRecordFile.cpp \
+CQPerfTraceEventWriter.cpp \
+CQPerfRecordReader.cpp \
+CQPerfCallTree.cpp \
+CQPerfFlameGraph.cpp \
+CQPerfFlightRecorder.cpp \
+CQPerfFlightReader.cpp \
+CQPerfAlertEngine.cpp \
+CQPerfLogger.cpp \
+CQPerfPatternMatcher.cpp \
+CQPerfNameIndex.cpp \
+CQPerfSnapshot.cpp \
+CQPerfMetricsServer.cpp \
+CQPerfStatsDEmitter.cpp \
+CQPerfReporter.cpp \
+CQPerfRegression.cpp \
+CQPerfClock.cpp \
+CQPerfPeriodicWorker.cpp \
+CQPerfRotatingFile.cpp \
 CMessage.cpp \
 
 HEADERS += \
 ../include/CQPerfMonitor.h \
 ../include/CQPerfGraph.h \
+../include/CQPerfRollup.h \
+../include/CQPerfKernels.h \
+../include/CQPerfTimeCodec.h \
+../include/CQPerfChunkPool.h \
+../include/CQPerfRecordFile.h \
+../include/CQPerfTraceEventWriter.h \
+../include/CQPerfRecordReader.h \
+../include/CQPerfCallTree.h \
+../include/CQPerfFlameGraph.h \
+../include/CQPerfFlightRecorder.h \
+../include/CQPerfFlightReader.h \
+../include/CQPerfAlertEngine.h \
+../include/CQPerfLogger.h \
+../include/CQPerfPatternMatcher.h \
+../include/CQPerfNameIndex.h \
+../include/CQPerfTraceStats.h \
+../include/CQPerfSnapshot.h \
+../include/CQPerfMetricsServer.h \
+../include/CQPerfStatsDEmitter.h \
+../include/CQPerfReporter.h \
+../include/CQPerfRegression.h \
+../include/CQPerfClock.h \
+../include/CQPerfPeriodicWorker.h \
+../include/CQPerfRotatingFile.h \
 
 OBJECTS_DIR = ../obj
 
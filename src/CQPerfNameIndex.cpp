@@ -0,0 +1,185 @@
+#include <CQPerfNameIndex.h>
+
+CQPerfNameIndex::
+CQPerfNameIndex()
+{
+}
+
+CQPerfNameIndex::
+~CQPerfNameIndex()
+{
+  deleteChildren(&root_);
+}
+
+void
+CQPerfNameIndex::
+deleteChildren(Node *node)
+{
+  for (auto &pc : node->children) {
+    deleteChildren(pc.second);
+
+    delete pc.second;
+  }
+
+  node->children.clear();
+}
+
+void
+CQPerfNameIndex::
+splitName(const std::string &name, std::vector<std::string> &keys)
+{
+  size_t i   = 0;
+  size_t len = name.size();
+
+  while (i < len) {
+    size_t j = i;
+
+    while (j < len) {
+      if      (name[j] == '/') {
+        j += 1;
+        break;
+      }
+      else if (name[j] == ':' && j + 1 < len && name[j + 1] == ':') {
+        j += 2;
+        break;
+      }
+
+      ++j;
+    }
+
+    keys.push_back(name.substr(i, j - i));
+
+    i = j;
+  }
+}
+
+CQPerfNameIndex::Node *
+CQPerfNameIndex::
+add(const std::string &name, CQPerfTraceData *trace)
+{
+  std::vector<std::string> keys;
+
+  splitName(name, keys);
+
+  Node *node = &root_;
+
+  for (const auto &key : keys) {
+    auto p = node->children.find(key);
+
+    if (p == node->children.end()) {
+      auto *child = new Node;
+
+      child->parent = node;
+      child->key    = key;
+
+      p = node->children.insert(p, Node::Children::value_type(key, child));
+    }
+
+    node = (*p).second;
+  }
+
+  node->trace = trace;
+
+  return node;
+}
+
+void
+CQPerfNameIndex::
+getTraces(const std::string &prefix, Traces &traces) const
+{
+  std::vector<std::string> keys;
+
+  splitName(prefix, keys);
+
+  const Node *node = &root_;
+
+  // descend through whole segments of prefix (keys ending in a separator)
+  size_t k = 0;
+
+  for ( ; k < keys.size(); ++k) {
+    const auto &key = keys[k];
+
+    auto len = key.size();
+
+    bool isSep = (key[len - 1] == '/' || (len >= 2 && key.compare(len - 2, 2, "::") == 0));
+
+    if (! isSep)
+      break;
+
+    auto p = node->children.find(key);
+
+    if (p == node->children.end())
+      break;
+
+    node = (*p).second;
+  }
+
+  //---
+
+  // remaining partial segment(s) match all children starting with it
+  std::string rest;
+
+  for ( ; k < keys.size(); ++k)
+    rest += keys[k];
+
+  if (rest.empty()) {
+    addSubtree(node, traces);
+    return;
+  }
+
+  for (auto p = node->children.lower_bound(rest); p != node->children.end(); ++p) {
+    if ((*p).first.compare(0, rest.size(), rest) != 0)
+      break;
+
+    addSubtree((*p).second, traces);
+  }
+}
+
+const CQPerfNameIndex::Node *
+CQPerfNameIndex::
+findNode(const std::string &prefix) const
+{
+  std::vector<std::string> keys;
+
+  splitName(prefix, keys);
+
+  const Node *node = &root_;
+
+  for (const auto &key : keys) {
+    auto p = node->children.find(key);
+
+    if (p == node->children.end())
+      return nullptr;
+
+    node = (*p).second;
+  }
+
+  return node;
+}
+
+void
+CQPerfNameIndex::
+resetStats(Node *node)
+{
+  int64_t calls   = node->selfCalls;
+  int64_t elapsed = node->selfElapsed;
+
+  node->selfCalls   = 0;
+  node->selfElapsed = 0;
+
+  for ( ; node; node = node->parent) {
+    node->calls   -= calls;
+    node->elapsed -= elapsed;
+  }
+}
+
+void
+CQPerfNameIndex::
+addSubtree(const Node *node, Traces &traces)
+{
+  if (node->trace)
+    traces.push_back(node->trace);
+
+  for (const auto &pc : node->children)
+    addSubtree(pc.second, traces);
+}
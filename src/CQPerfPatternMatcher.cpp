@@ -0,0 +1,243 @@
+#include <CQPerfPatternMatcher.h>
+
+#include <algorithm>
+
+CQPerfPatternMatcher::
+CQPerfPatternMatcher(const std::string &patterns)
+{
+  setPatterns(patterns);
+}
+
+void
+CQPerfPatternMatcher::
+setPatterns(const std::string &patterns)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  patterns_ = patterns;
+
+  tokens_  .clear();
+  starts_  .clear();
+  states_  .clear();
+  stateIds_.clear();
+
+  std::string::size_type i = 0;
+
+  while (i <= patterns.size()) {
+    auto j = patterns.find('|', i);
+
+    if (j == std::string::npos)
+      j = patterns.size();
+
+    if (j > i)
+      addPattern(patterns.substr(i, j - i));
+
+    i = j + 1;
+  }
+
+  // start state (state 0)
+  Positions positions = starts_;
+
+  addState(positions);
+}
+
+void
+CQPerfPatternMatcher::
+addPattern(const std::string &pattern)
+{
+  starts_.push_back(uint32_t(tokens_.size()));
+
+  auto addChar = [&](uint8_t c) {
+    Token token;
+
+    token.type = TokenType::CHAR;
+
+    token.chars.set(c);
+
+    tokens_.push_back(token);
+  };
+
+  size_t i   = 0;
+  size_t len = pattern.size();
+
+  while (i < len) {
+    uint8_t c = uint8_t(pattern[i++]);
+
+    if      (c == '*') {
+      // consecutive stars are same as one
+      if (tokens_.size() == starts_.back() || tokens_.back().type != TokenType::STAR) {
+        Token token;
+
+        token.type = TokenType::STAR;
+
+        tokens_.push_back(token);
+      }
+    }
+    else if (c == '?') {
+      Token token;
+
+      token.type = TokenType::CHAR;
+
+      token.chars.set();
+
+      tokens_.push_back(token);
+    }
+    else if (c == '[') {
+      // find end of class (']' directly after '[' or '[!' is literal)
+      size_t j = i;
+
+      bool negate = (j < len && (pattern[j] == '!' || pattern[j] == '^'));
+
+      if (negate)
+        ++j;
+
+      size_t k = j;
+
+      if (k < len && pattern[k] == ']')
+        ++k;
+
+      while (k < len && pattern[k] != ']')
+        ++k;
+
+      // unterminated class is literal '['
+      if (k >= len) {
+        addChar(c);
+        continue;
+      }
+
+      Token token;
+
+      token.type = TokenType::CHAR;
+
+      for (size_t l = j; l < k; ++l) {
+        uint8_t c1 = uint8_t(pattern[l]);
+
+        if (l + 2 < k && pattern[l + 1] == '-') {
+          uint8_t c2 = uint8_t(pattern[l + 2]);
+
+          for (int c3 = c1; c3 <= c2; ++c3)
+            token.chars.set(size_t(c3));
+
+          l += 2;
+        }
+        else
+          token.chars.set(c1);
+      }
+
+      if (negate)
+        token.chars.flip();
+
+      tokens_.push_back(token);
+
+      i = k + 1;
+    }
+    else if (c == '\\' && i < len) {
+      addChar(uint8_t(pattern[i++]));
+    }
+    else
+      addChar(c);
+  }
+
+  Token token;
+
+  token.type = TokenType::END;
+
+  tokens_.push_back(token);
+}
+
+void
+CQPerfPatternMatcher::
+closure(Positions &positions) const
+{
+  // star can match empty so position after it is also active
+  size_t n = positions.size();
+
+  for (size_t i = 0; i < n; ++i) {
+    if (tokens_[positions[i]].type == TokenType::STAR)
+      positions.push_back(positions[i] + 1);
+  }
+
+  std::sort(positions.begin(), positions.end());
+
+  positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+}
+
+int
+CQPerfPatternMatcher::
+addState(Positions &positions) const
+{
+  closure(positions);
+
+  auto p = stateIds_.find(positions);
+
+  if (p != stateIds_.end())
+    return (*p).second;
+
+  int id = int(states_.size());
+
+  states_.emplace_back();
+
+  auto &state = states_.back();
+
+  state.positions = positions;
+
+  for (const auto &pos : positions) {
+    if (tokens_[pos].type == TokenType::END)
+      state.accept = true;
+  }
+
+  std::fill(state.next, state.next + 256, -1);
+
+  stateIds_[positions] = id;
+
+  return id;
+}
+
+int
+CQPerfPatternMatcher::
+nextState(int state, uint8_t c) const
+{
+  int next = states_[size_t(state)].next[c];
+
+  if (next >= 0)
+    return next;
+
+  Positions positions;
+
+  for (const auto &pos : states_[size_t(state)].positions) {
+    const auto &token = tokens_[pos];
+
+    if      (token.type == TokenType::STAR)
+      positions.push_back(pos);
+    else if (token.type == TokenType::CHAR && token.chars.test(c))
+      positions.push_back(pos + 1);
+  }
+
+  next = addState(positions);
+
+  states_[size_t(state)].next[c] = next;
+
+  return next;
+}
+
+bool
+CQPerfPatternMatcher::
+match(const std::string &name) const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  if (tokens_.empty())
+    return false;
+
+  int state = 0;
+
+  for (const auto &c : name) {
+    state = nextState(state, uint8_t(c));
+
+    // no pattern can match
+    if (states_[size_t(state)].positions.empty())
+      return false;
+  }
+
+  return states_[size_t(state)].accept;
+}
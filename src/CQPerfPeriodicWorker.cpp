@@ -0,0 +1,138 @@
+#include <CQPerfPeriodicWorker.h>
+
+#include <algorithm>
+#include <chrono>
+
+CQPerfPeriodicWorker::
+CQPerfPeriodicWorker(int64_t interval, const Tick &tick, bool finalCall) :
+ tick_(tick), finalCall_(finalCall), interval_(std::max(interval, int64_t(1000)))
+{
+}
+
+CQPerfPeriodicWorker::
+~CQPerfPeriodicWorker()
+{
+  stop();
+}
+
+int64_t
+CQPerfPeriodicWorker::
+interval() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  return interval_;
+}
+
+void
+CQPerfPeriodicWorker::
+setInterval(int64_t i)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  interval_ = std::max(i, int64_t(1000));
+
+  cond_.notify_all();
+}
+
+void
+CQPerfPeriodicWorker::
+wake()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  woken_ = true;
+
+  cond_.notify_all();
+}
+
+bool
+CQPerfPeriodicWorker::
+isRunning() const
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  return running_;
+}
+
+void
+CQPerfPeriodicWorker::
+start()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  if (running_)
+    return;
+
+  running_ = true;
+  stop_    = false;
+
+  thread_ = std::thread(&CQPerfPeriodicWorker::run, this);
+}
+
+void
+CQPerfPeriodicWorker::
+stop()
+{
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (! running_)
+      return;
+
+    stop_ = true;
+
+    cond_.notify_all();
+  }
+
+  thread_.join();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  running_ = false;
+}
+
+void
+CQPerfPeriodicWorker::
+run()
+{
+  using Clock = std::chrono::steady_clock;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  auto last = Clock::now();
+
+  while (! stop_) {
+    // interval change wakes thread to recalculate next call from new interval
+    int64_t interval = interval_;
+
+    auto next = last + std::chrono::microseconds(interval);
+
+    cond_.wait_until(lock, next, [&]() { return stop_ || woken_ || interval_ != interval; });
+
+    if (stop_)
+      break;
+
+    bool elapsed = (Clock::now() >= next);
+
+    if (! elapsed && ! woken_)
+      continue;
+
+    woken_ = false;
+
+    if (elapsed)
+      last = Clock::now();
+
+    lock.unlock();
+
+    tick_(elapsed);
+
+    lock.lock();
+  }
+
+  if (finalCall_) {
+    lock.unlock();
+
+    tick_(true);
+  }
+}
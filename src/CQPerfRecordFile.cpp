@@ -0,0 +1,425 @@
+#include <CQPerfRecordFile.h>
+
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+
+namespace {
+
+template<typename T>
+void appendValue(std::vector<uint8_t> &data, const T &value) {
+  const auto *p = reinterpret_cast<const uint8_t *>(&value);
+
+  data.insert(data.end(), p, p + sizeof(T));
+}
+
+}
+
+CQPerfRecordFile::
+CQPerfRecordFile()
+{
+}
+
+CQPerfRecordFile::
+~CQPerfRecordFile()
+{
+  close();
+}
+
+bool
+CQPerfRecordFile::
+open(const std::string &filename)
+{
+  close();
+
+  fd_ = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+  if (fd_ < 0) {
+    std::cerr << "Failed to open record file " << filename << "\n";
+    return false;
+  }
+
+  if (ftruncate(fd_, off_t(HEADER_SIZE)) != 0) {
+    std::cerr << "Failed to size record file " << filename << "\n";
+    ::close(fd_); fd_ = -1;
+    return false;
+  }
+
+  headerMem_ = mmap(nullptr, HEADER_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+
+  if (headerMem_ == MAP_FAILED) {
+    std::cerr << "Failed to map record file " << filename << "\n";
+    headerMem_ = nullptr;
+    ::close(fd_); fd_ = -1;
+    return false;
+  }
+
+  filename_ = filename;
+
+  //---
+
+  struct timeval tv;
+
+  gettimeofday(&tv, nullptr);
+
+  auto *h = header();
+
+  memset(h, 0, HEADER_SIZE);
+
+  memcpy(h->magic, magic(), sizeof(h->magic));
+
+  h->version     = VERSION;
+  h->headerSize  = uint32_t(HEADER_SIZE);
+  h->startTime   = int64_t(tv.tv_sec)*1000000 + tv.tv_usec;
+  h->dataSize    = 0;
+  h->pid         = uint32_t(getpid());
+  h->closed      = 0;
+  h->indexOffset = 0;
+
+  segment_    = 0;
+  dataSize_   = 0;
+  numBlocks_  = 0;
+  lastSync_   = 0;
+
+  threadBlocks_.clear();
+  fileIds_     .clear();
+  traceInfos_  .clear();
+  blockInfos_  .clear();
+
+  return mapSegment(0);
+}
+
+void
+CQPerfRecordFile::
+close()
+{
+  if (fd_ < 0)
+    return;
+
+  flush();
+
+  writeIndex();
+
+  writeSync();
+
+  unmapSegment();
+
+  // trim to written size
+  if (ftruncate(fd_, off_t(HEADER_SIZE + dataSize_)) != 0)
+    std::cerr << "Failed to trim record file " << filename_ << "\n";
+
+  header()->closed = 1;
+
+  msync(headerMem_, HEADER_SIZE, MS_SYNC);
+
+  munmap(headerMem_, HEADER_SIZE);
+
+  headerMem_ = nullptr;
+
+  ::close(fd_);
+
+  fd_ = -1;
+}
+
+void
+CQPerfRecordFile::
+defineTrace(uint32_t id, const std::string &name)
+{
+  if (fd_ < 0)
+    return;
+
+  if (isTraceDefined(id))
+    return;
+
+  // file ids are assigned densely in definition order so a reader can bound them by
+  // the number of traces
+  uint32_t fileId = uint32_t(traceInfos_.size());
+
+  if (id >= fileIds_.size())
+    fileIds_.resize(id + 1);
+
+  fileIds_[id] = fileId + 1;
+
+  TraceInfo traceInfo;
+
+  traceInfo.id   = fileId;
+  traceInfo.name = name;
+
+  traceInfos_.push_back(traceInfo);
+
+  std::vector<uint8_t> data(sizeof(uint32_t) + name.size());
+
+  memcpy(&data[0], &fileId, sizeof(uint32_t));
+
+  memcpy(&data[sizeof(uint32_t)], name.c_str(), name.size());
+
+  writeBlock(BlockType::NAME, data.data(), data.size());
+}
+
+void
+CQPerfRecordFile::
+addSpan(uint32_t id, int64_t start, int64_t elapsed, uint32_t depth)
+{
+  if (fd_ < 0 || ! isTraceDefined(id))
+    return;
+
+  uint32_t fileId = fileIds_[id] - 1;
+
+  uint32_t tid = currentThreadId();
+
+  auto &block = threadBlocks_[tid];
+
+  if (block.bytes.empty()) {
+    block.tid       = tid;
+    block.count     = 0;
+    block.baseStart = start;
+    block.lastStart = start;
+    block.minStart  = start;
+    block.maxEnd    = start + elapsed;
+
+    block.bytes.reserve(BLOCK_SIZE);
+  }
+  else {
+    block.minStart = std::min(block.minStart, start);
+    block.maxEnd   = std::max(block.maxEnd  , start + elapsed);
+  }
+
+  traceInfos_[fileId].add(elapsed, depth);
+
+  // encode trace id and record
+  uint8_t buffer[10 + CQPerfTimeCodec::MAX_RECORD_SIZE];
+
+  int n = CQPerfTimeCodec::encodeVarint(fileId, buffer);
+
+  CQPerfTimeCodec::Record record;
+
+  record.start   = start;
+  record.elapsed = elapsed;
+  record.depth   = depth;
+
+  n += CQPerfTimeCodec::encode(record, block.lastStart, &buffer[n]);
+
+  block.bytes.insert(block.bytes.end(), buffer, buffer + n);
+
+  block.lastStart = start;
+
+  ++block.count;
+
+  if (block.bytes.size() + sizeof(buffer) > BLOCK_SIZE)
+    flushBlock(block);
+}
+
+void
+CQPerfRecordFile::
+flush()
+{
+  for (auto &tb : threadBlocks_)
+    flushBlock(tb.second);
+}
+
+uint32_t
+CQPerfRecordFile::
+currentThreadId()
+{
+#ifdef SYS_gettid
+  static thread_local uint32_t tid = uint32_t(syscall(SYS_gettid));
+#else
+  static thread_local uint32_t tid = uint32_t(getpid());
+#endif
+
+  return tid;
+}
+
+void
+CQPerfRecordFile::
+flushBlock(ThreadBlock &block)
+{
+  if (block.count == 0)
+    return;
+
+  std::vector<uint8_t> data;
+
+  data.reserve(2*sizeof(uint32_t) + 3*sizeof(int64_t) + block.bytes.size());
+
+  appendValue(data, block.tid      );
+  appendValue(data, block.count    );
+  appendValue(data, block.baseStart);
+  appendValue(data, block.minStart );
+  appendValue(data, block.maxEnd   );
+
+  data.insert(data.end(), block.bytes.begin(), block.bytes.end());
+
+  BlockInfo blockInfo;
+
+  blockInfo.offset   = dataSize_;
+  blockInfo.tid      = block.tid;
+  blockInfo.count    = block.count;
+  blockInfo.minStart = block.minStart;
+  blockInfo.maxEnd   = block.maxEnd;
+
+  if (writeBlock(BlockType::SPANS, data.data(), data.size()))
+    blockInfos_.push_back(blockInfo);
+
+  block.bytes.clear();
+
+  block.count = 0;
+}
+
+bool
+CQPerfRecordFile::
+writeBlock(BlockType type, const void *data, size_t len)
+{
+  BlockHeader blockHeader;
+
+  blockHeader.type = uint32_t(type);
+  blockHeader.size = uint32_t(len);
+
+  uint64_t dataSize = dataSize_;
+
+  if (! write(&blockHeader, sizeof(blockHeader)) || ! write(data, len)) {
+    // drop partial block
+    dataSize_ = dataSize;
+    return false;
+  }
+
+  ++numBlocks_;
+
+  // publish complete block
+  header()->dataSize = dataSize_;
+
+  if (type != BlockType::SYNC && dataSize_ - lastSync_ >= SYNC_INTERVAL)
+    writeSync();
+
+  return true;
+}
+
+void
+CQPerfRecordFile::
+writeSync()
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, nullptr);
+
+  uint8_t data[3*sizeof(uint64_t)];
+
+  uint64_t magic = SYNC_MAGIC;
+  int64_t  t     = int64_t(tv.tv_sec)*1000000 + tv.tv_usec;
+  uint64_t nb    = numBlocks_;
+
+  memcpy(&data[0                 ], &magic, sizeof(uint64_t));
+  memcpy(&data[  sizeof(uint64_t)], &t    , sizeof(uint64_t));
+  memcpy(&data[2*sizeof(uint64_t)], &nb   , sizeof(uint64_t));
+
+  lastSync_ = dataSize_;
+
+  writeBlock(BlockType::SYNC, data, sizeof(data));
+}
+
+void
+CQPerfRecordFile::
+writeIndex()
+{
+  std::vector<uint8_t> data;
+
+  appendValue(data, uint32_t(traceInfos_.size()));
+
+  for (const auto &traceInfo : traceInfos_) {
+    appendValue(data, traceInfo.id);
+    appendValue(data, uint32_t(traceInfo.name.size()));
+
+    data.insert(data.end(), traceInfo.name.begin(), traceInfo.name.end());
+
+    appendValue(data, traceInfo.count   );
+    appendValue(data, traceInfo.elapsed );
+    appendValue(data, traceInfo.min     );
+    appendValue(data, traceInfo.max     );
+    appendValue(data, traceInfo.maxDepth);
+  }
+
+  appendValue(data, uint64_t(blockInfos_.size()));
+
+  for (const auto &blockInfo : blockInfos_) {
+    appendValue(data, blockInfo.offset  );
+    appendValue(data, blockInfo.tid     );
+    appendValue(data, blockInfo.count   );
+    appendValue(data, blockInfo.minStart);
+    appendValue(data, blockInfo.maxEnd  );
+  }
+
+  uint64_t indexOffset = dataSize_;
+
+  if (writeBlock(BlockType::INDEX, data.data(), data.size()))
+    header()->indexOffset = indexOffset;
+}
+
+bool
+CQPerfRecordFile::
+write(const void *data, size_t len)
+{
+  const auto *p = static_cast<const uint8_t *>(data);
+
+  while (len > 0) {
+    size_t segment = size_t(dataSize_/SEGMENT_SIZE);
+    size_t offset  = size_t(dataSize_ % SEGMENT_SIZE);
+
+    if (segment != segment_ || ! segmentMem_) {
+      if (! mapSegment(segment))
+        return false;
+    }
+
+    size_t n = std::min(len, SEGMENT_SIZE - offset);
+
+    memcpy(&segmentMem_[offset], p, n);
+
+    p         += n;
+    len       -= n;
+    dataSize_ += n;
+  }
+
+  return true;
+}
+
+bool
+CQPerfRecordFile::
+mapSegment(size_t segment)
+{
+  unmapSegment();
+
+  off_t offset = off_t(HEADER_SIZE + segment*SEGMENT_SIZE);
+
+  // grow file to hold segment
+  if (ftruncate(fd_, offset + off_t(SEGMENT_SIZE)) != 0) {
+    std::cerr << "Failed to grow record file " << filename_ << "\n";
+    return false;
+  }
+
+  void *mem = mmap(nullptr, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, offset);
+
+  if (mem == MAP_FAILED) {
+    std::cerr << "Failed to map record file " << filename_ << "\n";
+    return false;
+  }
+
+  segmentMem_ = static_cast<uint8_t *>(mem);
+  segment_    = segment;
+
+  return true;
+}
+
+void
+CQPerfRecordFile::
+unmapSegment()
+{
+  if (! segmentMem_)
+    return;
+
+  munmap(segmentMem_, SEGMENT_SIZE);
+
+  segmentMem_ = nullptr;
+}
@@ -0,0 +1,490 @@
+#include <CQPerfRecordReader.h>
+#include <CQPerfTraceEventWriter.h>
+#include <CQPerfCallTree.h>
+
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+// size of SPANS block payload before records (tid, count, base start, min start, max end)
+const size_t SPANS_HEADER_SIZE = 2*sizeof(uint32_t) + 3*sizeof(int64_t);
+
+// min size of INDEX trace entry (id, name length, count, elapsed, min, max, max depth)
+const size_t INDEX_TRACE_SIZE = 2*sizeof(uint32_t) + sizeof(uint64_t) + 3*sizeof(int64_t) +
+                                sizeof(uint32_t);
+
+// size of INDEX block entry (offset, tid, count, min start, max end)
+const size_t INDEX_BLOCK_SIZE = sizeof(uint64_t) + 2*sizeof(uint32_t) + 2*sizeof(int64_t);
+
+template<typename T>
+bool readValue(const uint8_t *&p, const uint8_t *end, T &value) {
+  if (p + sizeof(T) > end)
+    return false;
+
+  memcpy(&value, p, sizeof(T));
+
+  p += sizeof(T);
+
+  return true;
+}
+
+}
+
+//---
+
+CQPerfRecordReader::
+CQPerfRecordReader()
+{
+}
+
+CQPerfRecordReader::
+~CQPerfRecordReader()
+{
+  close();
+}
+
+bool
+CQPerfRecordReader::
+open(const std::string &filename)
+{
+  close();
+
+  fd_ = ::open(filename.c_str(), O_RDONLY);
+
+  if (fd_ < 0) {
+    std::cerr << "Failed to open record file " << filename << "\n";
+    return false;
+  }
+
+  struct stat st;
+
+  if (fstat(fd_, &st) != 0 || size_t(st.st_size) < CQPerfRecordFile::HEADER_SIZE) {
+    std::cerr << "Invalid record file " << filename << "\n";
+    close();
+    return false;
+  }
+
+  memSize_ = size_t(st.st_size);
+
+  void *mem = mmap(nullptr, memSize_, PROT_READ, MAP_SHARED, fd_, 0);
+
+  if (mem == MAP_FAILED) {
+    std::cerr << "Failed to map record file " << filename << "\n";
+    close();
+    return false;
+  }
+
+  mem_ = static_cast<const uint8_t *>(mem);
+
+  //---
+
+  CQPerfRecordFile::Header header;
+
+  memcpy(&header, mem_, sizeof(header));
+
+  if (memcmp(header.magic, CQPerfRecordFile::magic(), sizeof(header.magic)) != 0 ||
+      header.version != CQPerfRecordFile::VERSION ||
+      header.headerSize != CQPerfRecordFile::HEADER_SIZE) {
+    std::cerr << "Invalid record file " << filename << "\n";
+    close();
+    return false;
+  }
+
+  filename_ = filename;
+  pid_      = header.pid;
+
+  // only use complete blocks
+  dataSize_ = std::min(header.dataSize, uint64_t(memSize_ - CQPerfRecordFile::HEADER_SIZE));
+
+  if (header.closed && header.indexOffset)
+    indexed_ = readIndex(header.indexOffset);
+
+  if (! indexed_)
+    scanBlocks();
+
+  //---
+
+  for (const auto &traceInfo : traceInfos_)
+    if (! traceInfo.name.empty())
+      nameIds_[traceInfo.name] = traceInfo.id;
+
+  for (const auto &blockInfo : blockInfos_) {
+    if (&blockInfo == &blockInfos_[0]) {
+      startTime_ = blockInfo.minStart;
+      endTime_   = blockInfo.maxEnd;
+    }
+    else {
+      startTime_ = std::min(startTime_, blockInfo.minStart);
+      endTime_   = std::max(endTime_  , blockInfo.maxEnd  );
+    }
+  }
+
+  return true;
+}
+
+void
+CQPerfRecordReader::
+close()
+{
+  if (mem_)
+    munmap(const_cast<uint8_t *>(mem_), memSize_);
+
+  if (fd_ >= 0)
+    ::close(fd_);
+
+  fd_        = -1;
+  mem_       = nullptr;
+  memSize_   = 0;
+  dataSize_  = 0;
+  pid_       = 0;
+  indexed_   = false;
+  startTime_ = 0;
+  endTime_   = 0;
+
+  filename_.clear();
+
+  traceInfos_.clear();
+  blockInfos_.clear();
+  nameIds_   .clear();
+}
+
+const CQPerfRecordReader::TraceInfo *
+CQPerfRecordReader::
+traceInfo(const std::string &name) const
+{
+  auto p = nameIds_.find(name);
+
+  if (p == nameIds_.end())
+    return nullptr;
+
+  return &traceInfos_[(*p).second];
+}
+
+void
+CQPerfRecordReader::
+spans(uint32_t id, int64_t t1, int64_t t2, Records &records) const
+{
+  for (const auto &blockInfo : blockInfos_) {
+    if (blockInfo.maxEnd < t1 || blockInfo.minStart > t2)
+      continue;
+
+    visitBlock(blockInfo, [&](uint32_t recordId, const Record &record) {
+      if (recordId == id && record.start <= t2 && record.start + record.elapsed >= t1)
+        records.push_back(record);
+    });
+  }
+}
+
+void
+CQPerfRecordReader::
+spans(const Ids &ids, int64_t t1, int64_t t2, TraceRecords &records) const
+{
+  records.clear();
+  records.resize(ids.size());
+
+  auto slots = idSlots(ids);
+
+  for (const auto &blockInfo : blockInfos_) {
+    if (blockInfo.maxEnd < t1 || blockInfo.minStart > t2)
+      continue;
+
+    visitBlock(blockInfo, [&](uint32_t id, const Record &record) {
+      int slot = slots[id];
+
+      if (slot >= 0 && record.start <= t2 && record.start + record.elapsed >= t1)
+        records[size_t(slot)].push_back(record);
+    });
+  }
+}
+
+void
+CQPerfRecordReader::
+binSpans(const Ids &ids, int64_t t1, int64_t t2, uint32_t nb, RangeStats *bins) const
+{
+  if (nb == 0 || t2 <= t1)
+    return;
+
+  auto slots = idSlots(ids);
+
+  double scale = double(nb)/double(t2 - t1);
+
+  for (const auto &blockInfo : blockInfos_) {
+    if (blockInfo.maxEnd < t1 || blockInfo.minStart >= t2)
+      continue;
+
+    visitBlock(blockInfo, [&](uint32_t id, const Record &record) {
+      int slot = slots[id];
+
+      if (slot < 0 || record.start < t1 || record.start >= t2)
+        return;
+
+      auto ib = CQPerfKernels::binIndex(record.start, t1, scale, nb);
+
+      bins[size_t(slot)*nb + ib].add(record.start, record.elapsed);
+    });
+  }
+}
+
+bool
+CQPerfRecordReader::
+exportTraceEvents(const std::string &filename) const
+{
+  CQPerfTraceEventWriter writer;
+
+  if (! writer.open(filename))
+    return false;
+
+  writer.setProcessName(pid_, "CQPerfMonitor");
+
+  std::set<uint32_t> tids;
+
+  for (const auto &blockInfo : blockInfos_)
+    tids.insert(blockInfo.tid);
+
+  for (const auto &tid : tids)
+    writer.setThreadName(pid_, tid, "thread " + std::to_string(tid));
+
+  for (const auto &blockInfo : blockInfos_) {
+    visitBlock(blockInfo, [&](uint32_t id, const Record &record) {
+      if (id < traceInfos_.size() && ! traceInfos_[id].name.empty())
+        writer.addComplete(traceInfos_[id].name, pid_, blockInfo.tid,
+                           record.start, record.elapsed, record.depth);
+      else
+        writer.addComplete("trace " + std::to_string(id), pid_, blockInfo.tid,
+                           record.start, record.elapsed, record.depth);
+    });
+  }
+
+  return writer.close();
+}
+
+void
+CQPerfRecordReader::
+getCallTree(CQPerfCallTree &tree) const
+{
+  tree.clear();
+
+  for (const auto &traceInfo : traceInfos_)
+    if (! traceInfo.name.empty())
+      tree.setName(traceInfo.id, traceInfo.name);
+
+  for (const auto &blockInfo : blockInfos_) {
+    visitBlock(blockInfo, [&](uint32_t id, const Record &record) {
+      tree.addSpan(id, blockInfo.tid, record.start, record.elapsed, record.depth);
+    });
+  }
+
+  tree.build();
+}
+
+bool
+CQPerfRecordReader::
+readIndex(uint64_t offset)
+{
+  CQPerfRecordFile::BlockHeader blockHeader;
+
+  const uint8_t *p = blockData(offset, blockHeader);
+
+  if (! p || blockHeader.type != uint32_t(CQPerfRecordFile::BlockType::INDEX))
+    return false;
+
+  const uint8_t *end = p + blockHeader.size;
+
+  uint32_t numTraces;
+
+  if (! readValue(p, end, numTraces))
+    return false;
+
+  // trace ids are less than number of traces (see CQPerfRecordFile)
+  if (numTraces > size_t(end - p)/INDEX_TRACE_SIZE)
+    return false;
+
+  traceInfos_.resize(numTraces);
+
+  for (uint32_t i = 0; i < numTraces; ++i) {
+    TraceInfo traceInfo;
+    uint32_t  len;
+
+    if (! readValue(p, end, traceInfo.id) || ! readValue(p, end, len) ||
+        traceInfo.id >= numTraces || len > size_t(end - p))
+      return false;
+
+    traceInfo.name = std::string(reinterpret_cast<const char *>(p), len); p += len;
+
+    if (! readValue(p, end, traceInfo.count  ) || ! readValue(p, end, traceInfo.elapsed) ||
+        ! readValue(p, end, traceInfo.min    ) || ! readValue(p, end, traceInfo.max    ) ||
+        ! readValue(p, end, traceInfo.maxDepth))
+      return false;
+
+    addTraceInfo(traceInfo);
+  }
+
+  uint64_t numBlocks;
+
+  if (! readValue(p, end, numBlocks) || numBlocks > uint64_t(end - p)/INDEX_BLOCK_SIZE)
+    return false;
+
+  blockInfos_.reserve(size_t(numBlocks));
+
+  for (uint64_t i = 0; i < numBlocks; ++i) {
+    BlockInfo blockInfo;
+
+    if (! readValue(p, end, blockInfo.offset) || ! readValue(p, end, blockInfo.tid     ) ||
+        ! readValue(p, end, blockInfo.count ) || ! readValue(p, end, blockInfo.minStart) ||
+        ! readValue(p, end, blockInfo.maxEnd))
+      return false;
+
+    blockInfos_.push_back(blockInfo);
+  }
+
+  return true;
+}
+
+void
+CQPerfRecordReader::
+scanBlocks()
+{
+  traceInfos_.clear();
+  blockInfos_.clear();
+
+  uint64_t offset = 0;
+
+  CQPerfRecordFile::BlockHeader blockHeader;
+
+  while (const uint8_t *p = blockData(offset, blockHeader)) {
+    const uint8_t *end = p + blockHeader.size;
+
+    auto type = CQPerfRecordFile::BlockType(blockHeader.type);
+
+    if      (type == CQPerfRecordFile::BlockType::NAME) {
+      TraceInfo traceInfo;
+
+      // ids are assigned in order of NAME blocks so ignore any out of sequence
+      if (readValue(p, end, traceInfo.id) && traceInfo.id <= traceInfos_.size()) {
+        traceInfo.name = std::string(reinterpret_cast<const char *>(p), size_t(end - p));
+
+        addTraceInfo(traceInfo);
+      }
+    }
+    else if (type == CQPerfRecordFile::BlockType::SPANS) {
+      BlockInfo blockInfo;
+
+      int64_t baseStart;
+
+      blockInfo.offset = offset;
+
+      if (readValue(p, end, blockInfo.tid) && readValue(p, end, blockInfo.count   ) &&
+          readValue(p, end, baseStart    ) && readValue(p, end, blockInfo.minStart) &&
+          readValue(p, end, blockInfo.maxEnd))
+        blockInfos_.push_back(blockInfo);
+    }
+
+    offset += sizeof(blockHeader) + blockHeader.size;
+  }
+
+  // no stored summary so calculate from spans
+  for (const auto &blockInfo : blockInfos_) {
+    visitBlock(blockInfo, [&](uint32_t id, const Record &record) {
+      traceInfos_[id].add(record.elapsed, record.depth);
+    });
+  }
+}
+
+void
+CQPerfRecordReader::
+addTraceInfo(const TraceInfo &traceInfo)
+{
+  if (traceInfo.id >= traceInfos_.size())
+    traceInfos_.resize(traceInfo.id + 1);
+
+  traceInfos_[traceInfo.id] = traceInfo;
+}
+
+const uint8_t *
+CQPerfRecordReader::
+blockData(uint64_t offset, CQPerfRecordFile::BlockHeader &blockHeader) const
+{
+  if (offset + sizeof(blockHeader) > dataSize_)
+    return nullptr;
+
+  const uint8_t *p = mem_ + CQPerfRecordFile::HEADER_SIZE + offset;
+
+  memcpy(&blockHeader, p, sizeof(blockHeader));
+
+  if (offset + sizeof(blockHeader) + blockHeader.size > dataSize_)
+    return nullptr;
+
+  return p + sizeof(blockHeader);
+}
+
+std::vector<int>
+CQPerfRecordReader::
+idSlots(const Ids &ids) const
+{
+  std::vector<int> slots(traceInfos_.size(), -1);
+
+  for (size_t i = 0; i < ids.size(); ++i) {
+    if (ids[i] < slots.size())
+      slots[ids[i]] = int(i);
+  }
+
+  return slots;
+}
+
+template<typename VISITOR>
+void
+CQPerfRecordReader::
+visitBlock(const BlockInfo &blockInfo, VISITOR visitor) const
+{
+  CQPerfRecordFile::BlockHeader blockHeader;
+
+  const uint8_t *p = blockData(blockInfo.offset, blockHeader);
+
+  if (! p || blockHeader.type != uint32_t(CQPerfRecordFile::BlockType::SPANS) ||
+      blockHeader.size < SPANS_HEADER_SIZE)
+    return;
+
+  const uint8_t *end = p + blockHeader.size;
+
+  int64_t lastStart;
+
+  memcpy(&lastStart, p + 2*sizeof(uint32_t), sizeof(int64_t));
+
+  p += SPANS_HEADER_SIZE;
+
+  Record record;
+
+  // stop at first record overrunning block (truncated or corrupt)
+  for (uint32_t i = 0; i < blockInfo.count && p < end; ++i) {
+    uint64_t id;
+
+    int n = CQPerfTimeCodec::decodeVarint(p, end, id);
+
+    if (n == 0)
+      break;
+
+    p += n;
+
+    n = CQPerfTimeCodec::decode(p, end, lastStart, record);
+
+    if (n == 0)
+      break;
+
+    p += n;
+
+    lastStart = record.start;
+
+    // skip records of unknown traces
+    if (id >= traceInfos_.size())
+      continue;
+
+    visitor(uint32_t(id), record);
+  }
+}
@@ -0,0 +1,167 @@
+#include <CQPerfRegression.h>
+
+#include <cmath>
+#include <cstdio>
+#include <ostream>
+
+namespace {
+
+std::string changeStr(const char *metric, double base, double value, bool regressed) {
+  char buffer[128];
+
+  double pc = (base > 0 ? 100.0*(value - base)/base : 0.0);
+
+  snprintf(buffer, sizeof(buffer), "%s %.0f -> %.0fus (%+.1f%%)%s", metric, base, value, pc,
+           (regressed ? " *" : ""));
+
+  return buffer;
+}
+
+}
+
+//---
+
+int
+CQPerfRegression::
+compare(const CQPerfSnapshot &baseline, const CQPerfSnapshot &current)
+{
+  results_.clear();
+  missing_.clear();
+  added_  .clear();
+
+  numRegressions_ = 0;
+
+  // compare changes larger than both min delta and threshold ratio
+  auto exceeds = [&](double base, double value, double ratio) {
+    return (value - base >= double(thresholds_.minDelta) && value > base*ratio);
+  };
+
+  for (const auto &btrace : baseline.traces()) {
+    const auto *ctrace = current.trace(btrace.name);
+
+    if (! ctrace) {
+      missing_.push_back(btrace.name);
+      continue;
+    }
+
+    if (int64_t(btrace.stats.count) < thresholds_.minCalls ||
+        int64_t(ctrace->stats.count) < thresholds_.minCalls)
+      continue;
+
+    Result result;
+
+    result.name      = btrace.name;
+    result.baseCalls = btrace.stats.count;
+    result.calls     = ctrace->stats.count;
+    result.baseP50   = btrace.percentile(0.50);
+    result.p50       = ctrace->percentile(0.50);
+    result.baseP99   = btrace.percentile(0.99);
+    result.p99       = ctrace->percentile(0.99);
+    result.baseSelf  = double(btrace.self)/btrace.stats.count;
+    result.self      = double(ctrace->self)/ctrace->stats.count;
+    result.pValue    = pValue(btrace.stats, ctrace->stats);
+
+    // self time has no histogram so uses significance of elapsed slowdown
+    if (result.pValue <= thresholds_.maxPValue) {
+      if (exceeds(double(result.baseP50), double(result.p50), thresholds_.p50Ratio))
+        result.regressed |= METRIC_P50;
+
+      if (exceeds(double(result.baseP99), double(result.p99), thresholds_.p99Ratio))
+        result.regressed |= METRIC_P99;
+
+      if (exceeds(result.baseSelf, result.self, thresholds_.selfRatio))
+        result.regressed |= METRIC_SELF;
+    }
+
+    if (result.regressed)
+      ++numRegressions_;
+
+    results_.push_back(result);
+  }
+
+  for (const auto &ctrace : current.traces()) {
+    if (! baseline.trace(ctrace.name))
+      added_.push_back(ctrace.name);
+  }
+
+  return numRegressions_;
+}
+
+void
+CQPerfRegression::
+report(std::ostream &os, bool verbose) const
+{
+  os << "Regressions: " << numRegressions_ << " of " << results_.size() << " traces";
+
+  if (! missing_.empty() || ! added_.empty())
+    os << " (" << missing_.size() << " missing, " << added_.size() << " new)";
+
+  os << "\n";
+
+  for (const auto &result : results_) {
+    if (! result.regressed && ! verbose)
+      continue;
+
+    char pstr[32];
+
+    snprintf(pstr, sizeof(pstr), "%.2g", result.pValue);
+
+    os << (result.regressed ? "REGRESSED " : "          ") << result.name << "\n";
+
+    os << "  " << changeStr("p50" , double(result.baseP50), double(result.p50),
+                            result.regressed & METRIC_P50) << "\n";
+    os << "  " << changeStr("p99" , double(result.baseP99), double(result.p99),
+                            result.regressed & METRIC_P99) << "\n";
+    os << "  " << changeStr("self", result.baseSelf, result.self,
+                            result.regressed & METRIC_SELF) << "\n";
+    os << "  calls " << result.baseCalls << " -> " << result.calls << ", p=" << pstr << "\n";
+  }
+
+  if (verbose) {
+    for (const auto &name : missing_)
+      os << "MISSING   " << name << "\n";
+
+    for (const auto &name : added_)
+      os << "NEW       " << name << "\n";
+  }
+}
+
+double
+CQPerfRegression::
+pValue(const CQPerfRollup::Totals &a, const CQPerfRollup::Totals &b)
+{
+  double n1 = a.count;
+  double n2 = b.count;
+
+  if (n1 <= 0 || n2 <= 0)
+    return 1.0;
+
+  // U counts (b, a) pairs with b larger (ties count half), values in the same
+  // histogram bucket are treated as ties
+  double u = 0.0, ties = 0.0, below = 0.0;
+
+  for (int i = 0; i < CQPerfRollup::NUM_HIST; ++i) {
+    double ai = a.hist[i];
+    double bi = b.hist[i];
+
+    u += bi*(below + 0.5*ai);
+
+    double t = ai + bi;
+
+    ties += t*t*t - t;
+
+    below += ai;
+  }
+
+  double n = n1 + n2;
+
+  double var = n1*n2/12.0*((n + 1.0) - ties/(n*(n - 1.0)));
+
+  if (var <= 0.0)
+    return 1.0;
+
+  // normal approximation with continuity correction
+  double z = (u - n1*n2/2.0 - 0.5)/std::sqrt(var);
+
+  return 0.5*std::erfc(z/std::sqrt(2.0));
+}
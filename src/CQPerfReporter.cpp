@@ -0,0 +1,207 @@
+#include <CQPerfReporter.h>
+#include <CQPerfMonitor.h>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+const char *csvHeader = "time,interval,trace,count,total_us,self_us,mean_us,"
+                        "p50_us,p90_us,p99_us\n";
+
+void appendJsonString(std::string &line, const std::string &str) {
+  line += '"';
+
+  for (const auto &c : str) {
+    if      (c == '"' ) line += "\\\"";
+    else if (c == '\\') line += "\\\\";
+    else if (c == '\n') line += "\\n";
+    else if (static_cast<unsigned char>(c) < 0x20) {
+      char buffer[8];
+
+      snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+
+      line += buffer;
+    }
+    else
+      line += c;
+  }
+
+  line += '"';
+}
+
+void appendCsvString(std::string &line, const std::string &str) {
+  line += '"';
+
+  for (const auto &c : str) {
+    if (c == '"')
+      line += "\"\"";
+    else
+      line += c;
+  }
+
+  line += '"';
+}
+
+}
+
+//---
+
+CQPerfReporter::
+CQPerfReporter() :
+ worker_(10000000, [this](bool) { report(); }, /*finalCall*/true)
+{
+}
+
+CQPerfReporter::
+~CQPerfReporter()
+{
+  stop();
+
+  std::unique_lock<std::mutex> lock(fileMutex_);
+
+  file_.close();
+}
+
+bool
+CQPerfReporter::
+setFile(const std::string &filename, Format format, size_t maxSize, uint maxFiles)
+{
+  std::unique_lock<std::mutex> lock(fileMutex_);
+
+  format_ = format;
+
+  file_.setHeader(format_ == Format::CSV ? csvHeader : "");
+
+  // lines are written in batches per interval
+  return file_.open(filename, maxSize, maxFiles, 65536);
+}
+
+void
+CQPerfReporter::
+setInterval(int64_t i)
+{
+  worker_.setInterval(i);
+}
+
+void
+CQPerfReporter::
+report()
+{
+  std::unique_lock<std::mutex> lock(fileMutex_);
+
+  CQPerfMonitorInst->getSnapshot(current_);
+
+  current_.delta(snapshot_, delta_);
+
+  std::swap(snapshot_, current_);
+
+  writeLines(delta_);
+}
+
+void
+CQPerfReporter::
+writeDelta(const CQPerfSnapshot &delta)
+{
+  std::unique_lock<std::mutex> lock(fileMutex_);
+
+  writeLines(delta);
+}
+
+void
+CQPerfReporter::
+writeLines(const CQPerfSnapshot &delta)
+{
+  if (! file_.isOpen())
+    return;
+
+  char buffer[256];
+
+  std::string line;
+
+  line.reserve(256);
+
+  // time and interval in seconds
+  double time     = delta.time    ()/1000000.0;
+  double duration = delta.duration()/1000000.0;
+
+  for (const auto &trace : delta.traces()) {
+    // unchanged traces are skipped
+    if (trace.stats.count == 0)
+      continue;
+
+    line.clear();
+
+    long long count = trace.stats.count;
+    long long total = trace.stats.sum;
+    long long self  = trace.self;
+    double    mean  = trace.mean();
+    long long p50   = trace.percentile(0.50);
+    long long p90   = trace.percentile(0.90);
+    long long p99   = trace.percentile(0.99);
+
+    if (format_ == Format::CSV) {
+      snprintf(buffer, sizeof(buffer), "%.6f,%.6f,", time, duration);
+
+      line += buffer;
+
+      appendCsvString(line, trace.name);
+
+      snprintf(buffer, sizeof(buffer), ",%lld,%lld,%lld,%.3f,%lld,%lld,%lld\n",
+               count, total, self, mean, p50, p90, p99);
+
+      line += buffer;
+    }
+    else {
+      snprintf(buffer, sizeof(buffer), "{\"time\":%.6f,\"interval\":%.6f,\"trace\":",
+               time, duration);
+
+      line += buffer;
+
+      appendJsonString(line, trace.name);
+
+      snprintf(buffer, sizeof(buffer), ",\"count\":%lld,\"total\":%lld,\"self\":%lld,"
+               "\"mean\":%.3f,\"p50\":%lld,\"p90\":%lld,\"p99\":%lld}\n",
+               count, total, self, mean, p50, p90, p99);
+
+      line += buffer;
+    }
+
+    file_.write(line.c_str(), line.size());
+  }
+
+  // interval complete on disk
+  file_.flush();
+}
+
+bool
+CQPerfReporter::
+isRunning() const
+{
+  return worker_.isRunning();
+}
+
+void
+CQPerfReporter::
+start()
+{
+  if (worker_.isRunning())
+    return;
+
+  // first report has calls since start
+  {
+    std::unique_lock<std::mutex> fileLock(fileMutex_);
+
+    CQPerfMonitorInst->getSnapshot(snapshot_);
+  }
+
+  // final report on stop covers partial interval
+  worker_.start();
+}
+
+void
+CQPerfReporter::
+stop()
+{
+  worker_.stop();
+}
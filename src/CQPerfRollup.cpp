@@ -0,0 +1,258 @@
+#include <CQPerfRollup.h>
+
+#include <algorithm>
+
+namespace {
+
+// add elapsed to count, sum, min, max and histogram of bucket or totals
+template<typename STATS>
+void addElapsed(STATS &stats, int64_t elapsed) {
+  if (stats.count > 0) {
+    stats.min = std::min(stats.min, elapsed);
+    stats.max = std::max(stats.max, elapsed);
+  }
+  else {
+    stats.min = elapsed;
+    stats.max = elapsed;
+  }
+
+  ++stats.count;
+
+  stats.sum += elapsed;
+
+  ++stats.hist[CQPerfRollup::histIndex(elapsed)];
+}
+
+// estimate elapsed at percentile (0-1) from histogram of bucket or totals
+template<typename STATS>
+int64_t histPercentile(const STATS &stats, double p) {
+  if (stats.count == 0)
+    return 0;
+
+  double target = std::min(std::max(p, 0.0), 1.0)*stats.count;
+
+  uint64_t n = 0;
+
+  for (int i = 0; i < CQPerfRollup::NUM_HIST; ++i) {
+    if (stats.hist[i] == 0)
+      continue;
+
+    if (n + stats.hist[i] >= target) {
+      if (i == 0)
+        return std::max(stats.min, int64_t(0));
+
+      // interpolate in histogram bucket range [2^(i-1), 2^i)
+      int64_t lo = int64_t(1) << (i - 1);
+      int64_t hi = int64_t(1) << i;
+
+      double  f = (target - n)/stats.hist[i];
+      int64_t v = lo + int64_t(f*double(hi - lo));
+
+      return std::min(std::max(v, stats.min), stats.max);
+    }
+
+    n += stats.hist[i];
+  }
+
+  return stats.max;
+}
+
+}
+
+//---
+
+void
+CQPerfRollup::Bucket::
+add(int64_t elapsed)
+{
+  addElapsed(*this, elapsed);
+}
+
+void
+CQPerfRollup::Bucket::
+add(const Bucket &bucket)
+{
+  if (bucket.count == 0)
+    return;
+
+  if (count > 0) {
+    min = std::min(min, bucket.min);
+    max = std::max(max, bucket.max);
+  }
+  else {
+    min = bucket.min;
+    max = bucket.max;
+  }
+
+  count += bucket.count;
+  sum   += bucket.sum;
+
+  for (int i = 0; i < NUM_HIST; ++i)
+    hist[i] += bucket.hist[i];
+}
+
+int64_t
+CQPerfRollup::Bucket::
+percentile(double p) const
+{
+  return histPercentile(*this, p);
+}
+
+//---
+
+void
+CQPerfRollup::Totals::
+add(int64_t elapsed)
+{
+  addElapsed(*this, elapsed);
+}
+
+int64_t
+CQPerfRollup::Totals::
+percentile(double p) const
+{
+  return histPercentile(*this, p);
+}
+
+//---
+
+CQPerfRollup::
+CQPerfRollup(int64_t resolution, uint32_t numBuckets) :
+ resolution_(std::max(resolution, int64_t(1))), numBuckets_(numBuckets)
+{
+}
+
+int64_t
+CQPerfRollup::
+startTime() const
+{
+  int64_t index = std::max(lastIndex_ - int64_t(numBuckets_) + 1, int64_t(0));
+
+  return index*resolution_;
+}
+
+int64_t
+CQPerfRollup::
+endTime() const
+{
+  return (lastIndex_ + 1)*resolution_;
+}
+
+void
+CQPerfRollup::
+add(int64_t start, int64_t elapsed)
+{
+  if (numBuckets_ == 0 || start < 0)
+    return;
+
+  if (buckets_.empty())
+    buckets_.resize(numBuckets_);
+
+  int64_t index = start/resolution_;
+
+  // ignore times older than ring
+  if (lastIndex_ >= 0 && index <= lastIndex_ - int64_t(numBuckets_))
+    return;
+
+  auto &bucket = buckets_[size_t(index % numBuckets_)];
+
+  // recycle stale bucket
+  if (bucket.index != index) {
+    bucket = Bucket();
+
+    bucket.index = index;
+  }
+
+  bucket.add(elapsed);
+
+  lastIndex_ = std::max(lastIndex_, index);
+}
+
+void
+CQPerfRollup::
+reset()
+{
+  buckets_.clear();
+
+  lastIndex_ = -1;
+}
+
+void
+CQPerfRollup::
+details(int64_t t1, int64_t t2, Bucket &bucket) const
+{
+  if (isEmpty() || t2 <= t1)
+    return;
+
+  // each bucket is assigned to the range containing its start so adjacent ranges
+  // never share a bucket
+  int64_t i1 = std::max((t1 + resolution_ - 1)/resolution_, lastIndex_ - int64_t(numBuckets_) + 1);
+  int64_t i2 = std::min((t2 + resolution_ - 1)/resolution_ - 1, lastIndex_);
+
+  for (int64_t i = i1; i <= i2; ++i) {
+    const auto &bucket1 = buckets_[size_t(i % numBuckets_)];
+
+    if (bucket1.index == i)
+      bucket.add(bucket1);
+  }
+}
+
+int
+CQPerfRollup::
+histIndex(int64_t elapsed)
+{
+  int i = 0;
+
+  while (elapsed > 0 && i < NUM_HIST - 1) {
+    elapsed >>= 1;
+
+    ++i;
+  }
+
+  return i;
+}
+
+//---
+
+CQPerfRollups::
+CQPerfRollups(uint32_t numBuckets) :
+ numBuckets_(numBuckets)
+{
+  static int64_t resolutions[] = { 1000, 10000, 100000, 1000000, 10000000, 60000000 };
+
+  for (auto resolution : resolutions)
+    rollups_.emplace_back(resolution, numBuckets_);
+}
+
+void
+CQPerfRollups::
+add(int64_t start, int64_t elapsed)
+{
+  for (auto &rollup : rollups_)
+    rollup.add(start, elapsed);
+}
+
+void
+CQPerfRollups::
+reset()
+{
+  for (auto &rollup : rollups_)
+    rollup.reset();
+}
+
+const CQPerfRollup *
+CQPerfRollups::
+findRollup(int64_t resolution, int64_t t) const
+{
+  const CQPerfRollup *rollup = nullptr;
+
+  for (const auto &rollup1 : rollups_) {
+    if (rollup1.resolution() > resolution)
+      break;
+
+    if (! rollup1.isEmpty() && rollup1.startTime() <= t)
+      rollup = &rollup1;
+  }
+
+  return rollup;
+}
@@ -0,0 +1,137 @@
+#include <CQPerfRotatingFile.h>
+
+#include <algorithm>
+#include <iostream>
+
+CQPerfRotatingFile::
+CQPerfRotatingFile(const std::string &description) :
+ description_(description)
+{
+}
+
+CQPerfRotatingFile::
+~CQPerfRotatingFile()
+{
+  close();
+}
+
+bool
+CQPerfRotatingFile::
+open(const std::string &filename, size_t maxSize, uint maxFiles, size_t bufferSize)
+{
+  close();
+
+  filename_   = filename;
+  maxSize_    = maxSize;
+  maxFiles_   = std::max(maxFiles, 1U);
+  bufferSize_ = bufferSize;
+
+  if (filename_.empty())
+    return true;
+
+  if (! openFile("a")) {
+    filename_.clear();
+    return false;
+  }
+
+  fseek(fp_, 0, SEEK_END);
+
+  size_ = size_t(std::max(ftell(fp_), 0L));
+
+  if (size_ == 0)
+    writeHeader();
+
+  return true;
+}
+
+void
+CQPerfRotatingFile::
+close()
+{
+  if (fp_) {
+    fclose(fp_);
+
+    fp_ = nullptr;
+  }
+
+  size_ = 0;
+}
+
+void
+CQPerfRotatingFile::
+write(const char *data, size_t len)
+{
+  if (isFull(len))
+    rotate();
+
+  if (! fp_)
+    return;
+
+  fwrite(data, 1, len, fp_);
+
+  size_ += len;
+}
+
+void
+CQPerfRotatingFile::
+flush()
+{
+  if (fp_)
+    fflush(fp_);
+}
+
+void
+CQPerfRotatingFile::
+rotate()
+{
+  if (! fp_)
+    return;
+
+  fclose(fp_);
+
+  fp_ = nullptr;
+
+  // file.(n-1) -> file.n, ..., file -> file.1
+  for (uint i = maxFiles_; i > 1; --i) {
+    auto from = filename_ + "." + std::to_string(i - 1);
+    auto to   = filename_ + "." + std::to_string(i);
+
+    std::rename(from.c_str(), to.c_str());
+  }
+
+  std::rename(filename_.c_str(), (filename_ + ".1").c_str());
+
+  size_ = 0;
+
+  if (openFile("w"))
+    writeHeader();
+}
+
+bool
+CQPerfRotatingFile::
+openFile(const char *mode)
+{
+  fp_ = fopen(filename_.c_str(), mode);
+
+  if (! fp_) {
+    std::cerr << "Failed to open " << description_ << " file " << filename_ << "\n";
+    return false;
+  }
+
+  if (bufferSize_ > 0)
+    setvbuf(fp_, nullptr, _IOFBF, bufferSize_);
+
+  return true;
+}
+
+void
+CQPerfRotatingFile::
+writeHeader()
+{
+  if (header_.empty())
+    return;
+
+  fwrite(header_.c_str(), 1, header_.size(), fp_);
+
+  size_ += header_.size();
+}
@@ -0,0 +1,172 @@
+#include <CQPerfSnapshot.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+void
+CQPerfSnapshot::
+sortTraces()
+{
+  std::sort(traces_.begin(), traces_.end(), [](const Trace &lhs, const Trace &rhs) {
+    return lhs.name < rhs.name;
+  });
+}
+
+const CQPerfSnapshot::Trace *
+CQPerfSnapshot::
+trace(const std::string &name) const
+{
+  auto p = std::lower_bound(traces_.begin(), traces_.end(), name,
+    [](const Trace &trace, const std::string &name) { return trace.name < name; });
+
+  if (p == traces_.end() || (*p).name != name)
+    return nullptr;
+
+  return &(*p);
+}
+
+double
+CQPerfSnapshot::
+rate(const Trace &trace) const
+{
+  if (duration_ <= 0)
+    return 0.0;
+
+  return trace.stats.count/(duration_/1000000.0);
+}
+
+void
+CQPerfSnapshot::
+delta(const CQPerfSnapshot &prev, CQPerfSnapshot &delta) const
+{
+  delta.time_     = time_;
+  delta.duration_ = std::max(time_ - prev.time_, int64_t(1));
+
+  delta.traces_.clear();
+
+  delta.traces_.reserve(traces_.size());
+
+  // both trace lists are sorted by name so merge
+  auto p1 = prev.traces_.begin();
+  auto p2 = prev.traces_.end  ();
+
+  for (const auto &trace : traces_) {
+    while (p1 != p2 && (*p1).name < trace.name)
+      ++p1;
+
+    Trace dtrace = trace;
+
+    if (p1 != p2 && (*p1).name == trace.name) {
+      const auto &ptrace = *p1;
+
+      // all calls of trace reset in interval are in interval
+      if (trace.generation == ptrace.generation) {
+        dtrace.stats.count = trace.stats.count - ptrace.stats.count;
+        dtrace.stats.sum   = trace.stats.sum   - ptrace.stats.sum;
+        dtrace.self        = trace.self        - ptrace.self;
+
+        for (int i = 0; i < CQPerfRollup::NUM_HIST; ++i)
+          dtrace.stats.hist[i] = trace.stats.hist[i] - ptrace.stats.hist[i];
+      }
+    }
+
+    delta.traces_.push_back(dtrace);
+  }
+}
+
+// file format:
+//   CQPerfSnapshot <version> <time> <duration>
+//   <count> <sum> <min> <max> <self> <hist 0> ... <hist N-1> <name>
+bool
+CQPerfSnapshot::
+save(const std::string &filename) const
+{
+  std::ofstream os(filename);
+
+  if (! os) {
+    std::cerr << "Failed to write snapshot file " << filename << "\n";
+    return false;
+  }
+
+  os << "CQPerfSnapshot 1 " << time_ << " " << duration_ << "\n";
+
+  for (const auto &trace : traces_) {
+    const auto &stats = trace.stats;
+
+    os << stats.count << " " << stats.sum << " " << stats.min << " " << stats.max << " " <<
+          trace.self;
+
+    for (int i = 0; i < CQPerfRollup::NUM_HIST; ++i)
+      os << " " << stats.hist[i];
+
+    os << " " << trace.name << "\n";
+  }
+
+  return bool(os);
+}
+
+bool
+CQPerfSnapshot::
+load(const std::string &filename)
+{
+  std::ifstream is(filename);
+
+  if (! is) {
+    std::cerr << "Failed to read snapshot file " << filename << "\n";
+    return false;
+  }
+
+  std::string line, id;
+  int         version = 0;
+
+  if (! std::getline(is, line)) {
+    std::cerr << "Invalid snapshot file " << filename << "\n";
+    return false;
+  }
+
+  {
+    std::istringstream ss(line);
+
+    if (! (ss >> id >> version >> time_ >> duration_) || id != "CQPerfSnapshot" ||
+        version != 1) {
+      std::cerr << "Invalid snapshot file " << filename << "\n";
+      return false;
+    }
+  }
+
+  traces_.clear();
+
+  int lineNum = 1;
+
+  while (std::getline(is, line)) {
+    ++lineNum;
+
+    if (line.empty())
+      continue;
+
+    std::istringstream ss(line);
+
+    Trace trace;
+
+    auto &stats = trace.stats;
+
+    ss >> stats.count >> stats.sum >> stats.min >> stats.max >> trace.self;
+
+    for (int i = 0; i < CQPerfRollup::NUM_HIST; ++i)
+      ss >> stats.hist[i];
+
+    // name is rest of line (may contain spaces)
+    if (! ss || ss.get() != ' ' || ! std::getline(ss, trace.name) || trace.name.empty()) {
+      std::cerr << "Invalid snapshot line " << lineNum << " in " << filename << "\n";
+      return false;
+    }
+
+    traces_.push_back(trace);
+  }
+
+  sortTraces();
+
+  return true;
+}
@@ -0,0 +1,355 @@
+#include <CQPerfStatsDEmitter.h>
+#include <CQPerfMonitor.h>
+
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+namespace {
+
+const size_t MAX_LINE = 512;
+
+//! fixed size line buffer (no allocation)
+class LineBuffer {
+ public:
+  LineBuffer() { }
+
+  const char *data() const { return line_; }
+  size_t      len () const { return len_; }
+
+  bool isValid() const { return valid_; }
+
+  void clear() { len_ = 0; valid_ = true; }
+
+  void add(const char *s, size_t n) {
+    if (len_ + n > MAX_LINE) { valid_ = false; return; }
+
+    memcpy(line_ + len_, s, n);
+
+    len_ += n;
+  }
+
+  void add(const char *s) { add(s, strlen(s)); }
+
+  void add(const std::string &s) { add(s.c_str(), s.size()); }
+
+  //! add trace name with separators mapped to '.' and reserved characters to '_'
+  void addName(const std::string &name) {
+    for (size_t i = 0; i < name.size(); ++i) {
+      char c = name[i];
+
+      if      (c == ':' && i + 1 < name.size() && name[i + 1] == ':') {
+        c = '.'; ++i;
+      }
+      else if (c == '/')
+        c = '.';
+      else if (c == ':' || c == '|' || c == '@' || c == '#' ||
+               c == ' ' || c == '\t' || c == '\n')
+        c = '_';
+
+      add(&c, 1);
+    }
+  }
+
+  void addInt(int64_t i) {
+    char buffer[32];
+
+    auto res = std::to_chars(buffer, buffer + sizeof(buffer), i);
+
+    add(buffer, size_t(res.ptr - buffer));
+  }
+
+  void addReal(double r, const char *fmt) {
+    char buffer[32];
+
+    int n = snprintf(buffer, sizeof(buffer), fmt, r);
+
+    add(buffer, size_t(std::max(n, 0)));
+  }
+
+ private:
+  char   line_[MAX_LINE];
+  size_t len_   { 0 };
+  bool   valid_ { true };
+};
+
+}
+
+//---
+
+CQPerfStatsDEmitter::
+CQPerfStatsDEmitter() :
+ worker_(10000000, [this](bool) { flush(); }, /*finalCall*/true)
+{
+}
+
+CQPerfStatsDEmitter::
+~CQPerfStatsDEmitter()
+{
+  stop();
+
+  close();
+}
+
+bool
+CQPerfStatsDEmitter::
+open(const std::string &host, int port)
+{
+  close();
+
+  std::unique_lock<std::mutex> lock(flushMutex_);
+
+  struct addrinfo hints;
+
+  memset(&hints, 0, sizeof(hints));
+
+  hints.ai_family   = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+
+  struct addrinfo *addrs = nullptr;
+
+  auto portStr = std::to_string(port);
+
+  if (getaddrinfo(host.c_str(), portStr.c_str(), &hints, &addrs) != 0 || ! addrs) {
+    std::cerr << "Failed to resolve StatsD host " << host << "\n";
+    return false;
+  }
+
+  fd_ = ::socket(addrs->ai_family, addrs->ai_socktype, addrs->ai_protocol);
+
+  // connect so send() can be used (and errors reported)
+  if (fd_ < 0 || ::connect(fd_, addrs->ai_addr, addrs->ai_addrlen) != 0) {
+    std::cerr << "Failed to open StatsD socket to " << host << ":" << port << "\n";
+
+    if (fd_ >= 0)
+      ::close(fd_);
+
+    fd_ = -1;
+  }
+
+  freeaddrinfo(addrs);
+
+  packetLen_ = 0;
+
+  return (fd_ >= 0);
+}
+
+void
+CQPerfStatsDEmitter::
+close()
+{
+  std::unique_lock<std::mutex> lock(flushMutex_);
+
+  if (fd_ < 0)
+    return;
+
+  ::close(fd_);
+
+  fd_ = -1;
+}
+
+void
+CQPerfStatsDEmitter::
+setPrefix(const std::string &prefix)
+{
+  std::unique_lock<std::mutex> lock(flushMutex_);
+
+  prefix_ = prefix;
+}
+
+void
+CQPerfStatsDEmitter::
+setMaxPacket(size_t n)
+{
+  std::unique_lock<std::mutex> lock(flushMutex_);
+
+  maxPacket_ = std::min(std::max(n, MAX_LINE), MAX_PACKET);
+}
+
+void
+CQPerfStatsDEmitter::
+setInterval(int64_t i)
+{
+  worker_.setInterval(i);
+}
+
+void
+CQPerfStatsDEmitter::
+flush()
+{
+  std::unique_lock<std::mutex> lock(flushMutex_);
+
+  CQPerfMonitorInst->getSnapshot(current_);
+
+  current_.delta(snapshot_, delta_);
+
+  std::swap(snapshot_, current_);
+
+  emitDelta(delta_);
+}
+
+void
+CQPerfStatsDEmitter::
+sendDelta(const CQPerfSnapshot &delta)
+{
+  std::unique_lock<std::mutex> lock(flushMutex_);
+
+  emitDelta(delta);
+}
+
+void
+CQPerfStatsDEmitter::
+emitDelta(const CQPerfSnapshot &delta)
+{
+  if (fd_ < 0)
+    return;
+
+  for (const auto &trace : delta.traces()) {
+    if (trace.stats.count > 0)
+      emitTrace(trace);
+  }
+
+  sendPacket();
+}
+
+void
+CQPerfStatsDEmitter::
+emitTrace(const CQPerfSnapshot::Trace &trace)
+{
+  const auto &stats = trace.stats;
+
+  LineBuffer line;
+
+  auto startLine = [&](const char *metric) {
+    line.clear();
+
+    line.add    (prefix_);
+    line.addName(trace.name);
+    line.add    (metric);
+  };
+
+  auto endLine = [&]() {
+    if (line.isValid())
+      addLine(line.data(), line.len());
+  };
+
+  //---
+
+  // calls and total elapsed (msecs) counters
+  startLine(".calls:");
+  line.addInt(stats.count);
+  line.add   ("|c");
+  endLine();
+
+  startLine(".elapsed:");
+  line.addReal(double(stats.sum)/1000.0, "%.3f");
+  line.add    ("|c");
+  endLine();
+
+  //---
+
+  // elapsed histogram as timers (value sent once per bucket, counted 1/rate times)
+  int nhist = 0;
+
+  for (int i = 0; i < CQPerfRollup::NUM_HIST; ++i) {
+    if (stats.hist[i] > 0)
+      ++nhist;
+  }
+
+  for (int i = 0; i < CQPerfRollup::NUM_HIST; ++i) {
+    uint64_t n = stats.hist[i];
+
+    if (n == 0)
+      continue;
+
+    // single bucket uses exact mean, otherwise middle of bucket range [2^(i-1), 2^i)
+    double value = 0.0;
+
+    if      (nhist == 1)
+      value = stats.mean();
+    else if (i > 0)
+      value = std::min(std::max(0.75*double(int64_t(1) << i), double(stats.min)),
+                       double(stats.max));
+
+    startLine(".time:");
+    line.addReal(value/1000.0, "%.3f");
+    line.add    ("|ms");
+
+    if (n > 1)
+      line.addReal(1.0/n, "|@%.6g");
+
+    endLine();
+  }
+}
+
+void
+CQPerfStatsDEmitter::
+addLine(const char *line, size_t len)
+{
+  // lines are newline separated in packet
+  size_t len1 = (packetLen_ > 0 ? len + 1 : len);
+
+  if (packetLen_ + len1 > maxPacket_)
+    sendPacket();
+
+  if (packetLen_ > 0)
+    packet_[packetLen_++] = '\n';
+
+  memcpy(packet_ + packetLen_, line, len);
+
+  packetLen_ += len;
+}
+
+void
+CQPerfStatsDEmitter::
+sendPacket()
+{
+  if (packetLen_ == 0)
+    return;
+
+  // UDP send failures (no listener) are ignored
+  if (::send(fd_, packet_, packetLen_, MSG_DONTWAIT) == ssize_t(packetLen_)) {
+    ++numPackets_;
+
+    numBytes_ += packetLen_;
+  }
+
+  packetLen_ = 0;
+}
+
+bool
+CQPerfStatsDEmitter::
+isRunning() const
+{
+  return worker_.isRunning();
+}
+
+void
+CQPerfStatsDEmitter::
+start()
+{
+  if (worker_.isRunning())
+    return;
+
+  // first flush sends calls since start
+  {
+    std::unique_lock<std::mutex> flushLock(flushMutex_);
+
+    CQPerfMonitorInst->getSnapshot(snapshot_);
+  }
+
+  // final flush on stop sends remaining calls
+  worker_.start();
+}
+
+void
+CQPerfStatsDEmitter::
+stop()
+{
+  worker_.stop();
+}
@@ -0,0 +1,160 @@
+#include <CQPerfTimeCodec.h>
+
+namespace CQPerfTimeCodec {
+
+namespace {
+
+uint64_t zigzagEncode(int64_t v) {
+  return (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+}
+
+int64_t zigzagDecode(uint64_t v) {
+  return int64_t(v >> 1) ^ -int64_t(v & 1);
+}
+
+void encodeFixed(uint64_t v, int nb, uint8_t *buffer) {
+  for (int i = 0; i < nb; ++i)
+    buffer[i] = uint8_t(v >> (8*i));
+}
+
+uint64_t decodeFixed(const uint8_t *buffer, int nb) {
+  uint64_t v = 0;
+
+  for (int i = 0; i < nb; ++i)
+    v |= uint64_t(buffer[i]) << (8*i);
+
+  return v;
+}
+
+}
+
+//---
+
+int
+encodeVarint(uint64_t v, uint8_t *buffer)
+{
+  int n = 0;
+
+  while (v >= 0x80) {
+    buffer[n++] = uint8_t(v | 0x80);
+
+    v >>= 7;
+  }
+
+  buffer[n++] = uint8_t(v);
+
+  return n;
+}
+
+int
+decodeVarint(const uint8_t *buffer, const uint8_t *end, uint64_t &v)
+{
+  v = 0;
+
+  int n     = 0;
+  int shift = 0;
+
+  while (true) {
+    if (buffer + n >= end)
+      return 0;
+
+    uint8_t c = buffer[n++];
+
+    v |= uint64_t(c & 0x7F) << shift;
+
+    if (! (c & 0x80) || shift >= 63)
+      break;
+
+    shift += 7;
+  }
+
+  return n;
+}
+
+int
+encode(const Record &record, int64_t prevStart, uint8_t *buffer)
+{
+  int n = 0;
+
+  // depth
+  if (record.depth < DEPTH_ESCAPE)
+    buffer[n++] = uint8_t(record.depth);
+  else {
+    buffer[n++] = DEPTH_ESCAPE;
+
+    n += encodeVarint(record.depth, &buffer[n]);
+  }
+
+  // start delta (wraps like decode so any start round trips)
+  n += encodeVarint(zigzagEncode(int64_t(uint64_t(record.start) - uint64_t(prevStart))),
+                    &buffer[n]);
+
+  // elapsed
+  if (record.elapsed >= 0 && record.elapsed < int64_t(ELAPSED_ESCAPE)) {
+    encodeFixed(uint64_t(record.elapsed), 4, &buffer[n]); n += 4;
+  }
+  else {
+    encodeFixed(ELAPSED_ESCAPE, 4, &buffer[n]); n += 4;
+
+    encodeFixed(uint64_t(record.elapsed), 8, &buffer[n]); n += 8;
+  }
+
+  return n;
+}
+
+int
+decode(const uint8_t *buffer, const uint8_t *end, int64_t prevStart, Record &record)
+{
+  if (buffer >= end)
+    return 0;
+
+  int n = 0;
+
+  // depth
+  record.depth = buffer[n++];
+
+  if (record.depth == DEPTH_ESCAPE) {
+    uint64_t depth;
+
+    int n1 = decodeVarint(&buffer[n], end, depth);
+
+    if (n1 == 0)
+      return 0;
+
+    n += n1;
+
+    record.depth = uint32_t(depth);
+  }
+
+  // start delta
+  uint64_t delta;
+
+  int n1 = decodeVarint(&buffer[n], end, delta);
+
+  if (n1 == 0)
+    return 0;
+
+  n += n1;
+
+  // wrap (rather than overflow) on corrupt delta
+  record.start = int64_t(uint64_t(prevStart) + uint64_t(zigzagDecode(delta)));
+
+  // elapsed
+  if (end - &buffer[n] < 4)
+    return 0;
+
+  uint32_t elapsed = uint32_t(decodeFixed(&buffer[n], 4)); n += 4;
+
+  if (elapsed != ELAPSED_ESCAPE)
+    record.elapsed = elapsed;
+  else {
+    if (end - &buffer[n] < 8)
+      return 0;
+
+    record.elapsed = int64_t(decodeFixed(&buffer[n], 8)); n += 8;
+  }
+
+  return n;
+}
+
+}
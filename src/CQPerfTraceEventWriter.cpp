@@ -0,0 +1,151 @@
+#include <CQPerfTraceEventWriter.h>
+
+#include <iostream>
+#include <cinttypes>
+
+CQPerfTraceEventWriter::
+CQPerfTraceEventWriter()
+{
+}
+
+CQPerfTraceEventWriter::
+~CQPerfTraceEventWriter()
+{
+  close();
+}
+
+bool
+CQPerfTraceEventWriter::
+open(const std::string &filename)
+{
+  close();
+
+  fp_ = fopen(filename.c_str(), "w");
+
+  if (! fp_) {
+    std::cerr << "Failed to open trace event file " << filename << "\n";
+    return false;
+  }
+
+  buffer_.resize(BUFFER_SIZE);
+
+  setvbuf(fp_, buffer_.data(), _IOFBF, buffer_.size());
+
+  filename_  = filename;
+  numEvents_ = 0;
+
+  fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", fp_);
+
+  return true;
+}
+
+bool
+CQPerfTraceEventWriter::
+close()
+{
+  if (! fp_)
+    return false;
+
+  fputs("\n]}\n", fp_);
+
+  bool rc = (ferror(fp_) == 0);
+
+  if (fclose(fp_) != 0)
+    rc = false;
+
+  fp_ = nullptr;
+
+  if (! rc)
+    std::cerr << "Failed to write trace event file " << filename_ << "\n";
+
+  return rc;
+}
+
+void
+CQPerfTraceEventWriter::
+setProcessName(uint32_t pid, const std::string &name)
+{
+  if (! fp_)
+    return;
+
+  startEvent();
+
+  fprintf(fp_, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%" PRIu32 ",\"args\":{\"name\":",
+          pid);
+
+  writeString(name);
+
+  fputs("}}", fp_);
+}
+
+void
+CQPerfTraceEventWriter::
+setThreadName(uint32_t pid, uint32_t tid, const std::string &name)
+{
+  if (! fp_)
+    return;
+
+  startEvent();
+
+  fprintf(fp_, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%" PRIu32 ",\"tid\":%" PRIu32
+          ",\"args\":{\"name\":", pid, tid);
+
+  writeString(name);
+
+  fputs("}}", fp_);
+}
+
+void
+CQPerfTraceEventWriter::
+addComplete(const std::string &name, uint32_t pid, uint32_t tid,
+            int64_t start, int64_t elapsed, uint32_t depth)
+{
+  if (! fp_)
+    return;
+
+  startEvent();
+
+  fputs("{\"ph\":\"X\",\"name\":", fp_);
+
+  writeString(name);
+
+  fprintf(fp_, ",\"pid\":%" PRIu32 ",\"tid\":%" PRIu32 ",\"ts\":%" PRId64 ",\"dur\":%" PRId64
+          ",\"args\":{\"depth\":%" PRIu32 "}}", pid, tid, start, elapsed, depth);
+}
+
+void
+CQPerfTraceEventWriter::
+startEvent()
+{
+  // one event per line to keep file diffable
+  fputs(numEvents_ > 0 ? ",\n" : "\n", fp_);
+
+  ++numEvents_;
+}
+
+void
+CQPerfTraceEventWriter::
+writeString(const std::string &str)
+{
+  fputc('"', fp_);
+
+  for (auto c : str) {
+    switch (c) {
+      case '"' : fputs("\\\"", fp_); break;
+      case '\\': fputs("\\\\", fp_); break;
+      case '\n': fputs("\\n" , fp_); break;
+      case '\r': fputs("\\r" , fp_); break;
+      case '\t': fputs("\\t" , fp_); break;
+      default: {
+        if (static_cast<unsigned char>(c) < 0x20)
+          fprintf(fp_, "\\u%04x", static_cast<unsigned char>(c));
+        else
+          fputc(c, fp_);
+
+        break;
+      }
+    }
+  }
+
+  fputc('"', fp_);
+}
@@ -0,0 +1,54 @@
+#ifndef PERF_LOAD_pixmap_H
+#define PERF_LOAD_pixmap_H
+
+#include <CQPixmapCache.h>
+
+class PERF_LOAD_pixmap {
+ private:
+  uchar data_[554] = {
+    0x3c,0x3f,0x78,0x6d,0x6c,0x20,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x3d,0x22,0x31,
+    0x2e,0x30,0x22,0x20,0x65,0x6e,0x63,0x6f,0x64,0x69,0x6e,0x67,0x3d,0x22,0x55,0x54,
+    0x46,0x2d,0x38,0x22,0x20,0x73,0x74,0x61,0x6e,0x64,0x61,0x6c,0x6f,0x6e,0x65,0x3d,
+    0x22,0x6e,0x6f,0x22,0x3f,0x3e,0x0a,0x3c,0x73,0x76,0x67,0x0a,0x20,0x20,0x20,0x78,
+    0x6d,0x6c,0x6e,0x73,0x3d,0x22,0x68,0x74,0x74,0x70,0x3a,0x2f,0x2f,0x77,0x77,0x77,
+    0x2e,0x77,0x33,0x2e,0x6f,0x72,0x67,0x2f,0x32,0x30,0x30,0x30,0x2f,0x73,0x76,0x67,
+    0x22,0x0a,0x20,0x20,0x20,0x77,0x69,0x64,0x74,0x68,0x3d,0x22,0x35,0x35,0x37,0x2e,
+    0x31,0x34,0x32,0x38,0x38,0x22,0x0a,0x20,0x20,0x20,0x68,0x65,0x69,0x67,0x68,0x74,
+    0x3d,0x22,0x35,0x35,0x37,0x2e,0x31,0x34,0x32,0x38,0x38,0x22,0x0a,0x20,0x20,0x20,
+    0x76,0x69,0x65,0x77,0x42,0x6f,0x78,0x3d,0x22,0x30,0x20,0x30,0x20,0x35,0x35,0x37,
+    0x2e,0x31,0x34,0x32,0x38,0x37,0x20,0x35,0x35,0x37,0x2e,0x31,0x34,0x32,0x38,0x37,
+    0x22,0x0a,0x20,0x20,0x20,0x69,0x64,0x3d,0x22,0x73,0x76,0x67,0x32,0x22,0x0a,0x20,
+    0x20,0x20,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x3d,0x22,0x31,0x2e,0x31,0x22,0x3e,
+    0x0a,0x20,0x20,0x3c,0x67,0x0a,0x20,0x20,0x20,0x20,0x20,0x69,0x64,0x3d,0x22,0x6c,
+    0x61,0x79,0x65,0x72,0x31,0x22,0x3e,0x0a,0x20,0x20,0x20,0x20,0x3c,0x70,0x61,0x74,
+    0x68,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x22,
+    0x66,0x69,0x6c,0x6c,0x3a,0x23,0x64,0x61,0x61,0x35,0x32,0x30,0x3b,0x66,0x69,0x6c,
+    0x6c,0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x66,0x69,0x6c,0x6c,
+    0x2d,0x72,0x75,0x6c,0x65,0x3a,0x65,0x76,0x65,0x6e,0x6f,0x64,0x64,0x3b,0x73,0x74,
+    0x72,0x6f,0x6b,0x65,0x3a,0x6e,0x6f,0x6e,0x65,0x22,0x0a,0x20,0x20,0x20,0x20,0x20,
+    0x20,0x20,0x64,0x3d,0x22,0x4d,0x20,0x33,0x30,0x2c,0x31,0x31,0x30,0x20,0x48,0x20,
+    0x32,0x32,0x30,0x20,0x4c,0x20,0x32,0x36,0x30,0x2c,0x31,0x36,0x30,0x20,0x48,0x20,
+    0x35,0x32,0x37,0x20,0x56,0x20,0x34,0x37,0x30,0x20,0x48,0x20,0x33,0x30,0x20,0x5a,
+    0x22,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x64,0x3d,0x22,0x70,0x61,0x74,
+    0x68,0x31,0x22,0x20,0x2f,0x3e,0x0a,0x20,0x20,0x20,0x20,0x3c,0x70,0x61,0x74,0x68,
+    0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x73,0x74,0x79,0x6c,0x65,0x3d,0x22,0x66,
+    0x69,0x6c,0x6c,0x3a,0x23,0x66,0x30,0x63,0x30,0x34,0x30,0x3b,0x66,0x69,0x6c,0x6c,
+    0x2d,0x6f,0x70,0x61,0x63,0x69,0x74,0x79,0x3a,0x31,0x3b,0x66,0x69,0x6c,0x6c,0x2d,
+    0x72,0x75,0x6c,0x65,0x3a,0x65,0x76,0x65,0x6e,0x6f,0x64,0x64,0x3b,0x73,0x74,0x72,
+    0x6f,0x6b,0x65,0x3a,0x6e,0x6f,0x6e,0x65,0x22,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,
+    0x20,0x64,0x3d,0x22,0x4d,0x20,0x33,0x30,0x2c,0x34,0x37,0x30,0x20,0x38,0x35,0x2c,
+    0x32,0x33,0x30,0x20,0x48,0x20,0x35,0x35,0x37,0x20,0x4c,0x20,0x35,0x30,0x32,0x2c,
+    0x34,0x37,0x30,0x20,0x5a,0x22,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x64,
+    0x3d,0x22,0x70,0x61,0x74,0x68,0x32,0x22,0x20,0x2f,0x3e,0x0a,0x20,0x20,0x3c,0x2f,
+    0x67,0x3e,0x0a,0x3c,0x2f,0x73,0x76,0x67,0x3e,0x0a,
+  };
+
+ public:
+  PERF_LOAD_pixmap() {
+    CQPixmapCache::instance()->addData("PERF_LOAD", data_, 554);
+  }
+};
+
+static PERF_LOAD_pixmap s_PERF_LOAD_pixmap;
+
+#endif
@@ -0,0 +1,152 @@
+#include <CQPerfMonitor.h>
+#include <CQPerfAlertEngine.h>
+#include <CQPerfClock.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Alerts = std::vector<CQPerfAlertEngine::Alert>;
+
+const char *traceName = "alert::op";
+
+// run ten calls of elapsed usecs spread over one second of virtual time and evaluate
+// rules at end of second (so window holds only these calls)
+void step(CQPerfVirtualClock &clock, int64_t elapsed) {
+  for (int i = 0; i < 10; ++i) {
+    {
+      CQPerfTrace trace(traceName);
+
+      clock.advance(elapsed);
+    }
+
+    clock.advance(100000 - elapsed);
+  }
+
+  CQPerfMonitorInst->alertEngine()->evaluate(clock.ticks());
+}
+
+CQPerfAlertEngine::Rule meanRule(const std::string &name, double clearThreshold,
+                                 uint debounce, Alerts &alerts) {
+  CQPerfAlertEngine::Rule rule;
+
+  rule.name           = name;
+  rule.trace          = traceName;
+  rule.metric         = CQPerfAlertEngine::Metric::MEAN;
+  rule.window         = 1000000;
+  rule.threshold      = 500;
+  rule.clearThreshold = clearThreshold;
+  rule.debounce       = debounce;
+  rule.actions        = CQPerfAlertEngine::ACTION_CALLBACK | CQPerfAlertEngine::ACTION_RECORD;
+  rule.callback       = [&alerts](const CQPerfAlertEngine::Alert &alert) {
+    alerts.push_back(alert);
+  };
+
+  return rule;
+}
+
+}
+
+//---
+
+// step virtual clock through raise and clear of two recording rules and check
+// debounce, shared recording and that a user recording is never stopped by the engine
+// (exit status 1 on failure)
+int
+main(int, char **)
+{
+  auto *monitor = CQPerfMonitorInst;
+  auto *engine  = monitor->alertEngine();
+
+  // start on a second boundary so each step fills whole rollup buckets
+  CQPerfVirtualClock clock(1000000000);
+
+  monitor->setClock(&clock);
+
+  monitor->setEnabled(true);
+  monitor->setDebug  (false);
+
+  bool ok = true;
+
+  auto check = [&](bool b, const std::string &msg) {
+    if (! b) {
+      std::cerr << "FAIL: " << msg << "\n";
+      ok = false;
+    }
+  };
+
+  // rules are only evaluated by explicit evaluate calls
+  engine->setInterval(3600000000);
+
+  Alerts alerts1, alerts2;
+
+  engine->addRule(meanRule("slow" , 200, 2, alerts1));
+  engine->addRule(meanRule("slow2", 400, 1, alerts2));
+
+  engine->stop();
+
+  //---
+
+  // engine starts recording for first raised rule and stops after last clears
+  step(clock, 1000);
+
+  check(engine->isRaised("slow2") && ! engine->isRaised("slow"), "debounce of raise");
+  check(monitor->isRecording(), "recording not started on raise");
+
+  step(clock, 1000);
+
+  check(engine->isRaised("slow"), "slow not raised");
+
+  step(clock, 300);
+
+  check(! engine->isRaised("slow2") && engine->isRaised("slow"), "clear thresholds");
+  check(monitor->isRecording(), "recording stopped while rule still raised");
+
+  step(clock, 100);
+
+  check(engine->isRaised("slow"), "debounce of clear");
+
+  step(clock, 100);
+
+  check(! engine->isRaised("slow"), "slow not cleared");
+  check(! monitor->isRecording(), "recording not stopped after last clear");
+
+  check(alerts1.size() == 2 && alerts1[0].active && ! alerts1[1].active &&
+        alerts1[0].value == 1000 && alerts1[1].value == 100, "slow alerts");
+  check(alerts2.size() == 2 && alerts2[0].active && ! alerts2[1].active &&
+        alerts2[1].value == 300, "slow2 alerts");
+
+  //---
+
+  // user recording is left running
+  monitor->startRecording();
+
+  step(clock, 1000);
+  step(clock, 1000);
+  step(clock, 100);
+  step(clock, 100);
+
+  check(! engine->isRaised("slow") && ! engine->isRaised("slow2"), "rules not cleared");
+  check(monitor->isRecording(), "user recording stopped by engine");
+
+  monitor->stopRecording();
+
+  //---
+
+  // removing raised rule releases its recording
+  step(clock, 1000);
+
+  check(monitor->isRecording(), "recording not started on raise");
+
+  engine->clearRules();
+
+  check(! monitor->isRecording(), "recording not stopped on clear rules");
+
+  monitor->setClock(nullptr);
+
+  std::cout << (ok ? "ok" : "FAIL") << "\n";
+
+  return (ok ? 0 : 1);
+}
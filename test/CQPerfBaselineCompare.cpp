@@ -0,0 +1,72 @@
+#include <CQPerfRegression.h>
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+// compare snapshot of run against baseline snapshot (see CQPerfMonitor::saveBaseline),
+// exit status is 1 if any trace regressed (2 on error) for use in CI
+int
+main(int argc, char **argv)
+{
+  std::string baselineFile, currentFile;
+  bool        verbose = false;
+
+  CQPerfRegression::Thresholds thresholds;
+
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i][0] == '-') {
+      std::string arg = &argv[i][1];
+
+      auto realArg = [&](double &r) {
+        ++i;
+
+        if (i < argc)
+          r = atof(argv[i]);
+      };
+
+      auto intArg = [&](int64_t &n) {
+        ++i;
+
+        if (i < argc)
+          n = atoll(argv[i]);
+      };
+
+      if      (arg == "p50"      ) realArg(thresholds.p50Ratio);
+      else if (arg == "p99"      ) realArg(thresholds.p99Ratio);
+      else if (arg == "self"     ) realArg(thresholds.selfRatio);
+      else if (arg == "p_value"  ) realArg(thresholds.maxPValue);
+      else if (arg == "min_delta") intArg (thresholds.minDelta);
+      else if (arg == "min_calls") intArg (thresholds.minCalls);
+      else if (arg == "v"        ) verbose = true;
+      else
+        std::cerr << "Invalid arg '" << argv[i] << "'\n";
+    }
+    else if (baselineFile.empty())
+      baselineFile = argv[i];
+    else
+      currentFile = argv[i];
+  }
+
+  if (baselineFile.empty() || currentFile.empty()) {
+    std::cerr << "Usage: CQPerfBaselineCompare <baseline> <current> "
+                 "[-p50 <ratio>] [-p99 <ratio>] [-self <ratio>] [-p_value <p>] "
+                 "[-min_delta <usecs>] [-min_calls <n>] [-v]\n";
+    exit(2);
+  }
+
+  CQPerfSnapshot baseline, current;
+
+  if (! baseline.load(baselineFile) || ! current.load(currentFile))
+    exit(2);
+
+  CQPerfRegression regression;
+
+  regression.setThresholds(thresholds);
+
+  int n = regression.compare(baseline, current);
+
+  regression.report(std::cout, verbose);
+
+  return (n > 0 ? 1 : 0);
+}
@@ -0,0 +1,44 @@
+#include <CQPerfFlightReader.h>
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+// dump last spans from flight recorder file of crashed/hung process
+int
+main(int argc, char **argv)
+{
+  std::string filename;
+  double      secs = 10.0;
+
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i][0] == '-') {
+      std::string arg = &argv[i][1];
+
+      if (arg == "secs") {
+        ++i;
+
+        if (i < argc)
+          secs = atof(argv[i]);
+      }
+      else
+        std::cerr << "Invalid arg '" << argv[i] << "'\n";
+    }
+    else
+      filename = argv[i];
+  }
+
+  if (filename.empty()) {
+    std::cerr << "Usage: CQPerfFlightDump <file> [-secs <secs>]\n";
+    exit(1);
+  }
+
+  CQPerfFlightReader reader;
+
+  if (! reader.open(filename))
+    exit(1);
+
+  reader.dump(std::cout, secs);
+
+  return 0;
+}
@@ -0,0 +1,190 @@
+#include <CQPerfKernels.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using RangeStats = CQPerfKernels::RangeStats;
+using Impl       = CQPerfKernels::Impl;
+using Starts     = std::vector<int64_t>;
+using Elapseds   = std::vector<uint32_t>;
+
+const char *implName(Impl impl) {
+  switch (impl) {
+    case Impl::SCALAR: return "scalar";
+    case Impl::SSE42 : return "sse4.2";
+    case Impl::AVX2  : return "avx2";
+  }
+
+  return "?";
+}
+
+bool equal(const RangeStats &lhs, const RangeStats &rhs) {
+  return lhs.count      == rhs.count      && lhs.sum        == rhs.sum        &&
+         lhs.minStart   == rhs.minStart   && lhs.maxEnd     == rhs.maxEnd     &&
+         lhs.minElapsed == rhs.minElapsed && lhs.maxElapsed == rhs.maxElapsed;
+}
+
+// reference aggregate of entries with start in [t1, t2]
+RangeStats reference(const Starts &starts, const Elapseds &elapseds, int64_t t1, int64_t t2) {
+  RangeStats stats;
+
+  for (size_t i = 0; i < starts.size(); ++i) {
+    if (starts[i] >= t1 && starts[i] <= t2)
+      stats.add(starts[i], int64_t(elapseds[i]));
+  }
+
+  return stats;
+}
+
+}
+
+//---
+
+// compare range and bin kernels of each implementation supported by this CPU with a
+// scalar reference over random columns of all lengths up to the SIMD tails and over
+// extreme values (exit status 1 on failure)
+int
+main(int argc, char **argv)
+{
+  uint32_t seed   = 1;
+  int      rounds = 200;
+
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i][0] == '-') {
+      std::string arg = &argv[i][1];
+
+      ++i;
+
+      if (i >= argc) {
+        std::cerr << "Missing value for '" << arg << "'\n";
+        break;
+      }
+
+      if      (arg == "seed"  ) seed   = uint32_t(atoi(argv[i]));
+      else if (arg == "rounds") rounds = std::max(atoi(argv[i]), 1);
+      else
+        std::cerr << "Invalid arg '-" << arg << "'\n";
+    }
+    else
+      std::cerr << "Invalid arg '" << argv[i] << "'\n";
+  }
+
+  bool ok = true;
+
+  auto fail = [&](const std::string &msg) {
+    std::cerr << "FAIL: " << msg << "\n";
+    ok = false;
+  };
+
+  std::mt19937_64 rng(seed);
+
+  auto randInt = [&](int64_t lo, int64_t hi) {
+    return std::uniform_int_distribution<int64_t>(lo, hi)(rng);
+  };
+
+  Impl bestImpl = CQPerfKernels::impl();
+
+  std::vector<Impl> impls;
+
+  for (auto impl : { Impl::SCALAR, Impl::SSE42, Impl::AVX2 }) {
+    if (impl <= bestImpl)
+      impls.push_back(impl);
+  }
+
+  for (auto impl : impls) {
+    CQPerfKernels::setImpl(impl);
+
+    if (CQPerfKernels::impl() != impl) {
+      fail(std::string("can't select ") + implName(impl));
+      continue;
+    }
+
+    std::string name = implName(impl);
+
+    for (int r = 0; r < rounds; ++r) {
+      // all lengths up to past the widest vector loop and tail, then longer columns
+      uint32_t n = (r < 70 ? uint32_t(r) : uint32_t(randInt(70, 5000)));
+
+      Starts   starts  (n);
+      Elapseds elapseds(n);
+
+      int64_t base = randInt(-1000000, 1000000000000);
+
+      for (uint32_t i = 0; i < n; ++i) {
+        starts  [i] = base + randInt(0, 100000);
+        elapseds[i] = uint32_t(r % 5 == 0 ? randInt(0xFFFFFF00, 0xFFFFFFFE) :
+                                            randInt(0, 100000));
+      }
+
+      // ranges covering all, none, one bound on an entry and random subranges
+      int64_t t1 = base + randInt(0, 100000);
+      int64_t t2 = t1 + randInt(0, 50000);
+
+      if (n > 0 && r % 3 == 0) {
+        t1 = starts[0];
+        t2 = starts[n - 1];
+      }
+
+      std::vector<std::pair<int64_t, int64_t>> ranges = {
+        { INT64_MIN, INT64_MAX }, { base + 200000, base + 300000 }, { t1, t2 }, { t2, t1 }
+      };
+
+      for (const auto &range : ranges) {
+        RangeStats stats;
+
+        CQPerfKernels::rangeStats(starts.data(), elapseds.data(), n,
+                                  range.first, range.second, stats);
+
+        if (! equal(stats, reference(starts, elapseds, range.first, range.second))) {
+          fail(name + " rangeStats n=" + std::to_string(n) + " [" +
+               std::to_string(range.first) + ", " + std::to_string(range.second) + "]");
+          break;
+        }
+      }
+
+      // bins partition [t1, t2) (t2 exclusive)
+      if (t2 > t1) {
+        uint32_t nb = uint32_t(randInt(1, 17));
+
+        std::vector<RangeStats> bins(nb), refBins(nb);
+
+        CQPerfKernels::binStats(starts.data(), elapseds.data(), n, t1, t2, nb, bins.data());
+
+        double scale = double(nb)/double(t2 - t1);
+
+        for (uint32_t i = 0; i < n; ++i) {
+          if (starts[i] >= t1 && starts[i] < t2)
+            refBins[CQPerfKernels::binIndex(starts[i], t1, scale, nb)].
+              add(starts[i], int64_t(elapseds[i]));
+        }
+
+        RangeStats binTotal;
+
+        for (uint32_t ib = 0; ib < nb; ++ib) {
+          if (! equal(bins[ib], refBins[ib]))
+            fail(name + " binStats n=" + std::to_string(n) + " bin " + std::to_string(ib));
+
+          binTotal.add(bins[ib]);
+        }
+
+        if (binTotal.count != reference(starts, elapseds, t1, t2 - 1).count)
+          fail(name + " binStats count n=" + std::to_string(n));
+      }
+    }
+
+    std::cout << name << " checked\n";
+  }
+
+  CQPerfKernels::setImpl(bestImpl);
+
+  std::cout << (ok ? "ok" : "FAIL") << "\n";
+
+  return (ok ? 0 : 1);
+}
@@ -0,0 +1,377 @@
+#include <CQPerfMonitor.h>
+#include <CQPerfMetricsServer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+
+struct Response {
+  std::string status; //!< status line
+  std::string header; //!< header lines
+  std::string body;   //!< body
+};
+
+struct Metrics {
+  int64_t              calls { -1 }; //!< cqperf_calls_total
+  int64_t              count { -1 }; //!< cqperf_elapsed_seconds_count
+  std::vector<int64_t> buckets;      //!< cqperf_elapsed_seconds_bucket (cumulative)
+  std::vector<double>  les;          //!< bucket upper bounds (secs, last +Inf)
+};
+
+using TraceMetrics = std::map<std::string, Metrics>;
+
+// send request to local server and read response until server closes connection
+bool httpRequest(int port, const std::string &request, Response &response) {
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+
+  if (fd < 0)
+    return false;
+
+  struct timeval tv { 5, 0 };
+
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  struct sockaddr_in addr;
+
+  memset(&addr, 0, sizeof(addr));
+
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port        = htons(uint16_t(port));
+
+  if (::connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      ::send(fd, request.c_str(), request.size(), MSG_NOSIGNAL) != ssize_t(request.size())) {
+    ::close(fd);
+    return false;
+  }
+
+  std::string data;
+
+  char buffer[4096];
+
+  for (;;) {
+    auto n = ::recv(fd, buffer, sizeof(buffer), 0);
+
+    if (n < 0) {
+      ::close(fd);
+      return false;
+    }
+
+    if (n == 0)
+      break;
+
+    data.append(buffer, size_t(n));
+  }
+
+  ::close(fd);
+
+  auto pos1 = data.find("\r\n");
+  auto pos2 = data.find("\r\n\r\n");
+
+  if (pos1 == std::string::npos || pos2 == std::string::npos)
+    return false;
+
+  response.status = data.substr(0, pos1);
+  response.header = data.substr(pos1 + 2, pos2 - pos1 - 2);
+  response.body   = data.substr(pos2 + 4);
+
+  return true;
+}
+
+// get trace label value (unescaped) and value of metric line
+bool parseLine(const std::string &line, std::string &name, std::string &trace,
+               int64_t &value) {
+  auto brace = line.find("{trace=\"");
+
+  if (brace == std::string::npos)
+    return false;
+
+  name = line.substr(0, brace);
+
+  trace.clear();
+
+  size_t i = brace + 8;
+
+  for ( ; i < line.size() && line[i] != '"'; ++i) {
+    if (line[i] == '\\' && i + 1 < line.size()) {
+      ++i;
+
+      trace += (line[i] == 'n' ? '\n' : line[i]);
+    }
+    else
+      trace += line[i];
+  }
+
+  auto space = line.rfind(' ');
+
+  if (i >= line.size() || space == std::string::npos || space < i)
+    return false;
+
+  value = atoll(line.c_str() + space + 1);
+
+  return true;
+}
+
+bool parseMetrics(const std::string &body, TraceMetrics &metrics, std::string &msg) {
+  std::istringstream ss(body);
+
+  std::string line, name, trace;
+
+  while (std::getline(ss, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    int64_t value = 0;
+
+    if (! parseLine(line, name, trace, value)) {
+      msg = "bad line '" + line + "'";
+      return false;
+    }
+
+    auto &m = metrics[trace];
+
+    if      (name == "cqperf_calls_total")
+      m.calls = value;
+    else if (name == "cqperf_elapsed_seconds_bucket") {
+      auto pos = line.find("le=\"");
+
+      if (pos == std::string::npos) {
+        msg = "missing le '" + line + "'";
+        return false;
+      }
+
+      m.buckets.push_back(value);
+      m.les    .push_back(atof(line.c_str() + pos + 4));
+    }
+    else if (name == "cqperf_elapsed_seconds_count")
+      m.count = value;
+    else if (name != "cqperf_elapsed_seconds_sum") {
+      msg = "unknown metric '" + line + "'";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// check counts of each trace agree (values of a trace are read coherently even while
+// it is updated)
+bool checkMetrics(const TraceMetrics &metrics, std::string &msg) {
+  for (const auto &tm : metrics) {
+    const auto &m = tm.second;
+
+    if (m.buckets.size() != size_t(CQPerfRollup::NUM_HIST)) {
+      msg = tm.first + " has " + std::to_string(m.buckets.size()) + " buckets";
+      return false;
+    }
+
+    for (size_t i = 1; i < m.buckets.size(); ++i) {
+      if (m.buckets[i] < m.buckets[i - 1]) {
+        msg = tm.first + " buckets not cumulative";
+        return false;
+      }
+
+      if (m.les[i] <= m.les[i - 1]) {
+        msg = tm.first + " bucket bounds not increasing";
+        return false;
+      }
+    }
+
+    if (m.calls != m.count || m.buckets.back() != m.count) {
+      msg = tm.first + " calls " + std::to_string(m.calls) + ", count " +
+            std::to_string(m.count) + ", +Inf bucket " + std::to_string(m.buckets.back());
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void nestTraces(int n) {
+  CQPerfTrace trace("metrics::outer");
+
+  for (int i = 0; i < n; ++i) {
+    CQPerfTrace trace1("metrics::inner \"q\" \\");
+  }
+}
+
+}
+
+//---
+
+// scrape /metrics of local server while traces are updated and check the response
+// and that each trace's counts agree (exit status 1 on failure)
+int
+main(int argc, char **argv)
+{
+  int numScrapes = 20;
+
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i][0] == '-') {
+      std::string arg = &argv[i][1];
+
+      ++i;
+
+      if (i >= argc) {
+        std::cerr << "Missing value for '" << arg << "'\n";
+        break;
+      }
+
+      if (arg == "scrapes")
+        numScrapes = std::max(atoi(argv[i]), 1);
+      else
+        std::cerr << "Invalid arg '-" << arg << "'\n";
+    }
+    else
+      std::cerr << "Invalid arg '" << argv[i] << "'\n";
+  }
+
+  auto *monitor = CQPerfMonitorInst;
+
+  monitor->setEnabled(true);
+  monitor->setDebug  (false);
+
+  for (int i = 0; i < 100; ++i)
+    nestTraces(3);
+
+  // calls of elapsed at bucket boundaries
+  for (int64_t elapsed : { 0, 1, 1023, 1024 }) {
+    CQPerfTimeData timeData;
+
+    timeData.start   = monitor->getTime();
+    timeData.elapsed = CQPerfTimeData::ticksToTime(elapsed);
+
+    monitor->addTrace("metrics::bounds", timeData, CQPerfMonitor::TraceType::ALL);
+  }
+
+  if (! monitor->startMetricsServer(0)) {
+    std::cerr << "Failed to start metrics server\n";
+    exit(1);
+  }
+
+  int port = monitor->metricsServer()->port();
+
+  //---
+
+  bool ok = true;
+
+  auto fail = [&](const std::string &msg) {
+    std::cerr << "FAIL: " << msg << "\n";
+    ok = false;
+  };
+
+  // known counts before concurrent updates
+  Response response;
+
+  if (! httpRequest(port, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n", response))
+    fail("request failed");
+  else {
+    TraceMetrics metrics;
+    std::string  msg;
+
+    if (response.status != "HTTP/1.1 200 OK")
+      fail("status '" + response.status + "'");
+
+    if (response.header.find("Content-Length: " + std::to_string(response.body.size())) ==
+          std::string::npos)
+      fail("content length doesn't match body");
+
+    if (! parseMetrics(response.body, metrics, msg) || ! checkMetrics(metrics, msg))
+      fail(msg);
+
+    if (metrics["metrics::outer"].calls != 100 ||
+        metrics["metrics::inner \"q\" \\"].calls != 300)
+      fail("unexpected calls");
+
+    // each bucket counts calls of elapsed at or below its (le) bound
+    const auto &bounds = metrics["metrics::bounds"];
+
+    for (size_t i = 0; i < bounds.buckets.size(); ++i) {
+      int64_t expected = 0;
+
+      for (double elapsed : { 0.0, 1.0, 1023.0, 1024.0 }) {
+        if (elapsed/1000000.0 <= bounds.les[i]*(1 + 1e-9))
+          ++expected;
+      }
+
+      if (bounds.buckets[i] != expected) {
+        fail("bucket le " + std::to_string(bounds.les[i]) + " has " +
+             std::to_string(bounds.buckets[i]) + " calls, expected " +
+             std::to_string(expected));
+        break;
+      }
+    }
+  }
+
+  //---
+
+  // scrape while another thread adds calls
+  std::atomic<bool> stop { false };
+
+  std::thread thread([&]() {
+    while (! stop)
+      nestTraces(10);
+  });
+
+  for (int i = 0; i < numScrapes; ++i) {
+    Response response1;
+
+    if (! httpRequest(port, "GET /metrics HTTP/1.1\r\n\r\n", response1)) {
+      fail("request failed");
+      break;
+    }
+
+    TraceMetrics metrics;
+    std::string  msg;
+
+    if (! parseMetrics(response1.body, metrics, msg) || ! checkMetrics(metrics, msg)) {
+      fail(msg);
+      break;
+    }
+
+    // all traces are read at one instant so new inner calls (which end before their
+    // outer call) are 10 per new outer call plus those of an unfinished outer call
+    int64_t outer = metrics["metrics::outer"].calls - 100;
+    int64_t inner = metrics["metrics::inner \"q\" \\"].calls - 300;
+
+    if (inner < 10*outer || inner > 10*outer + 10) {
+      fail("inner calls " + std::to_string(inner) + " not at one instant with outer calls " +
+           std::to_string(outer));
+      break;
+    }
+  }
+
+  stop = true;
+
+  thread.join();
+
+  //---
+
+  if (! httpRequest(port, "GET /other HTTP/1.1\r\n\r\n", response) ||
+      response.status != "HTTP/1.1 404 Not Found")
+    fail("unknown path not 404");
+
+  if (! httpRequest(port, "POST /metrics HTTP/1.1\r\n\r\n", response) ||
+      response.status != "HTTP/1.1 405 Method Not Allowed")
+    fail("POST not 405");
+
+  monitor->stopMetricsServer();
+
+  std::cout << (ok ? "ok" : "FAIL") << "\n";
+
+  return (ok ? 0 : 1);
+}
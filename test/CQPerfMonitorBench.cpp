@@ -0,0 +1,292 @@
+#include <CQPerfMonitor.h>
+#include <CMessage.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+  std::string name;               //!< benchmark name
+  std::string paramName;          //!< parameter name (if any)
+  int64_t     param      { 0 };   //!< parameter value
+  int64_t     iterations { 0 };   //!< timed iterations
+  double      nsPerOp    { 0.0 }; //!< nanoseconds per operation
+};
+
+using Results = std::vector<Result>;
+
+// time n calls of f (after short warm up), returns nanoseconds per call
+template<typename FUNC>
+double timeOp(int64_t n, FUNC f) {
+  for (int64_t i = 0; i < std::min(n/10, int64_t(1000)); ++i)
+    f(i);
+
+  auto t1 = Clock::now();
+
+  for (int64_t i = 0; i < n; ++i)
+    f(i);
+
+  auto t2 = Clock::now();
+
+  return std::chrono::duration<double, std::nano>(t2 - t1).count()/double(n);
+}
+
+void addResult(Results &results, const std::string &name, int64_t n, double ns,
+               const std::string &paramName="", int64_t param=0) {
+  Result result;
+
+  result.name       = name;
+  result.paramName  = paramName;
+  result.param      = param;
+  result.iterations = n;
+  result.nsPerOp    = ns;
+
+  results.push_back(result);
+
+  std::cerr << name;
+
+  if (! paramName.empty())
+    std::cerr << " " << paramName << "=" << param;
+
+  std::cerr << ": " << ns << " ns\n";
+}
+
+// trace scope with current monitor state
+double traceScopes(int64_t n, const QString &name) {
+  return timeOp(n, [&](int64_t) { CQPerfTrace trace(name); });
+}
+
+void writeJson(std::ostream &os, const Results &results) {
+  os << "{\n  \"benchmarks\": [\n";
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    const auto &result = results[i];
+
+    char ns[32];
+
+    snprintf(ns, sizeof(ns), "%.3f", result.nsPerOp);
+
+    os << "    {\"name\": \"" << result.name << "\"";
+
+    if (! result.paramName.empty())
+      os << ", \"" << result.paramName << "\": " << result.param;
+
+    os << ", \"iterations\": " << result.iterations << ", \"ns_per_op\": " << ns << "}";
+
+    os << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+
+  os << "  ]\n}\n";
+}
+
+}
+
+//---
+
+// measure cost of monitor hot paths and write results as JSON
+int
+main(int argc, char **argv)
+{
+  int64_t     iterations = 200000;
+  int         maxThreads = 8;
+  std::string output;
+
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i][0] == '-') {
+      std::string arg = &argv[i][1];
+
+      if      (arg == "iterations") {
+        ++i;
+
+        if (i < argc)
+          iterations = std::max(int64_t(atoll(argv[i])), int64_t(100));
+      }
+      else if (arg == "threads") {
+        ++i;
+
+        if (i < argc)
+          maxThreads = std::max(atoi(argv[i]), 1);
+      }
+      else if (arg == "output") {
+        ++i;
+
+        if (i < argc)
+          output = argv[i];
+      }
+      else
+        std::cerr << "Invalid arg '" << argv[i] << "'\n";
+    }
+    else
+      std::cerr << "Invalid arg '" << argv[i] << "'\n";
+  }
+
+  auto *monitor = CQPerfMonitorInst;
+
+  // debug output goes to log file
+  monitor->setLogFile("/dev/null");
+
+  Results results;
+
+  //---
+
+  // CQPerfTrace scope cost by monitor state
+  monitor->setEnabled(false);
+  monitor->setDebug  (false);
+
+  addResult(results, "trace_disabled", iterations,
+            traceScopes(iterations, "bench::disabled"));
+
+  monitor->setEnabled(true);
+
+  addResult(results, "trace_enabled", iterations,
+            traceScopes(iterations, "bench::enabled"));
+
+  monitor->setEnabled(false);
+  monitor->setDebug  (true);
+
+  addResult(results, "trace_debug", iterations,
+            traceScopes(iterations, "bench::debug"));
+
+  monitor->setDebug  (false);
+  monitor->setEnabled(true);
+
+  monitor->startRecording();
+
+  addResult(results, "trace_recording", iterations,
+            traceScopes(iterations, "bench::recording"));
+
+  monitor->stopRecording();
+
+  monitor->resetAll();
+
+  //---
+
+  // enabled trace scopes (same trace) from N threads, ns per scope in each thread
+  for (int nt = 1; nt <= maxThreads; nt *= 2) {
+    std::vector<std::thread> threads;
+
+    auto t1 = Clock::now();
+
+    for (int i = 0; i < nt; ++i) {
+      threads.push_back(std::thread([&]() {
+        QString name("bench::threads");
+
+        for (int64_t j = 0; j < iterations; ++j)
+          CQPerfTrace trace(name);
+      }));
+    }
+
+    for (auto &thread : threads)
+      thread.join();
+
+    auto t2 = Clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(t2 - t1).count()/double(iterations);
+
+    addResult(results, "trace_threads", iterations, ns, "threads", nt);
+
+    monitor->resetAll();
+  }
+
+  //---
+
+  // getTrace lookup by number of registered traces
+  std::vector<QString> names;
+
+  for (int size = 100; size <= 100000; size *= 10) {
+    while (int(names.size()) < size) {
+      names.push_back(QString("bench::registry::trace%1").arg(int(names.size())));
+
+      (void) monitor->getTrace(names.back());
+    }
+
+    // stride through names to defeat caching of recent lookups
+    double ns = timeOp(iterations, [&](int64_t i) {
+      (void) monitor->getTrace(names[size_t((i*7919) % size)]);
+    });
+
+    addResult(results, "get_trace", iterations, ns, "traces", size);
+  }
+
+  //---
+
+  // windowDetails by window size
+  uint windowCount = monitor->windowCount();
+
+  for (int size = 100; size <= 100000; size *= 10) {
+    monitor->setWindowCount(uint(size));
+
+    QString name = QString("bench::window%1").arg(size);
+
+    auto *data = monitor->getTrace(name);
+
+    CQPerfTimeData timeData;
+
+    for (int i = 0; i < size; ++i) {
+      timeData.start   = CQPerfTimeData::ticksToTime(int64_t(i)*100);
+      timeData.elapsed = CQPerfTimeData::ticksToTime(i % 50);
+
+      monitor->addTrace(name, timeData, CQPerfMonitor::TraceType::ALL);
+    }
+
+    int64_t n = std::max(iterations*100/size, int64_t(10));
+
+    double ns = timeOp(n, [&](int64_t) {
+      CQPerfTraceData::WindowData windowData;
+
+      data->windowDetails(windowData);
+    });
+
+    addResult(results, "window_details", n, ns, "window", size);
+  }
+
+  monitor->setWindowCount(windowCount);
+
+  //---
+
+  // client/server message round trip through shared memory
+  {
+    CMessage message("CQ_PERF_MONITOR_BENCH");
+
+    std::string msg;
+    int         errorCode = 0;
+
+    int64_t n = std::max(iterations/10, int64_t(100));
+
+    double ns = timeOp(n, [&](int64_t) {
+      message.sendClientMessage(">bench::message");
+      message.recvClientMessage(msg);
+      message.sendServerMessage("ok");
+      message.recvServerMessage(msg, &errorCode);
+    });
+
+    addResult(results, "message_round_trip", n, ns);
+  }
+
+  //---
+
+  if (output.empty())
+    writeJson(std::cout, results);
+  else {
+    std::ofstream os(output);
+
+    if (! os) {
+      std::cerr << "Failed to write " << output << "\n";
+      exit(1);
+    }
+
+    writeJson(os, results);
+  }
+
+  return 0;
+}
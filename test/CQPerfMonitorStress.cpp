@@ -0,0 +1,322 @@
+#include <CQPerfMonitor.h>
+#include <CQPerfSnapshot.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  int     maxThreads { 8 };      //!< max number of threads
+  int64_t spans      { 100000 }; //!< spans (nested chains) per thread
+  int     depth      { 4 };      //!< nesting depth of span
+  int     shared     { 50 };     //!< percent of spans using shared traces
+  double  rate       { 0.0 };    //!< spans per second per thread (0 for unlimited)
+};
+
+using Names   = std::vector<QString>;
+using Samples = std::vector<float>;
+
+QString traceName(int thread, int level) {
+  if (thread < 0)
+    return QString("stress::shared::L%1").arg(level);
+  else
+    return QString("stress::t%1::L%2").arg(thread).arg(level);
+}
+
+// span i of thread uses shared traces
+bool isSharedSpan(int64_t i, const Options &options) {
+  return (i % 100) < options.shared;
+}
+
+void nestTraces(const Names &names, int level) {
+  CQPerfTrace trace(names[size_t(level)]);
+
+  if (level + 1 < int(names.size()))
+    nestTraces(names, level + 1);
+}
+
+// run spans of one thread, samples are ns per trace scope of each span
+void runThread(int thread, const Options &options, Samples &samples) {
+  Names sharedNames, privateNames;
+
+  for (int l = 0; l < options.depth; ++l) {
+    sharedNames .push_back(traceName(-1    , l));
+    privateNames.push_back(traceName(thread, l));
+  }
+
+  samples.reserve(size_t(options.spans));
+
+  auto start = Clock::now();
+
+  for (int64_t i = 0; i < options.spans; ++i) {
+    if (options.rate > 0.0)
+      std::this_thread::sleep_until(start + std::chrono::duration<double>(i/options.rate));
+
+    const auto &names = (isSharedSpan(i, options) ? sharedNames : privateNames);
+
+    auto t1 = Clock::now();
+
+    nestTraces(names, 0);
+
+    auto t2 = Clock::now();
+
+    samples.push_back(float(std::chrono::duration<double, std::nano>(t2 - t1).count()/
+                            options.depth));
+  }
+}
+
+// check calls add up, nested traces enclose their children and (private) self times are
+// total less child total
+bool checkIntegrity(int nt, const Options &options, std::string &msg) {
+  CQPerfSnapshot snapshot;
+
+  CQPerfMonitorInst->getSnapshot(snapshot);
+
+  int64_t numShared = 0;
+
+  for (int64_t i = 0; i < options.spans; ++i) {
+    if (isSharedSpan(i, options))
+      ++numShared;
+  }
+
+  bool ok = true;
+
+  auto fail = [&](const std::string &str) {
+    if (ok)
+      msg = str;
+
+    ok = false;
+  };
+
+  // self time of trace is total less child total (to within 1us per call for time
+  // rounding and 1% for trace overhead)
+  auto checkSelf = [&](const std::string &name, const CQPerfSnapshot::Trace *trace,
+                       int64_t childSum) {
+    int64_t expected  = trace->stats.sum - childSum;
+    int64_t tolerance = int64_t(trace->stats.count) + trace->stats.sum/100;
+
+    if (std::abs(trace->self - expected) > tolerance)
+      fail(name + " self " + std::to_string(trace->self) + " != " +
+           std::to_string(expected));
+  };
+
+  for (int t = -1; t < nt; ++t) {
+    int64_t expected = (t < 0 ? nt*numShared : options.spans - numShared);
+
+    std::string                  parentName;
+    const CQPerfSnapshot::Trace *parent = nullptr;
+
+    for (int l = 0; l < options.depth; ++l) {
+      auto name = traceName(t, l).toStdString();
+
+      const auto *trace = snapshot.trace(name);
+
+      int64_t calls = (trace ? int64_t(trace->stats.count) : 0);
+
+      if (calls != expected) {
+        fail(name + " calls " + std::to_string(calls) + " != " + std::to_string(expected));
+        parent = nullptr;
+        continue;
+      }
+
+      if (! trace)
+        continue;
+
+      if (trace->self < 0 || trace->self > trace->stats.sum)
+        fail(name + " self time outside [0, total]");
+
+      // private traces are only nested in this thread so parent total includes child
+      // and parent self is the rest (shared trace times are overwritten by concurrent
+      // calls so not checked)
+      if (t >= 0 && parent) {
+        if (trace->stats.sum > parent->stats.sum)
+          fail(name + " total larger than parent");
+
+        checkSelf(parentName, parent, trace->stats.sum);
+      }
+
+      parentName = name;
+      parent     = trace;
+    }
+
+    // innermost private trace has no children
+    if (t >= 0 && parent)
+      checkSelf(parentName, parent, 0);
+  }
+
+  return ok;
+}
+
+// record private spans from nt threads and check recorded depths (number of active
+// traces of the thread when started) are the nesting level whatever the thread count
+bool checkDepths(int nt, const Options &options, std::string &msg) {
+  auto *monitor = CQPerfMonitorInst;
+
+  Options recordOptions = options;
+
+  recordOptions.spans  = std::min(options.spans, int64_t(1000));
+  recordOptions.shared = 0;
+  recordOptions.rate   = 0.0;
+
+  std::vector<Samples>     samples;
+  std::vector<std::thread> threads;
+
+  samples.resize(size_t(nt));
+
+  monitor->startRecording();
+
+  for (int t = 0; t < nt; ++t)
+    threads.push_back(std::thread(runThread, t, std::cref(recordOptions),
+                                  std::ref(samples[size_t(t)])));
+
+  for (auto &thread : threads)
+    thread.join();
+
+  monitor->stopRecording();
+
+  for (int t = 0; t < nt; ++t) {
+    for (int l = 0; l < options.depth; ++l) {
+      auto name = traceName(t, l);
+
+      auto *trace = monitor->getTrace(name);
+
+      uint depth = uint(l + 1);
+
+      int64_t n = 0;
+
+      for (const auto &timeData : trace->recordTimes()) {
+        if (timeData.depth != depth) {
+          msg = name.toStdString() + " depth " + std::to_string(timeData.depth) +
+                " != " + std::to_string(depth);
+          return false;
+        }
+
+        ++n;
+      }
+
+      if (n != recordOptions.spans) {
+        msg = name.toStdString() + " recorded " + std::to_string(n) + " != " +
+              std::to_string(recordOptions.spans);
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+}
+
+//---
+
+// run nested shared/private traces from 1..N threads, report throughput, speedup over
+// one thread, overhead and data integrity (exit status 1 if integrity checks fail)
+int
+main(int argc, char **argv)
+{
+  Options options;
+
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i][0] == '-') {
+      std::string arg = &argv[i][1];
+
+      ++i;
+
+      if (i >= argc) {
+        std::cerr << "Missing value for '" << arg << "'\n";
+        break;
+      }
+
+      if      (arg == "threads") options.maxThreads = std::max(atoi(argv[i]), 1);
+      else if (arg == "spans"  ) options.spans      = std::max(int64_t(atoll(argv[i])), int64_t(1));
+      else if (arg == "depth"  ) options.depth      = std::max(atoi(argv[i]), 1);
+      else if (arg == "shared" ) options.shared     = std::min(std::max(atoi(argv[i]), 0), 100);
+      else if (arg == "rate"   ) options.rate       = std::max(atof(argv[i]), 0.0);
+      else
+        std::cerr << "Invalid arg '-" << arg << "'\n";
+    }
+    else
+      std::cerr << "Invalid arg '" << argv[i] << "'\n";
+  }
+
+  auto *monitor = CQPerfMonitorInst;
+
+  monitor->setEnabled(true);
+  monitor->setDebug  (false);
+
+  printf("%7s %14s %8s %9s %9s  %s\n", "threads", "scopes/sec", "scaling", "p50 ns",
+         "p99 ns", "integrity");
+
+  bool   allOk = true;
+  double rate1 = 0.0;
+
+  for (int nt = 1; nt <= options.maxThreads; nt *= 2) {
+    monitor->resetAll();
+
+    std::vector<Samples>     samples;
+    std::vector<std::thread> threads;
+
+    samples.resize(size_t(nt));
+
+    auto t1 = Clock::now();
+
+    for (int t = 0; t < nt; ++t)
+      threads.push_back(std::thread(runThread, t, std::cref(options),
+                                    std::ref(samples[size_t(t)])));
+
+    for (auto &thread : threads)
+      thread.join();
+
+    auto t2 = Clock::now();
+
+    //---
+
+    double secs = std::chrono::duration<double>(t2 - t1).count();
+
+    double rate = double(nt)*double(options.spans)*options.depth/secs;
+
+    if (nt == 1)
+      rate1 = rate;
+
+    Samples all;
+
+    for (const auto &s : samples)
+      all.insert(all.end(), s.begin(), s.end());
+
+    auto percentile = [&](double p) {
+      auto pos = all.begin() + long(p*double(all.size() - 1));
+
+      std::nth_element(all.begin(), pos, all.end());
+
+      return double(*pos);
+    };
+
+    double p50 = percentile(0.50);
+    double p99 = percentile(0.99);
+
+    std::string msg;
+
+    bool ok = checkIntegrity(nt, options, msg) && checkDepths(nt, options, msg);
+
+    if (! ok)
+      allOk = false;
+
+    std::string status = (ok ? "ok" : "FAIL: " + msg);
+
+    printf("%7d %14.0f %7.2fx %9.1f %9.1f  %s\n", nt, rate, rate/rate1, p50, p99,
+           status.c_str());
+  }
+
+  monitor->resetAll();
+
+  return (allOk ? 0 : 1);
+}
@@ -1,5 +1,6 @@
 #include <CQPerfMonitorTest.h>
 #include <CQPerfMonitor.h>
+#include <CQPerfGraph.h>
 
 #include <CQApp.h>
 #include <QTimer>
@@ -14,6 +15,7 @@ main(int argc, char **argv)
   bool    server = false;
   bool    client = false;
   QString id;
+  QString loadFile;
 
   for (int i = 1; i < argc; ++i) {
     if (argv[i][0] == '-') {
@@ -29,6 +31,12 @@ main(int argc, char **argv)
         if (i < argc)
           id = argv[i];
       }
+      else if (arg == "load") {
+        ++i;
+
+        if (i < argc)
+          loadFile = argv[i];
+      }
       else
         std::cerr << "Invalid option '" << arg << "'\n";
     }
@@ -39,6 +47,22 @@ main(int argc, char **argv)
 
   //---
 
+  // view saved recording
+  if (loadFile != "") {
+    auto *dlg = CQPerfDialog::instance();
+
+    if (! dlg->loadRecording(loadFile))
+      return 1;
+
+    dlg->show();
+
+    app.exec();
+
+    return 0;
+  }
+
+  //---
+
   if      (server) {
     CQPerfMonitorInst->createServer(id);
 
@@ -0,0 +1,170 @@
+#include <CQPerfNameIndex.h>
+
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Names  = std::vector<std::string>;
+using Traces = CQPerfNameIndex::Traces;
+
+// traces are only stored (never dereferenced) by the index so use addresses of dummy
+// entries as trace pointers
+std::vector<char> dummies(1000);
+
+CQPerfTraceData *tracePtr(size_t i) {
+  return reinterpret_cast<CQPerfTraceData *>(&dummies[i]);
+}
+
+}
+
+//---
+
+// check name splitting, prefix queries against a scan of all names (for whole and
+// partial segments), subtree stats and stats reset (exit status 1 on failure)
+int
+main(int, char **)
+{
+  bool ok = true;
+
+  auto fail = [&](const std::string &msg) {
+    std::cerr << "FAIL: " << msg << "\n";
+    ok = false;
+  };
+
+  //---
+
+  // segments keep trailing separator, single ':' is not a separator
+  std::vector<std::string> keys;
+
+  CQPerfNameIndex::splitName("Widget::draw/paint:x::", keys);
+
+  if (keys != std::vector<std::string>({ "Widget::", "draw/", "paint:x::" }))
+    fail("split name");
+
+  // nodes are only found for whole segments or trace names
+  CQPerfNameIndex index1;
+
+  auto *drawNode = index1.add("Widget::draw", tracePtr(0));
+
+  if (index1.findNode("Widget::draw") != drawNode || ! index1.findNode("Widget::") ||
+      index1.findNode("Widget:") || index1.findNode("Widget::dr"))
+    fail("find node");
+
+  //---
+
+  // random names from segments which share string prefixes across separators
+  std::mt19937 rng(1);
+
+  const Names segments = { "A", "Ab", "B", "::", "/", ":", "x" };
+
+  Names names;
+
+  std::set<std::string> nameSet;
+
+  while (names.size() < dummies.size()) {
+    std::string name;
+
+    int ns = 1 + int(rng() % 6);
+
+    for (int s = 0; s < ns; ++s)
+      name += segments[rng() % segments.size()];
+
+    if (nameSet.insert(name).second)
+      names.push_back(name);
+  }
+
+  CQPerfNameIndex index;
+
+  std::vector<CQPerfNameIndex::Node *> nodes;
+
+  for (size_t i = 0; i < names.size(); ++i)
+    nodes.push_back(index.add(names[i], tracePtr(i)));
+
+  // adding existing name returns same node
+  if (index.add(names[0], tracePtr(0)) != nodes[0])
+    fail("add existing name");
+
+  // prefix query returns same traces as scan of names (all prefixes of names plus
+  // some which match nothing)
+  Names prefixes = { "", "zzz", "A:::", "::/" };
+
+  for (const auto &name : names) {
+    for (size_t len = 1; len <= name.size(); ++len)
+      prefixes.push_back(name.substr(0, len));
+  }
+
+  for (const auto &prefix : prefixes) {
+    Traces traces;
+
+    index.getTraces(prefix, traces);
+
+    std::set<CQPerfTraceData *> traceSet(traces.begin(), traces.end());
+
+    if (traceSet.size() != traces.size()) {
+      fail("duplicate traces for '" + prefix + "'");
+      continue;
+    }
+
+    std::set<CQPerfTraceData *> expected;
+
+    for (size_t i = 0; i < names.size(); ++i) {
+      if (names[i].compare(0, prefix.size(), prefix) == 0)
+        expected.insert(tracePtr(i));
+    }
+
+    if (traceSet != expected) {
+      fail("prefix '" + prefix + "' " + std::to_string(traces.size()) + " traces != " +
+           std::to_string(expected.size()));
+      break;
+    }
+  }
+
+  //---
+
+  // subtree stats of whole segment prefix are totals of names under it
+  for (size_t i = 0; i < names.size(); ++i)
+    CQPerfNameIndex::addStats(nodes[i], 1, int64_t(i));
+
+  auto checkStats = [&](const std::string &prefix, const std::string &msg) {
+    const auto *node = index.findNode(prefix);
+
+    int64_t calls = 0, elapsed = 0;
+
+    for (size_t i = 0; i < names.size(); ++i) {
+      if (names[i].compare(0, prefix.size(), prefix) == 0 && nodes[i]->selfCalls > 0) {
+        ++calls;
+
+        elapsed += int64_t(i);
+      }
+    }
+
+    if (! node || node->calls != calls || node->elapsed != elapsed)
+      fail(msg + " stats of '" + prefix + "'");
+  };
+
+  checkStats(""   , "root");
+  checkStats("A::", "segment");
+  checkStats("B/" , "segment");
+
+  if (index.root()->calls != int64_t(names.size()))
+    fail("root calls");
+
+  if (index.findNode("zzz::"))
+    fail("missing node found");
+
+  // reset removes trace stats from ancestors
+  for (size_t i = 0; i < names.size(); i += 2)
+    CQPerfNameIndex::resetStats(nodes[i]);
+
+  checkStats(""   , "reset root");
+  checkStats("A::", "reset segment");
+  checkStats("B/" , "reset segment");
+
+  std::cout << (ok ? "ok" : "FAIL") << "\n";
+
+  return (ok ? 0 : 1);
+}
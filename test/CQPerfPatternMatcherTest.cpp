@@ -0,0 +1,194 @@
+#include <CQPerfPatternMatcher.h>
+
+#include <fnmatch.h>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Case {
+  const char *patterns;
+  const char *name;
+  bool        match;
+};
+
+// patterns are '|' separated alternatives
+const Case cases[] = {
+  { ""               , ""              , false },
+  { ""               , "a"             , false },
+  { "*"              , ""              , true  },
+  { "*"              , "any::name"     , true  },
+  { "abc"            , "abc"           , true  },
+  { "abc"            , "abcd"          , false },
+  { "abc"            , "ab"            , false },
+  { "a?c"            , "abc"           , true  },
+  { "a?c"            , "ac"            , false },
+  { "net::*"         , "net::read"     , true  },
+  { "net::*"         , "disk::read"    , false },
+  { "*::read"        , "disk::read"    , true  },
+  { "*::read"        , "disk::reader"  , false },
+  { "a**b"           , "ab"            , true  },
+  { "*a*a*"          , "banana"        , true  },
+  { "*a*a*a*a*"      , "banana"        , false },
+  { "[abc]x"         , "bx"            , true  },
+  { "[abc]x"         , "dx"            , false },
+  { "[!abc]x"        , "dx"            , true  },
+  { "[^abc]x"        , "ax"            , false },
+  { "[a-c]"          , "b"             , true  },
+  { "[a-c]"          , "-"             , false },
+  { "[a-]"           , "-"             , true  },
+  { "[]]"            , "]"             , true  },
+  { "[!]]"           , "a"             , true  },
+  { "[ab"            , "[ab"           , true  },
+  { "\\*"            , "*"             , true  },
+  { "\\*"            , "a"             , false },
+  { "a\\?"           , "a?"            , true  },
+  { "a\\?"           , "ab"            , false },
+  { "net::*|disk::*" , "disk::write"   , true  },
+  { "net::*|disk::*" , "cpu::work"     , false },
+  { "|net::*|"       , "net::x"        , true  },
+  { "x|*y"           , "xy"            , true  },
+  { "x|*y"           , "x"             , true  },
+  { "x|*y"           , "xz"            , false },
+};
+
+// reference: any alternative matches with fnmatch
+bool fnmatchAny(const std::string &patterns, const std::string &name) {
+  std::string::size_type i = 0;
+
+  while (i <= patterns.size()) {
+    auto j = patterns.find('|', i);
+
+    if (j == std::string::npos)
+      j = patterns.size();
+
+    if (j > i && fnmatch(patterns.substr(i, j - i).c_str(), name.c_str(), 0) == 0)
+      return true;
+
+    i = j + 1;
+  }
+
+  return false;
+}
+
+}
+
+//---
+
+// check wildcard, class, escape and alternative matching against expected results and
+// random pattern sets against fnmatch, then match from several threads while the DFA
+// is built (exit status 1 on failure)
+int
+main(int, char **)
+{
+  bool ok = true;
+
+  auto fail = [&](const std::string &msg) {
+    std::cerr << "FAIL: " << msg << "\n";
+    ok = false;
+  };
+
+  for (const auto &c : cases) {
+    CQPerfPatternMatcher matcher(c.patterns);
+
+    if (matcher.match(c.name) != c.match)
+      fail(std::string("'") + c.patterns + "' match '" + c.name + "' != " +
+           (c.match ? "true" : "false"));
+  }
+
+  CQPerfPatternMatcher matcher;
+
+  if (! matcher.isEmpty() || matcher.match(""))
+    fail("default matcher not empty");
+
+  matcher.setPatterns("a*");
+
+  if (matcher.isEmpty() || ! matcher.match("ab"))
+    fail("set patterns");
+
+  matcher.setPatterns("b*");
+
+  if (matcher.match("ab") || ! matcher.match("ba"))
+    fail("reset patterns");
+
+  //---
+
+  // random pattern sets over small alphabet compared with fnmatch
+  std::mt19937 rng(1);
+
+  const std::vector<std::string> atoms = {
+    "a", "b", "c", "*", "?", "[ab]", "[!a]", "[a-b]", ":"
+  };
+
+  auto randInt = [&](int n) { return int(rng() % uint32_t(n)); };
+
+  for (int r = 0; r < 2000; ++r) {
+    std::string patterns;
+
+    int np = 1 + randInt(3);
+
+    for (int p = 0; p < np; ++p) {
+      if (p > 0)
+        patterns += "|";
+
+      int na = randInt(6);
+
+      for (int a = 0; a < na; ++a)
+        patterns += atoms[size_t(randInt(int(atoms.size())))];
+    }
+
+    CQPerfPatternMatcher matcher1(patterns);
+
+    for (int k = 0; k < 20; ++k) {
+      std::string name;
+
+      int nc = randInt(7);
+
+      for (int c = 0; c < nc; ++c)
+        name += "abc:"[randInt(4)];
+
+      if (matcher1.match(name) != fnmatchAny(patterns, name)) {
+        fail("'" + patterns + "' match '" + name + "' differs from fnmatch");
+        break;
+      }
+    }
+  }
+
+  //---
+
+  // concurrent matches build shared DFA states
+  CQPerfPatternMatcher shared("*::read*|net::*|[a-m]*::write");
+
+  std::vector<std::thread> threads;
+  std::vector<int>         errors(8);
+
+  for (int t = 0; t < 8; ++t) {
+    threads.push_back(std::thread([&shared, &errors, t]() {
+      for (int i = 0; i < 10000; ++i) {
+        std::string name = std::string(1, char('a' + (i + t) % 26)) + "::" +
+                           (i % 3 == 0 ? "read" : i % 3 == 1 ? "write" : "other") +
+                           std::to_string(i % 7);
+
+        bool expected = fnmatchAny(shared.patterns(), name);
+
+        if (shared.match(name) != expected)
+          ++errors[size_t(t)];
+      }
+    }));
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+
+  for (auto n : errors) {
+    if (n > 0)
+      fail("concurrent match errors " + std::to_string(n));
+  }
+
+  std::cout << (ok ? "ok" : "FAIL") << "\n";
+
+  return (ok ? 0 : 1);
+}
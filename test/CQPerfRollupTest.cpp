@@ -0,0 +1,152 @@
+#include <CQPerfRollup.h>
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace {
+
+CQPerfRollup::Bucket details(const CQPerfRollup &rollup, int64_t t1, int64_t t2) {
+  CQPerfRollup::Bucket bucket;
+
+  rollup.details(t1, t2, bucket);
+
+  return bucket;
+}
+
+}
+
+//---
+
+// check histogram indices, bucket merge and percentiles, bucket rotation of a rollup
+// ring and rollup selection by resolution (exit status 1 on failure)
+int
+main(int, char **)
+{
+  bool ok = true;
+
+  auto check = [&](bool b, const std::string &msg) {
+    if (! b) {
+      std::cerr << "FAIL: " << msg << "\n";
+      ok = false;
+    }
+  };
+
+  //---
+
+  // histogram bucket i holds [2^(i-1), 2^i)
+  check(CQPerfRollup::histIndex(0) == 0, "histIndex(0)");
+  check(CQPerfRollup::histIndex(1) == 1, "histIndex(1)");
+  check(CQPerfRollup::histIndex(2) == 2 && CQPerfRollup::histIndex(3) == 2,
+        "histIndex(2, 3)");
+  check(CQPerfRollup::histIndex(1023) == 10 && CQPerfRollup::histIndex(1024) == 11,
+        "histIndex(1023, 1024)");
+  check(CQPerfRollup::histIndex(INT64_MAX) == CQPerfRollup::NUM_HIST - 1, "histIndex(max)");
+
+  //---
+
+  // merged buckets keep count, sum, min, max and histogram
+  CQPerfRollup::Bucket bucket1, bucket2;
+
+  for (int i = 0; i < 100; ++i)
+    bucket1.add(100);
+
+  bucket2.add(3);
+  bucket2.add(5000);
+
+  bucket1.add(bucket2);
+
+  check(bucket1.count == 102 && bucket1.sum == 10000 + 5003 &&
+        bucket1.min == 3 && bucket1.max == 5000, "bucket merge");
+  check(bucket1.hist[CQPerfRollup::histIndex(100)] == 100, "bucket merge histogram");
+
+  // percentiles are interpolated in histogram range and clamped to min/max
+  check(bucket1.percentile(0.5) >= 64 && bucket1.percentile(0.5) < 128, "p50 range");
+  check(bucket1.percentile(0.0) == 3 && bucket1.percentile(1.0) == 5000, "p0/p100 clamp");
+  check(CQPerfRollup::Bucket().percentile(0.5) == 0, "empty bucket percentile");
+
+  CQPerfRollup::Totals totals;
+
+  totals.add(10);
+  totals.add(30);
+
+  check(totals.count == 2 && totals.mean() == 20.0 && totals.min == 10 && totals.max == 30,
+        "totals");
+
+  //---
+
+  // four 1ms buckets
+  CQPerfRollup rollup(1000, 4);
+
+  check(rollup.isEmpty() && details(rollup, 0, 10000).count == 0, "new rollup not empty");
+
+  rollup.add( 500, 10);
+  rollup.add(1500, 20);
+  rollup.add(2500, 30);
+  rollup.add(3500, 40);
+
+  check(rollup.startTime() == 0 && rollup.endTime() == 4000, "ring time range");
+
+  auto bucket = details(rollup, 0, 4000);
+
+  check(bucket.count == 4 && bucket.sum == 100 && bucket.min == 10 && bucket.max == 40,
+        "ring details");
+
+  // range uses buckets starting in [t1, t2)
+  bucket = details(rollup, 1000, 3000);
+
+  check(bucket.count == 2 && bucket.sum == 50, "details range");
+
+  bucket = details(rollup, 1001, 3000);
+
+  check(bucket.count == 1 && bucket.sum == 30, "details partial bucket start");
+
+  // newer bucket recycles oldest slot
+  rollup.add(4500, 50);
+
+  check(rollup.startTime() == 1000 && rollup.endTime() == 5000, "rotated time range");
+
+  bucket = details(rollup, 0, 5000);
+
+  check(bucket.count == 4 && bucket.sum == 140 && bucket.min == 20, "rotated details");
+
+  // times older than ring are ignored, times still in ring are added to their bucket
+  rollup.add(800, 99);
+  rollup.add(1200, 5);
+
+  bucket = details(rollup, 0, 5000);
+
+  check(bucket.count == 5 && bucket.sum == 145 && bucket.min == 5 && bucket.max == 50,
+        "late adds");
+
+  // jump past ring leaves only new bucket (stale slots are skipped)
+  rollup.add(100500, 7);
+
+  bucket = details(rollup, 0, 200000);
+
+  check(bucket.count == 1 && bucket.sum == 7, "stale buckets merged");
+
+  rollup.reset();
+
+  check(rollup.isEmpty(), "reset rollup not empty");
+
+  //---
+
+  // coarsest rollup no finer than resolution which still holds time
+  CQPerfRollups rollups(4);
+
+  rollups.add(   0, 1);
+  rollups.add(5000, 2);
+
+  const auto *rollup1 = rollups.findRollup(1000, 0);
+  const auto *rollup2 = rollups.findRollup(1000, 3000);
+  const auto *rollup3 = rollups.findRollup(50000, 0);
+
+  check(! rollup1, "evicted 1ms rollup found");
+  check(rollup2 && rollup2->resolution() == 1000, "1ms rollup not found");
+  check(rollup3 && rollup3->resolution() == 10000, "10ms rollup not found");
+
+  std::cout << (ok ? "ok" : "FAIL") << "\n";
+
+  return (ok ? 0 : 1);
+}
@@ -0,0 +1,285 @@
+#include <CQPerfStatsDEmitter.h>
+#include <CQPerfSnapshot.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+
+struct Counts {
+  int64_t calls   { -1 };  //!< calls counter
+  double  samples { 0.0 }; //!< timer samples (sum of 1/rate)
+};
+
+using TraceCounts = std::map<std::string, Counts>;
+
+// open UDP socket on free local port
+int openListener(int &port) {
+  int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+
+  if (fd < 0)
+    return -1;
+
+  struct sockaddr_in addr;
+
+  memset(&addr, 0, sizeof(addr));
+
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port        = 0;
+
+  socklen_t len = sizeof(addr);
+
+  if (::bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      ::getsockname(fd, reinterpret_cast<struct sockaddr *>(&addr), &len) != 0) {
+    ::close(fd);
+    return -1;
+  }
+
+  port = ntohs(addr.sin_port);
+
+  // queue all packets of delta and don't wait forever for a lost one
+  int rcvbuf = 4*1024*1024;
+
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+  struct timeval tv { 1, 0 };
+
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  return fd;
+}
+
+// parse "<prefix><name>.<metric>:<value>|<type>[|@<rate>]" line
+bool parseLine(const std::string &line, const std::string &prefix, TraceCounts &counts,
+               std::string &msg) {
+  auto colon = line.find(':');
+  auto bar   = line.find('|');
+
+  if (colon == std::string::npos || bar == std::string::npos || bar < colon ||
+      line.find(':', colon + 1) != std::string::npos) {
+    msg = "bad line '" + line + "'";
+    return false;
+  }
+
+  auto metric = line.substr(0, colon);
+  auto value  = line.substr(colon + 1, bar - colon - 1);
+  auto type   = line.substr(bar + 1);
+
+  if (metric.compare(0, prefix.size(), prefix) != 0) {
+    msg = "missing prefix '" + line + "'";
+    return false;
+  }
+
+  auto dot = metric.rfind('.');
+
+  auto name = metric.substr(prefix.size(), dot - prefix.size());
+  auto kind = metric.substr(dot + 1);
+
+  auto &c = counts[name];
+
+  if      (kind == "calls" && type == "c")
+    c.calls = atoll(value.c_str());
+  else if (kind == "elapsed" && type == "c")
+    ;
+  else if (kind == "time" && type.compare(0, 2, "ms") == 0) {
+    double rate = 1.0;
+
+    auto at = type.find("|@");
+
+    if (at != std::string::npos)
+      rate = atof(type.c_str() + at + 2);
+
+    c.samples += 1.0/rate;
+  }
+  else {
+    msg = "bad metric '" + line + "'";
+    return false;
+  }
+
+  return true;
+}
+
+// name as mapped by emitter
+std::string statsDName(int i) {
+  return "statsd.test.t" + std::to_string(i) + "_a_b";
+}
+
+}
+
+//---
+
+// send delta snapshot to local UDP listener and check packet sizes and that the
+// received counters and timer samples match the delta (exit status 1 on failure)
+int
+main(int argc, char **argv)
+{
+  int    numTraces = 200;
+  size_t maxPacket = 600;
+
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i][0] == '-') {
+      std::string arg = &argv[i][1];
+
+      ++i;
+
+      if (i >= argc) {
+        std::cerr << "Missing value for '" << arg << "'\n";
+        break;
+      }
+
+      if      (arg == "traces") numTraces = std::max(atoi(argv[i]), 1);
+      else if (arg == "packet") maxPacket = size_t(std::max(atoi(argv[i]), 1));
+      else
+        std::cerr << "Invalid arg '-" << arg << "'\n";
+    }
+    else
+      std::cerr << "Invalid arg '" << argv[i] << "'\n";
+  }
+
+  int port = 0;
+
+  int fd = openListener(port);
+
+  if (fd < 0) {
+    std::cerr << "Failed to open UDP listener\n";
+    exit(1);
+  }
+
+  //---
+
+  // traces with names needing mapping, spread of elapsed over several log2 buckets
+  // and one trace not called
+  CQPerfSnapshot delta;
+
+  for (int i = 0; i < numTraces; ++i) {
+    CQPerfSnapshot::Trace trace;
+
+    trace.name = "statsd::test/t" + std::to_string(i) + " a|b";
+    trace.id   = uint32_t(i);
+
+    int n = (i == 1 ? 0 : i % 7 + 1);
+
+    for (int j = 0; j < n; ++j)
+      trace.stats.add(int64_t(1) << ((i + 3*j) % 16));
+
+    delta.addTrace(trace);
+  }
+
+  delta.sortTraces();
+
+  //---
+
+  CQPerfStatsDEmitter emitter;
+
+  emitter.setPrefix   ("test.");
+  emitter.setMaxPacket(maxPacket);
+
+  if (! emitter.open("127.0.0.1", port))
+    exit(1);
+
+  emitter.sendDelta(delta);
+
+  //---
+
+  bool ok = true;
+
+  auto fail = [&](const std::string &msg) {
+    std::cerr << "FAIL: " << msg << "\n";
+    ok = false;
+  };
+
+  TraceCounts counts;
+
+  uint64_t numPackets = 0, numBytes = 0;
+
+  std::vector<char> buffer(CQPerfStatsDEmitter::MAX_PACKET + 1);
+
+  while (numPackets < emitter.numPackets()) {
+    auto len = ::recv(fd, &buffer[0], buffer.size(), 0);
+
+    if (len <= 0) {
+      fail("missing packets");
+      break;
+    }
+
+    ++numPackets;
+
+    numBytes += uint64_t(len);
+
+    if (size_t(len) > emitter.maxPacket())
+      fail("packet of " + std::to_string(len) + " bytes larger than " +
+           std::to_string(emitter.maxPacket()));
+
+    std::string packet(&buffer[0], size_t(len));
+
+    size_t pos = 0;
+
+    while (pos <= packet.size()) {
+      auto end = packet.find('\n', pos);
+
+      if (end == std::string::npos)
+        end = packet.size();
+
+      std::string msg;
+
+      if (! parseLine(packet.substr(pos, end - pos), "test.", counts, msg))
+        fail(msg);
+
+      pos = end + 1;
+    }
+  }
+
+  if (numBytes != emitter.numBytes())
+    fail("received " + std::to_string(numBytes) + " bytes, sent " +
+         std::to_string(emitter.numBytes()));
+
+  //---
+
+  for (const auto &trace : delta.traces()) {
+    auto name = statsDName(int(trace.id));
+
+    auto p = counts.find(name);
+
+    if (trace.stats.count == 0) {
+      if (p != counts.end())
+        fail(name + " not called but sent");
+
+      continue;
+    }
+
+    if (p == counts.end()) {
+      fail(name + " missing");
+      continue;
+    }
+
+    if (p->second.calls != int64_t(trace.stats.count))
+      fail(name + " calls " + std::to_string(p->second.calls) + " != " +
+           std::to_string(trace.stats.count));
+
+    if (std::abs(p->second.samples - double(trace.stats.count)) > 0.01)
+      fail(name + " timer samples " + std::to_string(p->second.samples) + " != " +
+           std::to_string(trace.stats.count));
+  }
+
+  if (counts.size() != size_t(numTraces > 1 ? numTraces - 1 : numTraces))
+    fail("unexpected traces sent");
+
+  ::close(fd);
+
+  std::cout << numPackets << " packets, " << numBytes << " bytes: " <<
+               (ok ? "ok" : "FAIL") << "\n";
+
+  return (ok ? 0 : 1);
+}
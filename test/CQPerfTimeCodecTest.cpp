@@ -0,0 +1,223 @@
+#include <CQPerfTimeCodec.h>
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Record  = CQPerfTimeCodec::Record;
+using Records = std::vector<Record>;
+using Bytes   = std::vector<uint8_t>;
+
+bool equal(const Record &lhs, const Record &rhs) {
+  return lhs.start == rhs.start && lhs.elapsed == rhs.elapsed && lhs.depth == rhs.depth;
+}
+
+std::string toString(const Record &record) {
+  return "{" + std::to_string(record.start) + ", " + std::to_string(record.elapsed) + ", " +
+         std::to_string(record.depth) + "}";
+}
+
+// encode records as a delta chain (as stored in time streams and record file blocks)
+Bytes encodeRecords(const Records &records, std::vector<int> &sizes) {
+  Bytes bytes(records.size()*CQPerfTimeCodec::MAX_RECORD_SIZE);
+
+  size_t  len       = 0;
+  int64_t prevStart = 0;
+
+  for (const auto &record : records) {
+    int n = CQPerfTimeCodec::encode(record, prevStart, &bytes[len]);
+
+    sizes.push_back(n);
+
+    len += size_t(n);
+
+    prevStart = record.start;
+  }
+
+  bytes.resize(len);
+
+  return bytes;
+}
+
+}
+
+//---
+
+// check records round trip through the codec (including depth, start delta and elapsed
+// escapes), expected encoded sizes and that truncated input is rejected (exit status
+// 1 on failure)
+int
+main(int, char **)
+{
+  bool ok = true;
+
+  auto fail = [&](const std::string &msg) {
+    std::cerr << "FAIL: " << msg << "\n";
+    ok = false;
+  };
+
+  //---
+
+  // varints round trip at byte boundaries
+  for (uint64_t v : { uint64_t(0), uint64_t(127), uint64_t(128), uint64_t(16383),
+                      uint64_t(16384), uint64_t(UINT32_MAX), uint64_t(UINT64_MAX) }) {
+    uint8_t buffer[10];
+
+    int n = CQPerfTimeCodec::encodeVarint(v, buffer);
+
+    uint64_t v1;
+
+    if (CQPerfTimeCodec::decodeVarint(buffer, buffer + n, v1) != n || v1 != v)
+      fail("varint " + std::to_string(v));
+
+    if (n > 1 && CQPerfTimeCodec::decodeVarint(buffer, buffer + n - 1, v1) != 0)
+      fail("truncated varint " + std::to_string(v));
+  }
+
+  //---
+
+  Records records;
+
+  auto addRecord = [&](int64_t start, int64_t elapsed, uint32_t depth) {
+    Record record;
+
+    record.start   = start;
+    record.elapsed = elapsed;
+    record.depth   = depth;
+
+    records.push_back(record);
+  };
+
+  // typical, escaped depth (0xFF and larger), negative and large start deltas, escaped
+  // elapsed (0xFFFFFFFF and larger, and negative)
+  addRecord(1000000000000,             0,          0);
+  addRecord(1000000000010,           250,          1);
+  addRecord(1000000000005,            30,          2);
+  addRecord(1000000000005,    0xFFFFFFFE,        254);
+  addRecord(1000000000006,    0xFFFFFFFF,        255);
+  addRecord(1000000000007, 0x100000000LL,        256);
+  addRecord(-5           ,            -1, UINT32_MAX);
+  addRecord(INT64_MAX    ,             1,          3);
+  addRecord(INT64_MIN    ,     INT64_MAX,          4);
+
+  std::vector<int> sizes;
+
+  Bytes bytes = encodeRecords(records, sizes);
+
+  // small records are depth byte, one byte delta and four byte elapsed
+  if (sizes[1] != 6 || sizes[2] != 6)
+    fail("typical record size " + std::to_string(sizes[1]) + ", " +
+         std::to_string(sizes[2]));
+
+  if (sizes[3] != 6)
+    fail("largest unescaped record size " + std::to_string(sizes[3]));
+
+  if (sizes[4] != 1 + 2 + 1 + 4 + 8)
+    fail("escaped record size " + std::to_string(sizes[4]));
+
+  for (auto n : sizes) {
+    if (n > CQPerfTimeCodec::MAX_RECORD_SIZE)
+      fail("record larger than MAX_RECORD_SIZE");
+  }
+
+  // decode chain
+  const uint8_t *p   = bytes.data();
+  const uint8_t *end = bytes.data() + bytes.size();
+
+  int64_t prevStart = 0;
+
+  for (size_t i = 0; i < records.size(); ++i) {
+    Record record;
+
+    int n = CQPerfTimeCodec::decode(p, end, prevStart, record);
+
+    if (n != sizes[i]) {
+      fail("decoded size of record " + std::to_string(i));
+      break;
+    }
+
+    if (! equal(record, records[i]))
+      fail("record " + std::to_string(i) + " " + toString(record) + " != " +
+           toString(records[i]));
+
+    p += n;
+
+    prevStart = record.start;
+  }
+
+  if (p != end)
+    fail("trailing bytes after decode");
+
+  // every truncation of a record is rejected
+  prevStart = 0;
+
+  p = bytes.data();
+
+  for (size_t i = 0; i < records.size(); ++i) {
+    for (int len = 0; len < sizes[i]; ++len) {
+      Record record;
+
+      if (CQPerfTimeCodec::decode(p, p + len, prevStart, record) != 0)
+        fail("truncated record " + std::to_string(i) + " length " + std::to_string(len));
+    }
+
+    prevStart = records[i].start;
+
+    p += sizes[i];
+  }
+
+  //---
+
+  // random chains round trip
+  std::mt19937_64 rng(1);
+
+  for (int r = 0; r < 100; ++r) {
+    Records records1;
+
+    int64_t start = int64_t(rng() >> 2);
+
+    for (int i = 0; i < 1000; ++i) {
+      Record record;
+
+      start += int64_t(rng() % 2000000) - 1000;
+
+      record.start   = start;
+      record.elapsed = (rng() % 50 == 0 ? int64_t(rng() >> 20) : int64_t(rng() % 100000));
+      record.depth   = (rng() % 50 == 0 ? uint32_t(rng()) : uint32_t(rng() % 16));
+
+      records1.push_back(record);
+    }
+
+    std::vector<int> sizes1;
+
+    Bytes bytes1 = encodeRecords(records1, sizes1);
+
+    const uint8_t *p1   = bytes1.data();
+    const uint8_t *end1 = bytes1.data() + bytes1.size();
+
+    int64_t prevStart1 = 0;
+
+    for (const auto &record1 : records1) {
+      Record record;
+
+      int n = CQPerfTimeCodec::decode(p1, end1, prevStart1, record);
+
+      if (n == 0 || ! equal(record, record1)) {
+        fail("random record " + toString(record1));
+        break;
+      }
+
+      p1 += n;
+
+      prevStart1 = record.start;
+    }
+  }
+
+  std::cout << (ok ? "ok" : "FAIL") << "\n";
+
+  return (ok ? 0 : 1);
+}
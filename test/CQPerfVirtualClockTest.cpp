@@ -0,0 +1,164 @@
+#include <CQPerfMonitor.h>
+#include <CQPerfAlertEngine.h>
+#include <CQPerfClock.h>
+
+#include <iostream>
+#include <string>
+
+namespace {
+
+// start on a minute boundary so every rollup resolution starts a new bucket
+const int64_t startTicks = 1200000000;
+
+// run call of elapsed usecs at current time then move to start of next interval
+void call(CQPerfVirtualClock &clock, const QString &name, int64_t elapsed,
+          int64_t interval) {
+  {
+    CQPerfTrace trace(name);
+
+    clock.advance(elapsed);
+  }
+
+  clock.advance(interval - elapsed);
+}
+
+int64_t ticks(const CHRTime &t) {
+  return CQPerfTimeData::timeToTicks(t);
+}
+
+}
+
+//---
+
+// step virtual clock through calls of a trace and check window eviction, rollup
+// buckets at two resolutions and raise/clear of an alert rule (exit status 1 on
+// failure)
+int
+main(int, char **)
+{
+  auto *monitor = CQPerfMonitorInst;
+  auto *engine  = monitor->alertEngine();
+
+  CQPerfVirtualClock clock(startTicks);
+
+  monitor->setClock(&clock);
+
+  monitor->setEnabled(true);
+  monitor->setDebug  (false);
+
+  // small window and rollup rings (set before traces are created) so they wrap
+  monitor->setWindowCount(5);
+  monitor->setRollupSize (4);
+
+  bool ok = true;
+
+  auto check = [&](bool b, const std::string &msg) {
+    if (! b) {
+      std::cerr << "FAIL: " << msg << "\n";
+      ok = false;
+    }
+  };
+
+  //---
+
+  // eight calls 1ms apart with elapsed 10, 20, ... 80 usecs
+  for (int i = 0; i < 8; ++i)
+    call(clock, "clock::op", (i + 1)*10, 1000);
+
+  auto *trace = monitor->getTrace("clock::op");
+
+  // window holds last five calls
+  CQPerfTraceData::WindowData windowData;
+
+  trace->windowDetails(windowData);
+
+  check(windowData.numCalls == 5, "window calls " + std::to_string(windowData.numCalls));
+  check(ticks(windowData.elapsed) == 40 + 50 + 60 + 70 + 80, "window elapsed");
+  check(ticks(windowData.minT) == startTicks + 3000, "window start not oldest kept call");
+  check(ticks(windowData.maxT) == startTicks + 7000 + 80, "window end not end of last call");
+
+  // 1ms rollup ring (four buckets) only holds last four calls
+  CQPerfRollup::Bucket bucket;
+
+  check(! monitor->traceRollupBucket("clock::op", startTicks, startTicks + 8000, 1000,
+                                     bucket), "evicted 1ms buckets used");
+
+  bucket = CQPerfRollup::Bucket();
+
+  check(monitor->traceRollupBucket("clock::op", startTicks + 4000, startTicks + 8000, 1000,
+                                   bucket) && bucket.count == 4 &&
+        bucket.sum == 50 + 60 + 70 + 80 && bucket.min == 50 && bucket.max == 80,
+        "1ms rollup buckets");
+
+  bucket = CQPerfRollup::Bucket();
+
+  check(monitor->traceRollupBucket("clock::op", startTicks + 4000, startTicks + 6000, 1000,
+                                   bucket) && bucket.count == 2 && bucket.sum == 50 + 60,
+        "1ms rollup bucket range");
+
+  // 10ms rollup holds all calls in one bucket
+  bucket = CQPerfRollup::Bucket();
+
+  check(monitor->traceRollupBucket("clock::op", startTicks, startTicks + 10000, 10000,
+                                   bucket) && bucket.count == 8 && bucket.sum == 360,
+        "10ms rollup bucket");
+
+  //---
+
+  // mean over last second raises rule above 500us and clears below 200us (alert trace
+  // uses default rollup size so its 100ms buckets hold the whole window)
+  monitor->setRollupSize(64);
+
+  engine->setInterval(3600000000);
+
+  CQPerfAlertEngine::Rule rule;
+
+  rule.name           = "clock";
+  rule.trace          = "clock::alert";
+  rule.metric         = CQPerfAlertEngine::Metric::MEAN;
+  rule.window         = 1000000;
+  rule.threshold      = 500;
+  rule.clearThreshold = 200;
+  rule.debounce       = 1;
+  rule.actions        = CQPerfAlertEngine::ACTION_CALLBACK;
+
+  int numRaised = 0, numCleared = 0;
+
+  rule.callback = [&](const CQPerfAlertEngine::Alert &alert) {
+    if (alert.active)
+      ++numRaised;
+    else
+      ++numCleared;
+  };
+
+  engine->addRule(rule);
+
+  engine->stop();
+
+  auto step = [&](int64_t elapsed) {
+    for (int i = 0; i < 10; ++i)
+      call(clock, "clock::alert", elapsed, 100000);
+
+    engine->evaluate(clock.ticks());
+  };
+
+  step(1000);
+
+  check(engine->isRaised("clock") && numRaised == 1, "rule not raised");
+
+  step(300);
+
+  check(engine->isRaised("clock") && numCleared == 0, "rule cleared above clear threshold");
+
+  step(100);
+
+  check(! engine->isRaised("clock") && numCleared == 1, "rule not cleared");
+
+  engine->clearRules();
+
+  monitor->setClock(nullptr);
+
+  std::cout << (ok ? "ok" : "FAIL") << "\n";
+
+  return (ok ? 0 : 1);
+}